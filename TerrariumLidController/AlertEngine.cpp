@@ -0,0 +1,150 @@
+#include "AlertEngine.h"
+
+namespace {
+constexpr AlertEngine::Config kDefaultConfig = {65.0f, 90.0f, 60.0f, 1.0f, 3.0f, 3};
+}  // namespace
+
+AlertEngine::AlertEngine()
+    : config_(kDefaultConfig),
+      prefsOpened_(false),
+      channels_{},
+      evaluations_(0),
+      changes_(0) {}
+
+void AlertEngine::begin() {
+  prefsOpened_ = prefs_.begin("alerts", false);
+  if (!prefsOpened_) {
+    return;
+  }
+  Config loaded;
+  loaded.coldF = prefs_.getFloat("cold_f", kDefaultConfig.coldF);
+  loaded.hotF = prefs_.getFloat("hot_f", kDefaultConfig.hotF);
+  loaded.dryPercent = prefs_.getFloat("dry_rh", kDefaultConfig.dryPercent);
+  loaded.hysteresisF = prefs_.getFloat("hyst_f", kDefaultConfig.hysteresisF);
+  loaded.hysteresisPercent = prefs_.getFloat("hyst_rh", kDefaultConfig.hysteresisPercent);
+  loaded.debounceSamples = prefs_.getUChar("debounce", kDefaultConfig.debounceSamples);
+  if (isValid(loaded)) {
+    config_ = loaded;
+  }
+}
+
+AlertEngine::Config AlertEngine::getConfig() const {
+  return config_;
+}
+
+bool AlertEngine::setThreshold(Alert alert, float value) {
+  Config next = config_;
+  if (alert == Alert::TooCold) next.coldF = value;
+  if (alert == Alert::TooHot) next.hotF = value;
+  if (alert == Alert::NeedsWatering) next.dryPercent = value;
+  if (!isValid(next)) {
+    return false;
+  }
+  config_ = next;
+  save();
+  return true;
+}
+
+bool AlertEngine::setHysteresis(float degreesF, float percent) {
+  Config next = config_;
+  next.hysteresisF = degreesF;
+  next.hysteresisPercent = percent;
+  if (!isValid(next)) {
+    return false;
+  }
+  config_ = next;
+  save();
+  return true;
+}
+
+bool AlertEngine::setDebounce(uint8_t samples) {
+  Config next = config_;
+  next.debounceSamples = samples;
+  if (!isValid(next)) {
+    return false;
+  }
+  config_ = next;
+  save();
+  return true;
+}
+
+bool AlertEngine::evaluate(float temperatureF, float humidity) {
+  evaluations_++;
+  bool changed = false;
+  changed |= step(channels_[static_cast<size_t>(Alert::TooCold)], temperatureF < config_.coldF,
+                  temperatureF >= config_.coldF + config_.hysteresisF);
+  changed |= step(channels_[static_cast<size_t>(Alert::TooHot)], temperatureF > config_.hotF,
+                  temperatureF <= config_.hotF - config_.hysteresisF);
+  changed |= step(channels_[static_cast<size_t>(Alert::NeedsWatering)], humidity < config_.dryPercent,
+                  humidity >= config_.dryPercent + config_.hysteresisPercent);
+  return changed;
+}
+
+void AlertEngine::reset() {
+  for (Channel& channel : channels_) {
+    if (channel.active) {
+      changes_++;
+    }
+    channel = Channel{false, 0};
+  }
+}
+
+bool AlertEngine::isActive(Alert alert) const {
+  return channels_[static_cast<size_t>(alert)].active;
+}
+
+AlertEngine::Status AlertEngine::getStatus() const {
+  Status status{};
+  for (size_t i = 0; i < kAlertCount; ++i) {
+    status.active[i] = channels_[i].active;
+    status.pending[i] = channels_[i].count;
+  }
+  status.evaluations = evaluations_;
+  status.changes = changes_;
+  return status;
+}
+
+const char* AlertEngine::alertName(Alert alert) {
+  if (alert == Alert::TooCold) return "too cold";
+  if (alert == Alert::TooHot) return "too hot";
+  return "needs watering";
+}
+
+bool AlertEngine::isValid(const Config& config) {
+  // The negated comparisons also reject NaN.
+  if (!(config.coldF >= -40.0f && config.hotF <= 160.0f && config.coldF < config.hotF)) return false;
+  if (!(config.dryPercent >= 0.0f && config.dryPercent <= 100.0f)) return false;
+  if (!(config.hysteresisF >= 0.0f && config.hysteresisF <= 20.0f)) return false;
+  if (!(config.hysteresisPercent >= 0.0f && config.hysteresisPercent <= 50.0f)) return false;
+  return config.debounceSamples >= 1 && config.debounceSamples <= kMaxDebounceSamples;
+}
+
+bool AlertEngine::step(Channel& channel, bool raise, bool clear) {
+  // Count samples in a row that point away from the current state.
+  if (!(channel.active ? clear : raise)) {
+    channel.count = 0;
+    return false;
+  }
+  if (++channel.count < config_.debounceSamples) {
+    return false;
+  }
+  channel.active = !channel.active;
+  channel.count = 0;
+  changes_++;
+  return true;
+}
+
+void AlertEngine::save() {
+  if (!prefsOpened_) {
+    prefsOpened_ = prefs_.begin("alerts", false);
+  }
+  if (!prefsOpened_) {
+    return;
+  }
+  prefs_.putFloat("cold_f", config_.coldF);
+  prefs_.putFloat("hot_f", config_.hotF);
+  prefs_.putFloat("dry_rh", config_.dryPercent);
+  prefs_.putFloat("hyst_f", config_.hysteresisF);
+  prefs_.putFloat("hyst_rh", config_.hysteresisPercent);
+  prefs_.putUChar("debounce", config_.debounceSamples);
+}
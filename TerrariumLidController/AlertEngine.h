@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Too cold / too hot / needs watering from the trusted SHT3x reading.
+// evaluate() runs once per new sample, not per loop. A condition has to
+// hold for debounceSamples samples in a row to raise its alert, and the
+// reading has to come back past the threshold by the hysteresis for as many
+// samples to clear it. Settings live in NVS namespace "alerts".
+class AlertEngine {
+ public:
+  enum class Alert : uint8_t {
+    TooCold = 0,
+    TooHot = 1,
+    NeedsWatering = 2,
+  };
+  static constexpr size_t kAlertCount = 3;
+  static constexpr uint8_t kMaxDebounceSamples = 60;
+
+  struct Config {
+    float coldF;        // alert below
+    float hotF;         // alert above
+    float dryPercent;   // alert below
+    float hysteresisF;
+    float hysteresisPercent;
+    uint8_t debounceSamples;
+  };
+
+  struct Status {
+    bool active[kAlertCount];
+    uint8_t pending[kAlertCount];  // samples counted toward the next change
+    unsigned long evaluations;
+    unsigned long changes;
+  };
+
+  AlertEngine();
+
+  void begin();
+  Config getConfig() const;
+  bool setThreshold(Alert alert, float value);
+  bool setHysteresis(float degreesF, float percent);
+  bool setDebounce(uint8_t samples);
+  // Returns true if any alert was raised or cleared.
+  bool evaluate(float temperatureF, float humidity);
+  // Drops every alert, e.g. while there is no trusted reading.
+  void reset();
+  bool isActive(Alert alert) const;
+  Status getStatus() const;
+  static const char* alertName(Alert alert);
+
+ private:
+  struct Channel {
+    bool active;
+    uint8_t count;
+  };
+
+  static bool isValid(const Config& config);
+  bool step(Channel& channel, bool raise, bool clear);
+  void save();
+
+  Config config_;
+  Preferences prefs_;
+  bool prefsOpened_;
+  Channel channels_[kAlertCount];
+  unsigned long evaluations_;
+  unsigned long changes_;
+};
@@ -0,0 +1,167 @@
+#include "ClockService.h"
+
+namespace {
+uint8_t bcd2bin(uint8_t v) {
+  return static_cast<uint8_t>(v - 6 * (v >> 4));
+}
+}
+
+ClockService::ClockService(RTC_DS3231& rtc, I2cBus& bus)
+    : rtc_(rtc),
+      bus_(bus),
+      valid_(false),
+      anchorUnix_(0),
+      anchorMs_(0),
+      lastSyncMs_(0),
+      driftStartMs_(0),
+      driftErrorS_(0),
+      resyncRequested_(false),
+      edgeSearching_(false),
+      edgeFirstUnix_(0),
+      edgeStartMs_(0),
+      status_{false, 0, 0, 0, 0, 0, 0.0f, 0} {}
+
+void ClockService::begin() {
+  anchorOnEdge();
+}
+
+void ClockService::update(unsigned long nowMs) {
+  if (!valid_) {
+    // Boot read failed; keep trying at the caller's rate without blocking.
+    pollEdge(nowMs);
+    return;
+  }
+  if (!resyncRequested_ && (nowMs - lastSyncMs_) < kResyncIntervalMs) {
+    return;
+  }
+  resyncRequested_ = false;
+
+  uint32_t rtcUnix = 0;
+  if (!readRtc(rtcUnix)) {
+    // Keep extrapolating; try again next interval.
+    lastSyncMs_ = nowMs;
+    return;
+  }
+  long error = static_cast<long>(rtcUnix - predictUnix(nowMs));
+  status_.resyncs++;
+  status_.lastErrorS = error;
+  lastSyncMs_ = nowMs;
+  // Move the anchor forward by whole seconds so it keeps its edge alignment
+  // and never ages past a millis() wrap; a correction shifts only the
+  // second it counts from, never its sub-second phase.
+  unsigned long wholeS = (nowMs - anchorMs_) / 1000UL;
+  anchorUnix_ += static_cast<uint32_t>(wholeS);
+  anchorMs_ += wholeS * 1000UL;
+  if (error != 0) {
+    status_.corrections++;
+    driftErrorS_ += error;
+    anchorUnix_ += static_cast<uint32_t>(error);
+  }
+
+  unsigned long elapsedMs = nowMs - driftStartMs_;
+  if (elapsedMs > 0) {
+    status_.driftPpm = static_cast<float>(driftErrorS_) * 1.0e9f / static_cast<float>(elapsedMs);
+  }
+}
+
+DateTime ClockService::now() const {
+  return now(millis());
+}
+
+DateTime ClockService::now(unsigned long nowMs) const {
+  return DateTime(predictUnix(nowMs));
+}
+
+void ClockService::adjust(const DateTime& dt) {
+  // Writing the seconds register restarts the DS3231 countdown, so the
+  // write itself is a seconds edge.
+  rtc_.adjust(dt);
+  anchor(dt.unixtime(), millis());
+  driftStartMs_ = anchorMs_;
+  driftErrorS_ = 0;
+  status_.driftPpm = 0.0f;
+  status_.lastErrorS = 0;
+}
+
+bool ClockService::isFindingEdge() const {
+  return edgeSearching_;
+}
+
+void ClockService::requestResync() {
+  resyncRequested_ = true;
+}
+
+ClockService::Status ClockService::getStatus() const {
+  Status s = status_;
+  s.valid = valid_;
+  s.msSinceSync = millis() - lastSyncMs_;
+  return s;
+}
+
+bool ClockService::readRtc(uint32_t& unixTime) {
+  status_.rtcReads++;
+  const uint8_t reg = 0x00;
+  uint8_t r[7];
+  if (!bus_.writeRead(kDs3231Address, &reg, 1, r, sizeof(r))) {
+    status_.readErrors++;
+    return false;
+  }
+  DateTime dt(static_cast<uint16_t>(bcd2bin(r[6]) + 2000), bcd2bin(r[5] & 0x7F), bcd2bin(r[4]),
+              bcd2bin(r[2] & 0x3F), bcd2bin(r[1]), bcd2bin(r[0] & 0x7F));
+  unixTime = dt.unixtime();
+  return true;
+}
+
+bool ClockService::anchorOnEdge() {
+  // Wait for the seconds register to tick so the millis() anchor sits on
+  // the edge; otherwise the extrapolated time can lag by up to a second.
+  uint32_t first = 0;
+  if (!readRtc(first)) {
+    return false;
+  }
+  unsigned long start = millis();
+  uint32_t t = first;
+  while (t == first && (millis() - start) < kEdgeWaitMs) {
+    delay(kEdgePollMs);
+    if (!readRtc(t)) {
+      t = first;
+    }
+  }
+  anchor(t, millis());
+  driftStartMs_ = anchorMs_;
+  driftErrorS_ = 0;
+  return true;
+}
+
+void ClockService::pollEdge(unsigned long nowMs) {
+  uint32_t t = 0;
+  if (!readRtc(t)) {
+    // Gone again; fall back to the caller's normal rate.
+    edgeSearching_ = false;
+    return;
+  }
+  if (!edgeSearching_) {
+    edgeSearching_ = true;
+    edgeFirstUnix_ = t;
+    edgeStartMs_ = nowMs;
+    return;
+  }
+  if (t == edgeFirstUnix_ && (nowMs - edgeStartMs_) < kEdgeWaitMs) {
+    return;
+  }
+  anchor(t, nowMs);
+  driftStartMs_ = anchorMs_;
+  driftErrorS_ = 0;
+}
+
+void ClockService::anchor(uint32_t unixTime, unsigned long atMs) {
+  anchorUnix_ = unixTime;
+  anchorMs_ = atMs;
+  lastSyncMs_ = atMs;
+  valid_ = true;
+  edgeSearching_ = false;
+}
+
+uint32_t ClockService::predictUnix(unsigned long nowMs) const {
+  return anchorUnix_ + static_cast<uint32_t>((nowMs - anchorMs_) / 1000UL);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include "RTClib.h"
+#include "I2cBus.h"
+
+// Wall-clock time for the whole sketch. The DS3231 is read at boot and then
+// only every kResyncIntervalMs; in between the time is extrapolated from
+// millis(). Every consumer shares the same cached DateTime.
+class ClockService {
+ public:
+  struct Status {
+    bool valid;
+    unsigned long rtcReads;
+    unsigned long readErrors;
+    unsigned long resyncs;
+    unsigned long corrections;
+    long lastErrorS;
+    float driftPpm;
+    unsigned long msSinceSync;
+  };
+
+  static constexpr unsigned long kResyncIntervalMs = 60000;
+
+  // Writes go through RTClib; the periodic time reads go straight to the
+  // DS3231 registers over the bus manager.
+  ClockService(RTC_DS3231& rtc, I2cBus& bus);
+
+  static constexpr unsigned long kEdgePollMs = 5;
+
+  // Anchors to a seconds edge of the RTC (blocks for up to ~1 s).
+  void begin();
+  // Never blocks: if begin() found no RTC, each call reads it once and
+  // anchors when the seconds register ticks.
+  void update(unsigned long nowMs);
+  // True while waiting for that tick; call update() every kEdgePollMs.
+  bool isFindingEdge() const;
+  DateTime now() const;
+  DateTime now(unsigned long nowMs) const;
+  // Writes the RTC and re-anchors; resets the drift estimate.
+  void adjust(const DateTime& dt);
+  void requestResync();
+  Status getStatus() const;
+
+ private:
+  static constexpr unsigned long kEdgeWaitMs = 1100;
+  static constexpr uint8_t kDs3231Address = 0x68;
+
+  bool readRtc(uint32_t& unixTime);
+  // Anchors on the next seconds edge (blocks for up to ~1 s); false if the
+  // RTC does not answer.
+  bool anchorOnEdge();
+  // One step of the same search; anchors once the second changes.
+  void pollEdge(unsigned long nowMs);
+  void anchor(uint32_t unixTime, unsigned long atMs);
+  uint32_t predictUnix(unsigned long nowMs) const;
+
+  RTC_DS3231& rtc_;
+  I2cBus& bus_;
+  bool valid_;
+  uint32_t anchorUnix_;
+  unsigned long anchorMs_;
+  unsigned long lastSyncMs_;
+  unsigned long driftStartMs_;
+  long driftErrorS_;
+  bool resyncRequested_;
+  bool edgeSearching_;
+  uint32_t edgeFirstUnix_;
+  unsigned long edgeStartMs_;
+  Status status_;
+};
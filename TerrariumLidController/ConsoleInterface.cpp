@@ -2,52 +2,21 @@
 
 #include <ctype.h>
 #include <stdio.h>
-#include <string.h>
 
-ConsoleInterface::ConsoleInterface(Stream& serial, RTC_DS3231& rtc)
+ConsoleInterface::ConsoleInterface(Stream& serial, ReportWriter& out)
     : serial_(serial),
-      rtc_(rtc),
+      out_(out),
+      commands_(nullptr),
+      commandCount_(0),
       inputBuffer_{0},
-      inputLength_(0),
-      statusHandler_(nullptr),
-      potHandler_(nullptr),
-      debugHandler_(nullptr),
-      forceOnHandler_(nullptr),
-      forceOffHandler_(nullptr),
-      sht3xHandler_(nullptr),
-      displayHandler_(nullptr) {}
+      inputLength_(0) {}
 
-void ConsoleInterface::begin() {
-  serial_.println("Console ready. Type 'help' for commands.");
+void ConsoleInterface::begin(const ConsoleCommand* commands, size_t count) {
+  commands_ = commands;
+  commandCount_ = count;
+  out_.println("Console ready. Type 'help' for commands.");
   printPrompt();
-}
-
-void ConsoleInterface::setStatusHandler(StatusHandler handler) {
-  statusHandler_ = handler;
-}
-
-void ConsoleInterface::setPotHandler(PotHandler handler) {
-  potHandler_ = handler;
-}
-
-void ConsoleInterface::setDebugHandler(DebugHandler handler) {
-  debugHandler_ = handler;
-}
-
-void ConsoleInterface::setForceOnHandler(ForceOnHandler handler) {
-  forceOnHandler_ = handler;
-}
-
-void ConsoleInterface::setForceOffHandler(ForceOffHandler handler) {
-  forceOffHandler_ = handler;
-}
-
-void ConsoleInterface::setSht3xHandler(Sht3xHandler handler) {
-  sht3xHandler_ = handler;
-}
-
-void ConsoleInterface::setDisplayHandler(DisplayHandler handler) {
-  displayHandler_ = handler;
+  out_.flush();
 }
 
 void ConsoleInterface::update() {
@@ -68,7 +37,7 @@ void ConsoleInterface::update() {
       inputLength_ = 0;
       inputBuffer_[0] = '\0';
       printPrompt();
-
+      out_.flush();
       continue;
     }
 
@@ -79,197 +48,108 @@ void ConsoleInterface::update() {
 }
 
 void ConsoleInterface::printPrompt() {
-  serial_.print("> ");
+  out_.print("> ");
 }
 
-void ConsoleInterface::printHelp() {
-  serial_.println("Commands:");
-  serial_.println("  help            Show available commands");
-  serial_.println("  now             Read date/time from DS3231");
-  serial_.println("  settime         Set RTC (YYYY-MM-DD HH:MM:SS)");
-  serial_.println("  status          Show current pot/gate/duty");
-  serial_.println("  pot             Read current potentiometer value");
-  serial_.println("  debug           Print schedule debug line");
-  serial_.println("  forceOn         Force LED on (override schedule)");
-  serial_.println("  forceOff        Return to schedule timing");
-  serial_.println("  sht3x           Show SHT3x status and recent events");
-  serial_.println("  display ...     Display commands (status/on/off/dim/flip/timeout/test)");
+void ConsoleInterface::printHelp(const char* args) {
+  if (*args != '\0') {
+    const ConsoleCommand* cmd = find(commands_, commandCount_, args, static_cast<size_t>(tokenEnd(args) - args));
+    if (cmd != nullptr && cmd->subcommandCount > 0) {
+      out_.print(cmd->name);
+      out_.println(" subcommands:");
+      printEntries(cmd->subcommands, cmd->subcommandCount, cmd->name);
+      return;
+    }
+  }
+  out_.println("Commands:");
+  out_.println("  help [command]  Show available commands");
+  printEntries(commands_, commandCount_, nullptr);
 }
 
-void ConsoleInterface::handleCommand(const char* command) {
-  while (*command != '\0' && isspace(static_cast<unsigned char>(*command))) {
-    ++command;
+void ConsoleInterface::printEntries(const ConsoleCommand* table, size_t count, const char* prefix) {
+  char line[96];
+  for (size_t i = 0; i < count; ++i) {
+    const ConsoleCommand& cmd = table[i];
+    if (cmd.help == nullptr) {
+      continue;
+    }
+    char name[24];
+    snprintf(name, sizeof(name), "%s%s%s%s", prefix ? prefix : "", prefix ? " " : "", cmd.name,
+             cmd.subcommandCount > 0 ? " ..." : "");
+    snprintf(line, sizeof(line), "  %-15s %s", name, cmd.help);
+    out_.println(line);
   }
+}
 
+void ConsoleInterface::handleCommand(const char* command) {
+  command = skipSpaces(command);
   if (*command == '\0') {
     return;
   }
 
-  const char* end = command;
-  while (*end != '\0' && !isspace(static_cast<unsigned char>(*end))) {
-    ++end;
-  }
+  const char* end = tokenEnd(command);
   size_t len = static_cast<size_t>(end - command);
 
   if (len == 4 && strncmp(command, "help", len) == 0) {
-    printHelp();
-    return;
-  }
-
-  if ((len == 3 && strncmp(command, "now", len) == 0) ||
-      (len == 4 && strncmp(command, "time", len) == 0) ||
-      (len == 8 && strncmp(command, "datetime", len) == 0)) {
-    printDateTime();
-    return;
-  }
-
-  if (len == 7 && strncmp(command, "settime", len) == 0) {
-    const char* args = end;
-    while (*args != '\0' && isspace(static_cast<unsigned char>(*args))) {
-      ++args;
-    }
-    if (*args == '\0') {
-      printSetTimeUsage();
-      return;
-    }
-
-    DateTime dt;
-    if (!parseDateTime(args, dt)) {
-      printSetTimeUsage();
-      return;
-    }
-
-    rtc_.adjust(dt);
-    serial_.println("RTC updated.");
-    printDateTime();
+    printHelp(skipSpaces(end));
     return;
   }
 
-  if (len == 6 && strncmp(command, "status", len) == 0) {
-    if (statusHandler_ != nullptr) {
-      statusHandler_(serial_);
-    } else {
-      serial_.println("Status not available.");
-    }
+  const ConsoleCommand* cmd = find(commands_, commandCount_, command, len);
+  if (cmd == nullptr) {
+    out_.print("Unknown command: ");
+    out_.println(command);
+    out_.println("Type 'help' to list supported commands.");
     return;
   }
 
-  if (len == 3 && strncmp(command, "pot", len) == 0) {
-    if (potHandler_ != nullptr) {
-      potHandler_(serial_);
-    } else {
-      serial_.println("Pot not available.");
+  const char* args = skipSpaces(end);
+  while (cmd->subcommandCount > 0 && *args != '\0') {
+    const char* subEnd = tokenEnd(args);
+    const ConsoleCommand* sub =
+        find(cmd->subcommands, cmd->subcommandCount, args, static_cast<size_t>(subEnd - args));
+    if (sub == nullptr) {
+      break;
     }
-    return;
+    cmd = sub;
+    args = skipSpaces(subEnd);
   }
+  cmd->handler(out_, args);
+}
 
-  if (len == 5 && strncmp(command, "debug", len) == 0) {
-    if (debugHandler_ != nullptr) {
-      debugHandler_(serial_);
-    } else {
-      serial_.println("Debug not available.");
+const ConsoleCommand* ConsoleInterface::find(const ConsoleCommand* table, size_t count, const char* name,
+                                             size_t len) {
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    const char* candidate = table[mid].name;
+    int cmp = strncmp(candidate, name, len);
+    if (cmp == 0 && candidate[len] != '\0') {
+      cmp = 1;  // candidate is longer than the token
     }
-    return;
-  }
-
-  if ((len == 7 && strncmp(command, "forceOn", len) == 0) ||
-      (len == 7 && strncmp(command, "forceon", len) == 0)) {
-    if (forceOnHandler_ != nullptr) {
-      forceOnHandler_(serial_);
-    } else {
-      serial_.println("Force-on not available.");
+    if (cmp == 0) {
+      return &table[mid];
     }
-    return;
-  }
-
-  if ((len == 8 && strncmp(command, "forceOff", len) == 0) ||
-      (len == 8 && strncmp(command, "forceoff", len) == 0)) {
-    if (forceOffHandler_ != nullptr) {
-      forceOffHandler_(serial_);
+    if (cmp < 0) {
+      lo = mid + 1;
     } else {
-      serial_.println("Force-off not available.");
+      hi = mid;
     }
-    return;
   }
-
-  if (len == 5 && strncmp(command, "sht3x", len) == 0) {
-    if (sht3xHandler_ != nullptr) {
-      sht3xHandler_(serial_);
-    } else {
-      serial_.println("SHT3x not available.");
-    }
-    return;
-  }
-
-  if (len == 7 && strncmp(command, "display", len) == 0) {
-    if (displayHandler_ != nullptr) {
-      const char* args = end;
-      while (*args != '\0' && isspace(static_cast<unsigned char>(*args))) {
-        ++args;
-      }
-      displayHandler_(serial_, args);
-    } else {
-      serial_.println("Display commands not available.");
-    }
-    return;
-  }
-
-  serial_.print("Unknown command: ");
-  serial_.println(command);
-  serial_.println("Type 'help' to list supported commands.");
+  return nullptr;
 }
 
-void ConsoleInterface::printDateTime() {
-  DateTime now = rtc_.now();
-
-  serial_.print("DS3231 datetime: ");
-  serial_.print(now.year());
-  serial_.print('-');
-  if (now.month() < 10) serial_.print('0');
-  serial_.print(now.month());
-  serial_.print('-');
-  if (now.day() < 10) serial_.print('0');
-  serial_.print(now.day());
-  serial_.print(' ');
-  if (now.hour() < 10) serial_.print('0');
-  serial_.print(now.hour());
-  serial_.print(':');
-  if (now.minute() < 10) serial_.print('0');
-  serial_.print(now.minute());
-  serial_.print(':');
-  if (now.second() < 10) serial_.print('0');
-  serial_.println(now.second());
-}
-
-void ConsoleInterface::printSetTimeUsage() {
-  serial_.println("Usage:");
-  serial_.println("  settime YYYY-MM-DD HH:MM:SS");
-  serial_.println("  settime YYYY-MM-DDTHH:MM:SS");
+const char* ConsoleInterface::skipSpaces(const char* p) {
+  while (*p != '\0' && isspace(static_cast<unsigned char>(*p))) {
+    ++p;
+  }
+  return p;
 }
 
-bool ConsoleInterface::parseDateTime(const char* args, DateTime& out) {
-  int year = 0;
-  int month = 0;
-  int day = 0;
-  int hour = 0;
-  int minute = 0;
-  int second = 0;
-
-  int parsed = sscanf(args, "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second);
-  if (parsed != 6) {
-    parsed = sscanf(args, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
-  }
-  if (parsed != 6) {
-    return false;
+const char* ConsoleInterface::tokenEnd(const char* p) {
+  while (*p != '\0' && !isspace(static_cast<unsigned char>(*p))) {
+    ++p;
   }
-
-  if (year < 2000 || year > 2099) return false;
-  if (month < 1 || month > 12) return false;
-  if (day < 1 || day > 31) return false;
-  if (hour < 0 || hour > 23) return false;
-  if (minute < 0 || minute > 59) return false;
-  if (second < 0 || second > 59) return false;
-
-  out = DateTime(year, month, day, hour, minute, second);
-  return true;
+  return p;
 }
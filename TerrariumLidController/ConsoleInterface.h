@@ -1,48 +1,72 @@
 #pragma once
 
 #include <Arduino.h>
-#include "RTClib.h"
+#include <string.h>
+#include "ReportWriter.h"
+
+// One console command. Tables are sorted by name (byte order) so lookup is
+// a binary search; an alias is just another entry with the same handler
+// and help == nullptr so it stays out of the help listing. A command with
+// subcommands dispatches on its first argument and falls back to its own
+// handler when that argument is missing or unknown.
+struct ConsoleCommand {
+  using Handler = void (*)(Print& out, const char* args);
+
+  const char* name;
+  Handler handler;
+  const char* help;
+  const ConsoleCommand* subcommands;
+  size_t subcommandCount;
+};
+
+constexpr int consoleNameCompare(const char* a, const char* b) {
+  while (*a != '\0' && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return static_cast<int>(static_cast<unsigned char>(*a)) - static_cast<int>(static_cast<unsigned char>(*b));
+}
+
+template <size_t N>
+constexpr bool consoleTableSorted(const ConsoleCommand (&table)[N]) {
+  for (size_t i = 1; i < N; ++i) {
+    if (consoleNameCompare(table[i - 1].name, table[i].name) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Entry count of a command table, for subcommandCount and begin().
+template <size_t N>
+constexpr size_t consoleCount(const ConsoleCommand (&)[N]) {
+  return N;
+}
 
 class ConsoleInterface {
  public:
-  using StatusHandler = void (*)(Stream& serial);
-  using PotHandler = void (*)(Stream& serial);
-  using DebugHandler = void (*)(Stream& serial);
-  using ForceOnHandler = void (*)(Stream& serial);
-  using ForceOffHandler = void (*)(Stream& serial);
-  using Sht3xHandler = void (*)(Stream& serial);
-  using DisplayHandler = void (*)(Stream& serial, const char* args);
+  // Commands are read from serial; everything the console and its handlers
+  // print goes through out and is flushed once per command.
+  ConsoleInterface(Stream& serial, ReportWriter& out);
 
-  ConsoleInterface(Stream& serial, RTC_DS3231& rtc);
-
-  void begin();
+  void begin(const ConsoleCommand* commands, size_t count);
   void update();
-  void setStatusHandler(StatusHandler handler);
-  void setPotHandler(PotHandler handler);
-  void setDebugHandler(DebugHandler handler);
-  void setForceOnHandler(ForceOnHandler handler);
-  void setForceOffHandler(ForceOffHandler handler);
-  void setSht3xHandler(Sht3xHandler handler);
-  void setDisplayHandler(DisplayHandler handler);
 
  private:
   static constexpr size_t kBufferSize = 64;
 
+  static const ConsoleCommand* find(const ConsoleCommand* table, size_t count, const char* name, size_t len);
+  static const char* skipSpaces(const char* p);
+  static const char* tokenEnd(const char* p);
+
   Stream& serial_;
-  RTC_DS3231& rtc_;
+  ReportWriter& out_;
+  const ConsoleCommand* commands_;
+  size_t commandCount_;
   char inputBuffer_[kBufferSize];
   size_t inputLength_;
-  StatusHandler statusHandler_;
-  PotHandler potHandler_;
-  DebugHandler debugHandler_;
-  ForceOnHandler forceOnHandler_;
-  ForceOffHandler forceOffHandler_;
-  Sht3xHandler sht3xHandler_;
-  DisplayHandler displayHandler_;
   void printPrompt();
-  void printHelp();
+  void printHelp(const char* args);
+  void printEntries(const ConsoleCommand* table, size_t count, const char* prefix);
   void handleCommand(const char* command);
-  void printDateTime();
-  void printSetTimeUsage();
-  bool parseDateTime(const char* args, DateTime& out);
 };
@@ -25,6 +25,10 @@ constexpr uint8_t DISPLAY_I2C_ADDR_FALLBACK = 0x3D;
 
 constexpr unsigned long DISPLAY_REFRESH_INTERVAL_MS = 500;
 constexpr uint8_t DISPLAY_ROTATION_DEFAULT = 0;
+// Time on each screen while auto-rotating; 0 stays on home.
+constexpr unsigned long DISPLAY_SCREEN_ROTATE_MS = 8000;
+// Pot movement (filtered ADC counts) that wakes a timed-out display.
+constexpr int DISPLAY_POT_ACTIVITY_COUNTS = 8;
 
 // Two-tone panel color split for 128x64 yellow/blue modules.
 constexpr uint8_t DISPLAY_YELLOW_Y_MIN = 0;
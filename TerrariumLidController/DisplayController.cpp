@@ -1,27 +1,74 @@
 #include "DisplayController.h"
+#include "ReportWriter.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <new>
 
 namespace {
-void copyTrunc21(char* out, const char* in) {
-  size_t i = 0;
-  while (i < 21 && in[i] != '\0') {
-    out[i] = in[i];
-    ++i;
-  }
-  out[i] = '\0';
-}
+// Adafruit_SSD1306 that draws into caller-owned memory. Only its drawing
+// is used; every byte to the panel goes through the I2cBus, so the
+// driver's own Wire and clock handling never runs.
+class StaticSsd1306 : public Adafruit_SSD1306 {
+ public:
+  StaticSsd1306(uint8_t* framebuffer, TwoWire* wire, uint32_t clockHz)
+      : Adafruit_SSD1306(DISPLAY_ACTIVE_WIDTH, DISPLAY_ACTIVE_HEIGHT, wire, -1, clockHz, clockHz) {
+    buffer = framebuffer;
+  }
+  ~StaticSsd1306() {
+    buffer = nullptr;  // not ours to free
+  }
+};
+static_assert(sizeof(StaticSsd1306) == sizeof(Adafruit_SSD1306), "driver storage size");
+
+// The driver's begin() sequence, internal charge pump, ending with the
+// undimmed contrast and the panel still off.
+constexpr uint8_t kContrastNormal = 0xCF;
+constexpr uint8_t kContrastDimmed = 0x00;
+const uint8_t kInitCommands[] = {
+    SSD1306_DISPLAYOFF,        SSD1306_SETDISPLAYCLOCKDIV,  0x80,
+    SSD1306_SETMULTIPLEX,      DISPLAY_ACTIVE_HEIGHT - 1,   SSD1306_SETDISPLAYOFFSET,
+    0x00,                      SSD1306_SETSTARTLINE | 0x00, SSD1306_CHARGEPUMP,
+    0x14,                      SSD1306_MEMORYMODE,          0x00,
+    SSD1306_SEGREMAP | 0x01,   SSD1306_COMSCANDEC,          SSD1306_SETCOMPINS,
+    DISPLAY_ACTIVE_HEIGHT == 64 ? 0x12 : 0x02,              SSD1306_SETCONTRAST,
+    kContrastNormal,           SSD1306_SETPRECHARGE,        0xF1,
+    SSD1306_SETVCOMDETECT,     0x40,                        SSD1306_DISPLAYALLON_RESUME,
+    SSD1306_NORMALDISPLAY,     SSD1306_DEACTIVATE_SCROLL,
+};
 }
 
 DisplayController::DisplayController()
-    : oled_(nullptr),
-      wire_(nullptr),
+    : oledStorage_{},
+      framebuffer_{},
+      oled_(nullptr),
+      canvas_(framebuffer_, DISPLAY_ACTIVE_WIDTH, DISPLAY_ACTIVE_HEIGHT),
+      // Layout contract. Text boxes span the -1..+1 px pixel shift.
+      clockText_(98, 0, 30, 1),
+      valueText_(0, 12, 52, 2),
+      valueBar_(56, 14, 68, 12),
+      modeLine_(0, 34, DISPLAY_ACTIVE_WIDTH, 1),
+      eventLine_(0, 44, DISPLAY_ACTIVE_WIDTH, 1),
+      bannerLine_(0, 54, DISPLAY_ACTIVE_WIDTH, 1),
+      usbIcon_(0, 0),
+      rtcIcon_(10, 0),
+      modeIcon_(20, 0),
+      alertIcon_(30, 0),
+      frameValid_(false),
+      screen_(Screen::Home),
+      renderedScreen_(Screen::Home),
+      autoRotate_(DISPLAY_SCREEN_ROTATE_MS > 0),
+      rotateIntervalMs_(DISPLAY_SCREEN_ROTATE_MS),
+      lastScreenChangeMs_(0),
+      trend_(nullptr),
+      bus_(nullptr),
       logStream_(nullptr),
       present_(false),
       enabled_(true),
       dimmed_(false),
+      panelOn_(false),
+      panelDimmed_(false),
       flipped_(DISPLAY_ROTATION_DEFAULT == 2),
       address_(0),
       lastRetryMs_(0),
@@ -42,11 +89,35 @@ DisplayController::DisplayController()
       lastPixelShiftMs_(0),
       pixelShiftX_(0),
       pixelShiftPhase_(0),
-      pixelShiftDirty_(false) {}
+      pixelShiftDirty_(false),
+      shadow_{0},
+      shadowValid_(false),
+      flushDirtyPages_(0),
+      flushCount_(0),
+      lastFlushBytes_(0),
+      lastFlushPages_(0),
+      lastFlushUs_(0),
+      maxFlushUs_(0),
+      totalFlushBytes_(0),
+      flushPending_(false),
+      flushPage_(0),
+      flushCol_(0),
+      flushSpanLast_(-1),
+      flushStartMs_(0),
+      flushBytes_(0),
+      flushPages_(0),
+      flushSteps_(0),
+      flushUs_(0),
+      flushFailed_(false),
+      flushNacksAtStart_(0),
+      lastFlushSteps_(0),
+      maxStepUs_(0),
+      lastFrameLatencyMs_(0),
+      maxFrameLatencyMs_(0) {}
 
 DisplayController::~DisplayController() {
   if (oled_ != nullptr) {
-    delete oled_;
+    static_cast<StaticSsd1306*>(oled_)->~StaticSsd1306();
     oled_ = nullptr;
   }
   if (prefsOpened_) {
@@ -55,8 +126,8 @@ DisplayController::~DisplayController() {
   }
 }
 
-bool DisplayController::begin(TwoWire& wire) {
-  wire_ = &wire;
+bool DisplayController::begin(I2cBus& bus) {
+  bus_ = &bus;
   warnedMissing_ = false;
   lastRetryMs_ = 0;
   lastActivityMs_ = millis();
@@ -69,9 +140,14 @@ void DisplayController::update(const UiState& state, unsigned long nowMs) {
   if (!havePotSample_) {
     lastPotRaw_ = state.rawPot;
     havePotSample_ = true;
-  } else if (abs(state.rawPot - lastPotRaw_) >= 12) {
+  } else if (abs(state.rawPot - lastPotRaw_) >= DISPLAY_POT_ACTIVITY_COUNTS) {
     lastActivityMs_ = nowMs;
     lastPotRaw_ = state.rawPot;
+    // The knob's feedback is on the home screen.
+    if (autoRotate_) {
+      screen_ = Screen::Home;
+      lastScreenChangeMs_ = nowMs;
+    }
     if (powerMode_ == PowerMode::Auto && (timeoutDimActive_ || timeoutOffActive_)) {
       timeoutDimActive_ = false;
       timeoutOffActive_ = false;
@@ -120,16 +196,27 @@ void DisplayController::update(const UiState& state, unsigned long nowMs) {
 
   if (present_) {
     updatePixelShift(nowMs);
-    if (!enabled_ || oled_ == nullptr) {
+    updateScreen(state, hasAlert, nowMs);
+    if (oled_ == nullptr) {
+      return;
+    }
+    // The framebuffer must not change under a flush in progress, so a new
+    // frame is only rendered once the previous one has been sent.
+    if (flushPending_) {
+      continueFlush(nowMs);
+      return;
+    }
+    if (!enabled_) {
       return;
     }
     if (!shouldRender(state, nowMs)) {
       return;
     }
-    renderFrame(state);
-    oled_->display();
+    renderFrame(state, nowMs);
+    beginFlush(nowMs);
+    continueFlush(nowMs);
     lastRenderMs_ = nowMs;
-    lastUiHash_ = computeUiHash(state);
+    lastUiHash_ = computeUiHash(state, nowMs);
     return;
   }
   if (lastRetryMs_ != 0 && (nowMs - lastRetryMs_) < kRetryIntervalMs) {
@@ -143,24 +230,31 @@ bool DisplayController::isPresent() const {
   return present_;
 }
 
+bool DisplayController::isFlushPending() const {
+  return flushPending_;
+}
+
 void DisplayController::setEnabled(bool enabled) {
   enabled_ = enabled;
-  if (!present_) {
+  // Called on every update; only a change reaches the bus.
+  if (!present_ || panelOn_ == enabled_) {
     return;
   }
-  if (enabled_) {
-    oled_->ssd1306_command(SSD1306_DISPLAYON);
-  } else {
-    oled_->ssd1306_command(SSD1306_DISPLAYOFF);
+  const uint8_t cmd = enabled_ ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF;
+  if (sendCommands(&cmd, 1)) {
+    panelOn_ = enabled_;
   }
 }
 
 void DisplayController::setDimMode(bool dimmed) {
   dimmed_ = dimmed;
-  if (!present_) {
+  if (!present_ || panelDimmed_ == dimmed_) {
     return;
   }
-  oled_->dim(dimmed_);
+  const uint8_t cmds[] = {SSD1306_SETCONTRAST, dimmed_ ? kContrastDimmed : kContrastNormal};
+  if (sendCommands(cmds, sizeof(cmds))) {
+    panelDimmed_ = dimmed_;
+  }
 }
 
 void DisplayController::setFlip(bool flipped) {
@@ -168,6 +262,8 @@ void DisplayController::setFlip(bool flipped) {
     flipped_ = flipped;
     saveFlipToNvs();
   }
+  canvas_.setFlipped(flipped_);
+  invalidateFrame();
   if (!present_) {
     return;
   }
@@ -179,7 +275,11 @@ void DisplayController::toggleFlip() {
 }
 
 DisplayController::Status DisplayController::getStatus() const {
-  return Status{present_, enabled_, dimmed_, flipped_, address_, powerMode_, dimTimeoutMin_, offTimeoutMin_};
+  return Status{present_,        enabled_,        dimmed_,         flipped_,     address_,
+                powerMode_,      dimTimeoutMin_,  offTimeoutMin_,  flushCount_,  lastFlushBytes_,
+                lastFlushPages_, lastFlushUs_,    maxFlushUs_,     totalFlushBytes_, flushPending_,
+                lastFlushSteps_, maxStepUs_,      lastFrameLatencyMs_, maxFrameLatencyMs_, screen_,
+                autoRotate_,     rotateIntervalMs_};
 }
 
 void DisplayController::setLogStream(Stream& stream) {
@@ -187,22 +287,30 @@ void DisplayController::setLogStream(Stream& stream) {
 }
 
 bool DisplayController::tryDetectAt(uint8_t address) {
-  if (wire_ == nullptr) {
+  if (bus_ == nullptr) {
     return false;
   }
-
-  Adafruit_SSD1306* probe = new Adafruit_SSD1306(DISPLAY_ACTIVE_WIDTH, DISPLAY_ACTIVE_HEIGHT, wire_, -1);
-  if (!probe->begin(SSD1306_SWITCHCAPVCC, address, false, false)) {
-    delete probe;
+  // The driver's begin() never checks for an ACK, so probe first instead of
+  // sending the whole init sequence to an empty address. A headless unit
+  // retrying every minute costs one address-only transaction per address.
+  if (!bus_->probe(address)) {
     return false;
   }
 
-  if (oled_ != nullptr) {
-    delete oled_;
+  if (oled_ == nullptr) {
+    oled_ = new (oledStorage_) StaticSsd1306(framebuffer_, &bus_->wire(), bus_->getClock());
+  }
+  address_ = address;
+  flushPending_ = false;
+  if (!sendCommands(kInitCommands, sizeof(kInitCommands))) {
+    return false;
   }
-  oled_ = probe;
+  panelOn_ = false;
+  panelDimmed_ = false;
+  // Clear GRAM while the panel is still off; tryDetect() then turns it on.
   oled_->clearDisplay();
-  oled_->display();
+  flushWhole();
+  invalidateFrame();
   lastRenderMs_ = 0;
   lastUiHash_ = 0;
   return true;
@@ -233,6 +341,7 @@ bool DisplayController::tryDetect(bool logWarning) {
     return true;
   }
 
+  address_ = 0;
   if (logWarning && !warnedMissing_ && logStream_ != nullptr) {
     logStream_->println("SSD1306 not detected. Running headless.");
     warnedMissing_ = true;
@@ -288,7 +397,33 @@ void DisplayController::setTimeoutOffMinutes(uint16_t minutes) {
   offTimeoutMs_ = static_cast<unsigned long>(minutes) * 60UL * 1000UL;
 }
 
-void DisplayController::runFactoryTest(Stream& serial, unsigned long durationMs, void (*pwmWrite)(int), int maxDuty) {
+void DisplayController::setScreen(Screen screen) {
+  autoRotate_ = false;
+  screen_ = screen;
+}
+
+void DisplayController::setAutoRotate(unsigned long intervalMs) {
+  autoRotate_ = true;
+  rotateIntervalMs_ = intervalMs;
+  screen_ = Screen::Home;
+  lastScreenChangeMs_ = millis();
+}
+
+const char* DisplayController::screenName(Screen screen) {
+  switch (screen) {
+    case Screen::Environment: return "env";
+    case Screen::Heater: return "heater";
+    case Screen::TempTrend: return "temp";
+    case Screen::HumidityTrend: return "rh";
+    default: return "home";
+  }
+}
+
+void DisplayController::setTrendSource(const SensorRollups& rollups) {
+  trend_ = &rollups;
+}
+
+void DisplayController::runFactoryTest(Print& serial, unsigned long durationMs, void (*pwmWrite)(int), int maxDuty) {
   if (!present_) {
     tryDetect(true);
   }
@@ -302,9 +437,11 @@ void DisplayController::runFactoryTest(Stream& serial, unsigned long durationMs,
   setEnabled(true);
   setDimMode(false);
 
-  serial.print("Display test: SSD1306 at 0x");
-  if (address_ < 16) serial.print("0");
-  serial.println(address_, HEX);
+  serial.print("Display test: SSD1306 at ");
+  printHexByte(serial, address_);
+  serial.println();
+  // The test blocks for its whole duration; show the header now.
+  serial.flush();
 
   const unsigned long startMs = millis();
   unsigned long frames = 0;
@@ -337,7 +474,7 @@ void DisplayController::runFactoryTest(Stream& serial, unsigned long durationMs,
     oled_->setCursor(4, 40);
     oled_->print("pwm ");
     oled_->print(pwmHigh ? "HIGH" : "LOW");
-    oled_->display();
+    flushWhole();
 
     const unsigned long frameUs = micros() - t0;
     if (frameUs > maxFrameUs) {
@@ -357,6 +494,12 @@ void DisplayController::runFactoryTest(Stream& serial, unsigned long durationMs,
   if (pwmWrite != nullptr) {
     pwmWrite(0);
   }
+  // The test drew over the framebuffer and wrote GRAM behind the shadow's
+  // back; repaint and resend the next frame whole.
+  invalidateFrame();
+  shadowValid_ = false;
+  flushPending_ = false;
+  lastUiHash_ = 0;
   setPowerMode(prevMode);
   serial.print("Display test done: frames=");
   serial.print(frames);
@@ -379,17 +522,58 @@ void DisplayController::updatePixelShift(unsigned long nowMs) {
   pixelShiftDirty_ = true;
 }
 
+void DisplayController::updateScreen(const UiState& state, bool hasAlert, unsigned long nowMs) {
+  if (!autoRotate_) {
+    return;
+  }
+  if (hasAlert) {
+    // Alerts are on the home screen's banner; hold it while any is active.
+    screen_ = Screen::Home;
+    lastScreenChangeMs_ = nowMs;
+    return;
+  }
+  if (rotateIntervalMs_ == 0 || (nowMs - lastScreenChangeMs_) < rotateIntervalMs_) {
+    return;
+  }
+  lastScreenChangeMs_ = nowMs;
+  uint8_t next = static_cast<uint8_t>(screen_);
+  do {
+    next = static_cast<uint8_t>((next + 1) % kScreenCount);
+  } while (!screenAvailable(static_cast<Screen>(next), state));
+  screen_ = static_cast<Screen>(next);
+}
+
+bool DisplayController::screenAvailable(Screen screen, const UiState& state) const {
+  switch (screen) {
+    case Screen::Environment:
+    case Screen::TempTrend:
+    case Screen::HumidityTrend:
+      return state.hasTempF;
+    case Screen::Heater:
+      return state.sensorPresent;
+    default:
+      return true;
+  }
+}
+
 bool DisplayController::shouldRender(const UiState& state, unsigned long nowMs) {
   if (lastRenderMs_ != 0 && (nowMs - lastRenderMs_) < DISPLAY_REFRESH_INTERVAL_MS) {
     return false;
   }
-  if (pixelShiftDirty_) {
+  if (pixelShiftDirty_ || screen_ != renderedScreen_) {
     return true;
   }
-  return computeUiHash(state) != lastUiHash_;
+  return computeUiHash(state, nowMs) != lastUiHash_;
 }
 
-uint32_t DisplayController::computeUiHash(const UiState& state) const {
+uint32_t DisplayController::computeUiHash(const UiState& state, unsigned long nowMs) const {
+  switch (screen_) {
+    case Screen::Environment: return environmentScreenHash(state);
+    case Screen::Heater: return heaterScreenHash(state, nowMs);
+    case Screen::TempTrend: return trendScreenHash(state, trend_, TrendMetric::Temperature);
+    case Screen::HumidityTrend: return trendScreenHash(state, trend_, TrendMetric::Humidity);
+    default: break;
+  }
   uint32_t h = 2166136261u;
   auto mix = [&h](uint32_t v) {
     h ^= v;
@@ -398,9 +582,14 @@ uint32_t DisplayController::computeUiHash(const UiState& state) const {
 
   mix(static_cast<uint32_t>(state.rtcNow.hour()));
   mix(static_cast<uint32_t>(state.rtcNow.minute()));
+  mix(static_cast<uint32_t>(state.rtcValid));
+  mix(static_cast<uint32_t>(state.usbConnected));
+  // Not the raw duty: it is never drawn and dithering moves it every frame.
   mix(static_cast<uint32_t>(state.brightnessPercent));
-  mix(static_cast<uint32_t>(state.duty));
   mix(static_cast<uint32_t>(state.lightOn));
+  for (size_t i = 0; i < state.channelCount && i < kUiMaxChannels; ++i) {
+    mix(static_cast<uint32_t>(state.channels[i].percent));
+  }
   mix(static_cast<uint32_t>(state.scheduleAllowed));
   mix(static_cast<uint32_t>(state.forceOn));
   mix(static_cast<uint32_t>(state.controlMode));
@@ -414,62 +603,245 @@ uint32_t DisplayController::computeUiHash(const UiState& state) const {
   return h;
 }
 
-void DisplayController::renderFrame(const UiState& state) {
-  oled_->clearDisplay();
-  drawTopYellowZone(state);
-  drawBlueZone(state);
+void DisplayController::renderFrame(const UiState& state, unsigned long nowMs) {
+  // Home screen widgets redraw only what changed since the last frame; a
+  // full repaint starts from a blank buffer with every widget invalidated.
+  // The other screens repaint whole, and only when their hash changes.
+  if (screen_ != renderedScreen_) {
+    renderedScreen_ = screen_;
+    frameValid_ = false;
+  }
+  if (!frameValid_ || screen_ != Screen::Home) {
+    canvas_.clear();
+    clockText_.invalidate();
+    valueText_.invalidate();
+    valueBar_.invalidate();
+    modeLine_.invalidate();
+    eventLine_.invalidate();
+    bannerLine_.invalidate();
+    usbIcon_.invalidate();
+    rtcIcon_.invalidate();
+    modeIcon_.invalidate();
+    alertIcon_.invalidate();
+  }
+  switch (screen_) {
+    case Screen::Environment:
+      drawEnvironmentScreen(canvas_, state, pixelShiftX_);
+      break;
+    case Screen::Heater:
+      drawHeaterScreen(canvas_, state, nowMs, pixelShiftX_);
+      break;
+    case Screen::TempTrend:
+      drawTrendScreen(canvas_, state, trend_, TrendMetric::Temperature, pixelShiftX_);
+      break;
+    case Screen::HumidityTrend:
+      drawTrendScreen(canvas_, state, trend_, TrendMetric::Humidity, pixelShiftX_);
+      break;
+    default:
+      drawTopYellowZone(state);
+      drawBlueZone(state);
+      break;
+  }
+  // A home frame after another screen must start from a blank buffer.
+  frameValid_ = screen_ == Screen::Home;
   pixelShiftDirty_ = false;
 }
 
-void DisplayController::drawTopYellowZone(const UiState& state) {
-  // Top bar contract: three 8x8 icons and right-aligned HH:MM.
-  oled_->drawRect(0, 0, 8, 8, SSD1306_WHITE);   // USB icon placeholder
-  oled_->drawRect(10, 0, 8, 8, SSD1306_WHITE);  // RTC icon placeholder
-  oled_->drawRect(20, 0, 8, 8, SSD1306_WHITE);  // Mode icon placeholder
+void DisplayController::invalidateFrame() {
+  frameValid_ = false;
+}
 
-  char timeBuf[6];
+void DisplayController::beginFlush(unsigned long nowMs) {
+  flushPending_ = true;
+  flushPage_ = 0;
+  flushCol_ = 0;
+  flushSpanLast_ = -1;
+  flushStartMs_ = nowMs;
+  flushBytes_ = 0;
+  flushPages_ = 0;
+  flushSteps_ = 0;
+  flushUs_ = 0;
+  flushFailed_ = false;
+  flushNacksAtStart_ = bus_->getNackCount(address_);
+  flushDirtyPages_ = canvas_.takeDirtyPages();
+}
+
+void DisplayController::continueFlush(unsigned long nowMs) {
+  const unsigned long t0 = micros();
+  const uint8_t* frame = oled_->getBuffer();
+  size_t stepBytes = 0;
+
+  while (stepBytes < kFlushStepMaxBytes && flushPage_ < kPageCount) {
+    if (flushSpanLast_ < 0 && !findNextSpan()) {
+      break;
+    }
+    const size_t offset = static_cast<size_t>(flushPage_) * DISPLAY_ACTIVE_WIDTH + flushCol_;
+    size_t chunk = static_cast<size_t>(flushSpanLast_ - flushCol_ + 1);
+    if (chunk > kFlushChunkBytes) chunk = kFlushChunkBytes;
+    if (chunk > kFlushStepMaxBytes - stepBytes) chunk = kFlushStepMaxBytes - stepBytes;
+
+    if (sendData(frame + offset, chunk)) {
+      memcpy(shadow_ + offset, frame + offset, chunk);
+    } else {
+      flushFailed_ = true;
+    }
+    stepBytes += chunk;
+    flushCol_ = static_cast<int16_t>(flushCol_ + chunk);
+    if (flushCol_ > flushSpanLast_) {
+      flushSpanLast_ = -1;
+      flushCol_ = 0;
+      flushPage_++;
+    }
+  }
+  bus_->service(kFlushStepBudgetUs);
+
+  const unsigned long dt = micros() - t0;
+  flushSteps_++;
+  flushUs_ += dt;
+  if (dt > maxStepUs_) {
+    maxStepUs_ = dt;
+  }
+  if (flushPage_ >= kPageCount && bus_->pendingCount() == 0) {
+    finishFlush(nowMs);
+  }
+}
+
+void DisplayController::finishFlush(unsigned long nowMs) {
+  flushPending_ = false;
+  // Only a flush the panel acknowledged in full leaves GRAM matching the
+  // shadow; otherwise resend everything next frame.
+  shadowValid_ = !flushFailed_ && bus_->getNackCount(address_) == flushNacksAtStart_;
+  flushCount_++;
+  lastFlushBytes_ = flushBytes_;
+  lastFlushPages_ = flushPages_;
+  lastFlushSteps_ = flushSteps_;
+  lastFlushUs_ = flushUs_;
+  if (flushUs_ > maxFlushUs_) {
+    maxFlushUs_ = flushUs_;
+  }
+  totalFlushBytes_ += flushBytes_;
+  lastFrameLatencyMs_ = nowMs - flushStartMs_;
+  if (lastFrameLatencyMs_ > maxFrameLatencyMs_) {
+    maxFrameLatencyMs_ = lastFrameLatencyMs_;
+  }
+}
+
+void DisplayController::flushWhole() {
+  // Blocking full-frame send, for init and the factory test, whose frames
+  // are not drawn through the canvas and so carry no dirty pages.
+  shadowValid_ = false;
+  beginFlush(millis());
+  while (flushPending_) {
+    continueFlush(millis());
+  }
+}
+
+bool DisplayController::findNextSpan() {
+  // Locates the next page with differing columns at or after flushPage_
+  // and points the panel's write window at it.
+  const uint8_t* frame = oled_->getBuffer();
+  for (; flushPage_ < kPageCount; ++flushPage_) {
+    const size_t rowStart = static_cast<size_t>(flushPage_) * DISPLAY_ACTIVE_WIDTH;
+    const uint8_t* row = frame + rowStart;
+    const uint8_t* shadowRow = shadow_ + rowStart;
+
+    int first = 0;
+    int last = DISPLAY_ACTIVE_WIDTH - 1;
+    if (shadowValid_) {
+      if ((flushDirtyPages_ & (1u << flushPage_)) == 0) {
+        continue;
+      }
+      while (first <= last && row[first] == shadowRow[first]) ++first;
+      if (first > last) {
+        continue;
+      }
+      while (row[last] == shadowRow[last]) --last;
+    }
+
+    if (!sendPageWindow(flushPage_, static_cast<uint8_t>(first), static_cast<uint8_t>(last))) {
+      flushFailed_ = true;
+    }
+    flushCol_ = static_cast<int16_t>(first);
+    flushSpanLast_ = static_cast<int16_t>(last);
+    flushPages_++;
+    return true;
+  }
+  return false;
+}
+
+bool DisplayController::sendPageWindow(uint8_t page, uint8_t firstCol, uint8_t lastCol) {
+  // Horizontal addressing (set by begin()): a one-page window wraps back
+  // onto itself, so the data stream lands exactly in [firstCol, lastCol].
+  const uint8_t window[] = {0x00, SSD1306_PAGEADDR, page, page, SSD1306_COLUMNADDR, firstCol, lastCol};
+  flushBytes_ += sizeof(window);
+  return bus_->enqueueWrite(address_, I2cBus::Priority::Low, window, sizeof(window), true);
+}
+
+bool DisplayController::sendCommands(const uint8_t* cmds, size_t count) {
+  uint8_t packet[sizeof(kInitCommands) + 1];
+  if (count >= sizeof(packet)) {
+    return false;
+  }
+  packet[0] = 0x00;
+  memcpy(packet + 1, cmds, count);
+  return bus_->write(address_, packet, count + 1);
+}
+
+bool DisplayController::sendData(const uint8_t* data, size_t count) {
+  uint8_t packet[kFlushChunkBytes + 1];
+  packet[0] = 0x40;
+  memcpy(packet + 1, data, count);
+  flushBytes_ += count + 1;
+  return bus_->enqueueWrite(address_, I2cBus::Priority::Low, packet, count + 1, true);
+}
+
+void DisplayController::drawTopYellowZone(const UiState& state) {
+  // Top bar contract: USB, RTC and mode icons, the most urgent sensor
+  // alert, and right-aligned HH:MM.
+  usbIcon_.update(canvas_, state.usbConnected ? Icon::UsbOn : Icon::UsbOff);
+  rtcIcon_.update(canvas_, state.rtcValid ? Icon::RtcOk : Icon::RtcFault);
+  Icon mode = Icon::ModePot;
+  if (state.controlMode == ControlMode::Schedule) mode = Icon::ModeSchedule;
+  if (state.controlMode == ControlMode::Override) mode = Icon::ModeOverride;
+  modeIcon_.update(canvas_, mode);
+  Icon alert = Icon::None;
+  if (state.needsWatering) alert = Icon::Water;
+  if (state.tooCold) alert = Icon::Cold;
+  if (state.tooHot) alert = Icon::Hot;
+  alertIcon_.update(canvas_, alert);
+
+  char timeBuf[8];
   snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", state.rtcNow.hour(), state.rtcNow.minute());
-  oled_->setTextSize(1);
-  oled_->setTextColor(SSD1306_WHITE);
-  oled_->setCursor(98, 0);
-  oled_->print(timeBuf);
+  clockText_.update(canvas_, 98, timeBuf);
 }
 
 void DisplayController::drawBlueZone(const UiState& state) {
   // Blue zone: primary value, bar, and three status lines.
-  const int sx = pixelShiftX_;
-  oled_->setTextSize(2);  // Approximates 8x16 primary font.
-  oled_->setTextColor(SSD1306_WHITE);
-  oled_->setCursor(1 + sx, 12);
+  const int16_t sx = pixelShiftX_;
   char brightnessBuf[6];
   snprintf(brightnessBuf, sizeof(brightnessBuf), "%3d%%", state.brightnessPercent);
-  oled_->print(brightnessBuf);
-
-  int barX = 56;  // Layout contract.
-  int barY = 14;
-  int barW = 68;
-  int barH = 12;
-  oled_->drawRect(barX + sx, barY, barW, barH, SSD1306_WHITE);
-  int fill = (66 * state.brightnessPercent + 50) / 100;  // round(66 * pct / 100)
-  if (fill > 66) fill = 66;
-  if (fill < 0) fill = 0;
-  if (fill > 0) {
-    oled_->fillRect(57 + sx, 15, fill, 10, SSD1306_WHITE);
-  }
+  valueText_.update(canvas_, static_cast<int16_t>(1 + sx), brightnessBuf);  // 2x font approximates 8x16
+  valueBar_.update(canvas_, sx, static_cast<int16_t>((66 * state.brightnessPercent + 50) / 100));  // round(66 * pct / 100)
 
   char lineBuf[22];
-  oled_->setTextSize(1);
-  snprintf(lineBuf, sizeof(lineBuf), "%s %s", state.lightOn ? "ON " : "OFF", modeText(state.controlMode));
-  if (state.lightOn) {
-    lineBuf[2] = ' ';
-    lineBuf[3] = ' ';
+  if (state.channelCount > 1) {
+    // Mode and per-channel levels, capped at 99 to fit four: "SCH W99 R20 U0".
+    size_t len = static_cast<size_t>(snprintf(lineBuf, sizeof(lineBuf), "%s", modeText(state.controlMode)));
+    for (size_t i = 0; i < state.channelCount && i < kUiMaxChannels; ++i) {
+      const unsigned pct = state.channels[i].percent > 99 ? 99 : state.channels[i].percent;
+      len += static_cast<size_t>(snprintf(lineBuf + len, sizeof(lineBuf) - len, " %c%u", state.channels[i].tag, pct));
+    }
+  } else {
+    snprintf(lineBuf, sizeof(lineBuf), "%s %s", state.lightOn ? "ON " : "OFF", modeText(state.controlMode));
+    if (state.lightOn) {
+      lineBuf[2] = ' ';
+      lineBuf[3] = ' ';
+    }
   }
-  oled_->setCursor(1 + sx, 34);
-  oled_->print(lineBuf);
+  modeLine_.update(canvas_, static_cast<int16_t>(1 + sx), lineBuf);
 
-  copyTrunc21(lineBuf, state.nextEvent);
-  oled_->setCursor(1 + sx, 44);
-  oled_->print(lineBuf);
+  // TextWidget keeps at most 21 characters, the width of a line.
+  eventLine_.update(canvas_, static_cast<int16_t>(1 + sx), state.nextEvent);
 
   const char* banner = "OK";
   if (state.needsWatering) banner = "NEEDS WATERING";
@@ -477,9 +849,7 @@ void DisplayController::drawBlueZone(const UiState& state) {
   if (state.tooHot) banner = "TOO HOT";
   if (!state.rtcValid) banner = "RTC MISSING";
   if (state.usbPowerLimited) banner = "USB POWER LIMITED";
-  copyTrunc21(lineBuf, banner);
-  oled_->setCursor(1 + sx, 54);
-  oled_->print(lineBuf);
+  bannerLine_.update(canvas_, static_cast<int16_t>(1 + sx), banner);
 }
 
 const char* DisplayController::modeText(ControlMode mode) const {
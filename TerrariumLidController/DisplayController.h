@@ -6,6 +6,11 @@
 #include <Adafruit_SSD1306.h>
 #include <Preferences.h>
 #include "DisplayConfig.h"
+#include "DisplayScreens.h"
+#include "DisplayWidgets.h"
+#include "FrameCanvas.h"
+#include "I2cBus.h"
+#include "SensorRollups.h"
 #include "UiState.h"
 
 class DisplayController {
@@ -16,6 +21,15 @@ class DisplayController {
     ForcedOff = 2,
   };
 
+  enum class Screen : uint8_t {
+    Home = 0,
+    Environment = 1,
+    Heater = 2,
+    TempTrend = 3,
+    HumidityTrend = 4,
+  };
+  static constexpr uint8_t kScreenCount = 5;
+
   struct Status {
     bool present;
     bool enabled;
@@ -25,14 +39,30 @@ class DisplayController {
     PowerMode powerMode;
     uint16_t dimTimeoutMin;
     uint16_t offTimeoutMin;
+    unsigned long flushCount;
+    unsigned long lastFlushBytes;
+    uint8_t lastFlushPages;
+    unsigned long lastFlushUs;
+    unsigned long maxFlushUs;
+    unsigned long totalFlushBytes;
+    bool flushPending;
+    uint8_t lastFlushSteps;
+    unsigned long maxStepUs;
+    unsigned long lastFrameLatencyMs;
+    unsigned long maxFrameLatencyMs;
+    Screen screen;
+    bool autoRotate;
+    unsigned long rotateIntervalMs;
   };
 
   DisplayController();
   ~DisplayController();
 
-  bool begin(TwoWire& wire);
+  bool begin(I2cBus& bus);
   void update(const UiState& state, unsigned long nowMs);
   bool isPresent() const;
+  // True while a rendered frame is still being sent in chunks.
+  bool isFlushPending() const;
   void setEnabled(bool enabled);
   void setDimMode(bool dimmed);
   void setFlip(bool flipped);
@@ -40,32 +70,95 @@ class DisplayController {
   void setPowerMode(PowerMode mode);
   void setTimeoutDimMinutes(uint16_t minutes);
   void setTimeoutOffMinutes(uint16_t minutes);
-  void runFactoryTest(Stream& serial, unsigned long durationMs, void (*pwmWrite)(int), int maxDuty);
+  // Shows one screen until setAutoRotate() is called.
+  void setScreen(Screen screen);
+  // Cycles through the screens that have data, starting from home. An
+  // alert or a knob movement returns to home; intervalMs 0 stays there.
+  void setAutoRotate(unsigned long intervalMs);
+  static const char* screenName(Screen screen);
+  // Rollups whose Quarter tier feeds the trend graphs; without them the
+  // graphs show no data.
+  void setTrendSource(const SensorRollups& rollups);
+  void runFactoryTest(Print& serial, unsigned long durationMs, void (*pwmWrite)(int), int maxDuty);
   Status getStatus() const;
   void setLogStream(Stream& stream);
 
  private:
+  // The host golden-image tests render frames directly (host/sim/DisplayGolden.cpp).
+  friend class DisplayGoldenAccess;
+
   static constexpr unsigned long kRetryIntervalMs = 60000;
   static constexpr unsigned long kPixelShiftIntervalMs = 45000;
+  static constexpr uint8_t kPageCount = (DISPLAY_ACTIVE_HEIGHT + 7) / 8;
+  static constexpr size_t kBufferBytes = static_cast<size_t>(DISPLAY_ACTIVE_WIDTH) * kPageCount;
+  static_assert(DISPLAY_ACTIVE_HEIGHT % 8 == 0 && kPageCount <= 8, "dirty-page mask is one byte");
+  // Per update() call the flush queues at most kFlushStepMaxBytes of
+  // pixel data and gives the bus kFlushStepBudgetUs to send it; whatever
+  // is left goes out on the next call.
+  static constexpr size_t kFlushChunkBytes = 32;
+  static constexpr size_t kFlushStepMaxBytes = 128;
+  static constexpr unsigned long kFlushStepBudgetUs = 3000;
 
   bool tryDetectAt(uint8_t address);
   bool tryDetect(bool logWarning);
   void updatePixelShift(unsigned long nowMs);
   void loadFlipFromNvs();
   void saveFlipToNvs();
+  void updateScreen(const UiState& state, bool hasAlert, unsigned long nowMs);
+  bool screenAvailable(Screen screen, const UiState& state) const;
   bool shouldRender(const UiState& state, unsigned long nowMs);
-  uint32_t computeUiHash(const UiState& state) const;
-  void renderFrame(const UiState& state);
+  // Dirty-state hash of what the current screen shows.
+  uint32_t computeUiHash(const UiState& state, unsigned long nowMs) const;
+  void renderFrame(const UiState& state, unsigned long nowMs);
+  void invalidateFrame();
+  void beginFlush(unsigned long nowMs);
+  void continueFlush(unsigned long nowMs);
+  void finishFlush(unsigned long nowMs);
+  void flushWhole();
+  bool findNextSpan();
+  // Blocking command write through the bus (after any queued frame data).
+  bool sendCommands(const uint8_t* cmds, size_t count);
+  bool sendPageWindow(uint8_t page, uint8_t firstCol, uint8_t lastCol);
+  bool sendData(const uint8_t* data, size_t count);
   void drawTopYellowZone(const UiState& state);
   void drawBlueZone(const UiState& state);
   const char* modeText(ControlMode mode) const;
 
+  // The driver and its framebuffer live here, not on the heap: the driver
+  // is placement-constructed on the first ACK and reused by every later
+  // detection.
+  alignas(Adafruit_SSD1306) uint8_t oledStorage_[sizeof(Adafruit_SSD1306)];
+  uint8_t framebuffer_[kBufferBytes];
   Adafruit_SSD1306* oled_;
-  TwoWire* wire_;
+  // Frames are drawn straight into framebuffer_ through the canvas. The
+  // widgets keep what is on screen; frameValid_ false forces a full repaint.
+  FrameCanvas canvas_;
+  TextWidget clockText_;
+  TextWidget valueText_;
+  BarWidget valueBar_;
+  TextWidget modeLine_;
+  TextWidget eventLine_;
+  TextWidget bannerLine_;
+  IconWidget usbIcon_;
+  IconWidget rtcIcon_;
+  IconWidget modeIcon_;
+  IconWidget alertIcon_;
+  bool frameValid_;
+  Screen screen_;
+  Screen renderedScreen_;
+  bool autoRotate_;
+  unsigned long rotateIntervalMs_;
+  unsigned long lastScreenChangeMs_;
+  const SensorRollups* trend_;
+  I2cBus* bus_;
   Stream* logStream_;
   bool present_;
   bool enabled_;
   bool dimmed_;
+  // What the panel was last told; setEnabled()/setDimMode() send only
+  // changes.
+  bool panelOn_;
+  bool panelDimmed_;
   bool flipped_;
   uint8_t address_;
   unsigned long lastRetryMs_;
@@ -88,4 +181,33 @@ class DisplayController {
   int8_t pixelShiftX_;
   uint8_t pixelShiftPhase_;
   bool pixelShiftDirty_;
+  // Copy of what the panel's GRAM holds; flushes send only what differs.
+  uint8_t shadow_[kBufferBytes];
+  bool shadowValid_;
+  // Pages the frame being flushed touched; the rest match the shadow.
+  uint8_t flushDirtyPages_;
+  unsigned long flushCount_;
+  unsigned long lastFlushBytes_;
+  uint8_t lastFlushPages_;
+  unsigned long lastFlushUs_;
+  unsigned long maxFlushUs_;
+  unsigned long totalFlushBytes_;
+  // Resumable flush: the page being sent and the column span left in it.
+  bool flushPending_;
+  uint8_t flushPage_;
+  int16_t flushCol_;
+  int16_t flushSpanLast_;
+  unsigned long flushStartMs_;
+  unsigned long flushBytes_;
+  uint8_t flushPages_;
+  uint8_t flushSteps_;
+  unsigned long flushUs_;
+  // A refused enqueue or a NACK during the flush leaves GRAM unknown; the
+  // shadow is then dropped and the next frame goes out whole.
+  bool flushFailed_;
+  unsigned long flushNacksAtStart_;
+  uint8_t lastFlushSteps_;
+  unsigned long maxStepUs_;
+  unsigned long lastFrameLatencyMs_;
+  unsigned long maxFrameLatencyMs_;
 };
@@ -0,0 +1,243 @@
+#include "DisplayScreens.h"
+#include "DisplayConfig.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+// Same grid as the home screen: title and clock on y=0, a 2x line at
+// y=12, then three text lines.
+constexpr int16_t kClockX = 98;
+constexpr int16_t kBigY = 12;
+constexpr int16_t kLineY[] = {34, 44, 54};
+
+// Graph area right of the axis labels, one column per bucket.
+constexpr int16_t kGraphX = 31;
+constexpr int16_t kGraphTop = 16;
+constexpr int16_t kGraphBottom = DISPLAY_ACTIVE_HEIGHT - 1;
+constexpr SensorRollups::Tier kTrendTier = SensorRollups::Tier::Quarter;
+static_assert(kGraphX + SensorRollups::kQuarterBuckets + 1 <= DISPLAY_ACTIVE_WIDTH, "graph must fit with a +1 px shift");
+// Smallest vertical span, in tenths, so sensor noise does not fill the graph.
+constexpr long kMinSpanTenthsF = 20;
+constexpr long kMinSpanTenthsRh = 50;
+
+struct Hash {
+  uint32_t h = 2166136261u;
+  void mix(uint32_t v) {
+    h ^= v;
+    h *= 16777619u;
+  }
+};
+
+void mixTitle(Hash& hash, const UiState& state) {
+  hash.mix(static_cast<uint32_t>(state.rtcNow.hour()));
+  hash.mix(static_cast<uint32_t>(state.rtcNow.minute()));
+}
+
+void drawTitle(FrameCanvas& canvas, const char* title, const UiState& state) {
+  canvas.drawText(0, 0, title, 1);
+  char timeBuf[8];
+  snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", state.rtcNow.hour(), state.rtcNow.minute());
+  canvas.drawText(kClockX, 0, timeBuf, 1);
+}
+
+long tenths(float value) {
+  return lroundf(value * 10.0f);
+}
+
+// "-12.3", or the whole number alone when wholeOnly. Clamped to +-999.9,
+// which fits every caller's 8-byte buffer.
+void formatTenths(char* out, size_t outSize, long value, bool wholeOnly) {
+  constexpr long kMaxMag = 9999;
+  const char* sign = value < 0 ? "-" : "";
+  long mag = value < 0 ? -value : value;
+  if (mag > kMaxMag) mag = kMaxMag;
+  if (wholeOnly) {
+    snprintf(out, outSize, "%s%ld", sign, (mag + 5) / 10);
+  } else {
+    snprintf(out, outSize, "%s%ld.%ld", sign, mag / 10, mag % 10);
+  }
+}
+
+void formatAge(char* out, size_t outSize, unsigned long lastMs, unsigned long nowMs) {
+  if (lastMs == 0) {
+    snprintf(out, outSize, "--");
+    return;
+  }
+  const unsigned long minutes = (nowMs - lastMs) / 60000UL;
+  if (minutes < 60) {
+    snprintf(out, outSize, "%luM", minutes);
+  } else if (minutes < 48 * 60) {
+    snprintf(out, outSize, "%luH", minutes / 60);
+  } else {
+    snprintf(out, outSize, "%luD", minutes / (24 * 60));
+  }
+}
+
+// Centi-degree C to tenths of a degree F, rounded half away from zero.
+long centiCToTenthsF(long centi) {
+  return (centi * 18L + (centi < 0 ? -50 : 50)) / 100 + 320;
+}
+
+// Bucket extremes in display tenths: degrees F or percent RH. The rollups
+// store centi-units, so rounding back to them first keeps this exact.
+void bucketTenths(const SensorRollups::Bucket& bucket, TrendMetric metric, long& lo, long& hi) {
+  if (metric == TrendMetric::Temperature) {
+    lo = centiCToTenthsF(lroundf(bucket.temperatureC.min * 100.0f));
+    hi = centiCToTenthsF(lroundf(bucket.temperatureC.max * 100.0f));
+  } else {
+    lo = (lroundf(bucket.humidity.min * 100.0f) + 5L) / 10;
+    hi = (lroundf(bucket.humidity.max * 100.0f) + 5L) / 10;
+  }
+}
+
+void formatAxis(char* out, size_t outSize, long value, TrendMetric metric) {
+  if (metric == TrendMetric::Humidity) {
+    formatTenths(out, outSize, value, true);
+    strncat(out, "%", outSize - strlen(out) - 1);
+  } else {
+    // Four characters at most so the label stays left of the graph.
+    formatTenths(out, outSize, value, value <= -100 || value >= 1000);
+  }
+}
+
+int16_t graphY(long value, long lo, long hi) {
+  return static_cast<int16_t>(kGraphBottom - (value - lo) * (kGraphBottom - kGraphTop) / (hi - lo));
+}
+}  // namespace
+
+uint32_t environmentScreenHash(const UiState& state) {
+  Hash hash;
+  mixTitle(hash, state);
+  hash.mix(state.hasTempF ? static_cast<uint32_t>(tenths(state.temperatureF)) : 0x80000000u);
+  hash.mix(state.hasHumidity ? static_cast<uint32_t>(lroundf(state.humidityPercent)) : 0x80000000u);
+  hash.mix(state.hasRange);
+  if (state.hasRange) {
+    hash.mix(static_cast<uint32_t>(tenths(state.temperatureMinF)));
+    hash.mix(static_cast<uint32_t>(tenths(state.temperatureMaxF)));
+    hash.mix(static_cast<uint32_t>(lroundf(state.humidityMin)));
+    hash.mix(static_cast<uint32_t>(lroundf(state.humidityMax)));
+  }
+  return hash.h;
+}
+
+void drawEnvironmentScreen(FrameCanvas& canvas, const UiState& state, int16_t sx) {
+  drawTitle(canvas, "ENVIRONMENT", state);
+  const int16_t x = static_cast<int16_t>(1 + sx);
+  char buf[32];
+  if (state.hasTempF) {
+    formatTenths(buf, sizeof(buf), tenths(state.temperatureF), false);
+    strncat(buf, "F", sizeof(buf) - strlen(buf) - 1);
+  } else {
+    snprintf(buf, sizeof(buf), "--.-F");
+  }
+  canvas.drawText(x, kBigY, buf, 2);
+  if (state.hasHumidity) {
+    snprintf(buf, sizeof(buf), "%3ld%%", lroundf(state.humidityPercent));
+  } else {
+    snprintf(buf, sizeof(buf), " --%%");
+  }
+  canvas.drawText(static_cast<int16_t>(79 + sx), kBigY, buf, 2);
+
+  if (!state.hasRange) {
+    canvas.drawText(x, kLineY[0], "24H --", 1);
+    return;
+  }
+  char lo[8];
+  char hi[8];
+  formatTenths(lo, sizeof(lo), tenths(state.temperatureMinF), false);
+  formatTenths(hi, sizeof(hi), tenths(state.temperatureMaxF), false);
+  snprintf(buf, sizeof(buf), "24H LO %sF HI %sF", lo, hi);
+  canvas.drawText(x, kLineY[0], buf, 1);
+  snprintf(buf, sizeof(buf), "24H LO %ld%%  HI %ld%%", lroundf(state.humidityMin), lroundf(state.humidityMax));
+  canvas.drawText(x, kLineY[1], buf, 1);
+}
+
+uint32_t heaterScreenHash(const UiState& state, unsigned long nowMs) {
+  Hash hash;
+  mixTitle(hash, state);
+  hash.mix(state.sensorPresent);
+  hash.mix(state.heaterOn);
+  hash.mix(state.heaterPulsesLastHour);
+  hash.mix(state.wetStuck);
+  hash.mix(state.condensationFault);
+  hash.mix(static_cast<uint32_t>(state.sensorErrors));
+  char age[16];
+  formatAge(age, sizeof(age), state.heaterLastMs, nowMs);
+  for (const char* c = age; *c != '\0'; ++c) {
+    hash.mix(static_cast<uint8_t>(*c));
+  }
+  return hash.h;
+}
+
+void drawHeaterScreen(FrameCanvas& canvas, const UiState& state, unsigned long nowMs, int16_t sx) {
+  drawTitle(canvas, "HEATER", state);
+  const int16_t x = static_cast<int16_t>(1 + sx);
+  if (!state.sensorPresent) {
+    canvas.drawText(x, kBigY, "--", 2);
+    canvas.drawText(x, kLineY[0], "NO SHT3X SENSOR", 1);
+    return;
+  }
+  char buf[32];
+  canvas.drawText(x, kBigY, state.heaterOn ? "ON" : "OFF", 2);
+  snprintf(buf, sizeof(buf), "PULSES/H %u", state.heaterPulsesLastHour);
+  canvas.drawText(static_cast<int16_t>(56 + sx), kBigY, buf, 1);
+  char age[16];
+  formatAge(age, sizeof(age), state.heaterLastMs, nowMs);
+  snprintf(buf, sizeof(buf), "LAST %s", age);
+  canvas.drawText(static_cast<int16_t>(56 + sx), static_cast<int16_t>(kBigY + 8), buf, 1);
+
+  snprintf(buf, sizeof(buf), "WET STUCK    %s", state.wetStuck ? "YES" : "NO");
+  canvas.drawText(x, kLineY[0], buf, 1);
+  snprintf(buf, sizeof(buf), "CONDENSATION %s", state.condensationFault ? "FAULT" : "OK");
+  canvas.drawText(x, kLineY[1], buf, 1);
+  snprintf(buf, sizeof(buf), "I2C ERRORS   %lu", state.sensorErrors);
+  canvas.drawText(x, kLineY[2], buf, 1);
+}
+
+uint32_t trendScreenHash(const UiState& state, const SensorRollups* rollups, TrendMetric metric) {
+  Hash hash;
+  mixTitle(hash, state);
+  hash.mix(static_cast<uint32_t>(metric));
+  hash.mix(rollups != nullptr ? rollups->getRevision(kTrendTier) : 0);
+  return hash.h;
+}
+
+void drawTrendScreen(FrameCanvas& canvas, const UiState& state, const SensorRollups* rollups, TrendMetric metric,
+                     int16_t sx) {
+  drawTitle(canvas, metric == TrendMetric::Temperature ? "TEMP 24H" : "HUMIDITY 24H", state);
+  SensorRollups::Bucket range;
+  if (rollups == nullptr || !rollups->getRange(kTrendTier, range)) {
+    canvas.drawText(static_cast<int16_t>(1 + sx), kLineY[0], "NO DATA", 1);
+    return;
+  }
+  long lo;
+  long hi;
+  bucketTenths(range, metric, lo, hi);
+  const long minSpan = metric == TrendMetric::Temperature ? kMinSpanTenthsF : kMinSpanTenthsRh;
+  if (hi - lo < minSpan) {
+    lo = (lo + hi) / 2 - minSpan / 2;
+    hi = lo + minSpan;
+  }
+
+  char label[8];
+  formatAxis(label, sizeof(label), hi, metric);
+  canvas.drawText(static_cast<int16_t>(1 + sx), kGraphTop, label, 1);
+  formatAxis(label, sizeof(label), lo, metric);
+  canvas.drawText(static_cast<int16_t>(1 + sx), static_cast<int16_t>(kGraphBottom - 7), label, 1);
+
+  const int16_t right = static_cast<int16_t>(kGraphX + SensorRollups::kQuarterBuckets - 1 + sx);
+  SensorRollups::Bucket bucket;
+  for (size_t age = 0; age < SensorRollups::kQuarterBuckets; ++age) {
+    if (!rollups->getBucket(kTrendTier, age, bucket)) {
+      continue;
+    }
+    long vMin;
+    long vMax;
+    bucketTenths(bucket, metric, vMin, vMax);
+    const int16_t top = graphY(vMax, lo, hi);
+    const int16_t bottom = graphY(vMin, lo, hi);
+    canvas.fillRect(static_cast<int16_t>(right - age), top, 1, static_cast<int16_t>(bottom - top + 1), true);
+  }
+}
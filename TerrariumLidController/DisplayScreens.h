@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+#include "FrameCanvas.h"
+#include "SensorRollups.h"
+#include "UiState.h"
+
+// The screens after home. Each draws a whole screen into a cleared canvas,
+// with its blue-zone content offset by the pixel shift sx. Each hash covers
+// exactly what its screen shows, so an unchanged screen is never redrawn.
+
+enum class TrendMetric : uint8_t {
+  Temperature = 0,
+  Humidity = 1,
+};
+
+uint32_t environmentScreenHash(const UiState& state);
+void drawEnvironmentScreen(FrameCanvas& canvas, const UiState& state, int16_t sx);
+
+uint32_t heaterScreenHash(const UiState& state, unsigned long nowMs);
+void drawHeaterScreen(FrameCanvas& canvas, const UiState& state, unsigned long nowMs, int16_t sx);
+
+// One column per Quarter rollup bucket, newest on the right, each spanning
+// the bucket's min..max. The vertical scale fits the tier's 24 h range.
+uint32_t trendScreenHash(const UiState& state, const SensorRollups* rollups, TrendMetric metric);
+void drawTrendScreen(FrameCanvas& canvas, const UiState& state, const SensorRollups* rollups, TrendMetric metric,
+                     int16_t sx);
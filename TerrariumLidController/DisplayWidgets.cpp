@@ -0,0 +1,86 @@
+#include "DisplayWidgets.h"
+
+#include <string.h>
+
+TextWidget::TextWidget(int16_t boxX, int16_t boxY, int16_t boxW, uint8_t size)
+    : boxX_(boxX),
+      boxY_(boxY),
+      boxW_(boxW),
+      size_(size),
+      valid_(false),
+      lastX_(0),
+      last_{} {}
+
+void TextWidget::invalidate() {
+  valid_ = false;
+}
+
+bool TextWidget::update(FrameCanvas& canvas, int16_t x, const char* text) {
+  if (valid_ && x == lastX_ && strncmp(text, last_, kMaxChars) == 0) {
+    return false;
+  }
+  strncpy(last_, text, kMaxChars);
+  last_[kMaxChars] = '\0';
+  lastX_ = x;
+  valid_ = true;
+  canvas.fillRect(boxX_, boxY_, boxW_, static_cast<int16_t>(8 * size_), false);
+  canvas.drawText(x, boxY_, last_, size_);
+  return true;
+}
+
+BarWidget::BarWidget(int16_t x, int16_t y, int16_t w, int16_t h)
+    : x_(x),
+      y_(y),
+      w_(w),
+      h_(h),
+      valid_(false),
+      lastShift_(0),
+      lastFill_(0) {}
+
+void BarWidget::invalidate() {
+  valid_ = false;
+}
+
+bool BarWidget::update(FrameCanvas& canvas, int16_t shift, int16_t fill) {
+  if (fill < 0) fill = 0;
+  if (fill > w_ - 2) fill = static_cast<int16_t>(w_ - 2);
+  if (valid_ && shift == lastShift_ && fill == lastFill_) {
+    return false;
+  }
+  if (valid_ && shift == lastShift_) {
+    // Same outline: only the interior changes.
+    canvas.fillRect(static_cast<int16_t>(x_ + shift + 1), static_cast<int16_t>(y_ + 1), static_cast<int16_t>(w_ - 2),
+                    static_cast<int16_t>(h_ - 2), false);
+  } else {
+    canvas.fillRect(static_cast<int16_t>(x_ - 1), y_, static_cast<int16_t>(w_ + 2), h_, false);
+    canvas.drawRect(static_cast<int16_t>(x_ + shift), y_, w_, h_);
+  }
+  if (fill > 0) {
+    canvas.fillRect(static_cast<int16_t>(x_ + shift + 1), static_cast<int16_t>(y_ + 1), fill,
+                    static_cast<int16_t>(h_ - 2), true);
+  }
+  valid_ = true;
+  lastShift_ = shift;
+  lastFill_ = fill;
+  return true;
+}
+
+IconWidget::IconWidget(int16_t x, int16_t y)
+    : x_(x),
+      y_(y),
+      valid_(false),
+      last_(Icon::None) {}
+
+void IconWidget::invalidate() {
+  valid_ = false;
+}
+
+bool IconWidget::update(FrameCanvas& canvas, Icon icon) {
+  if (valid_ && icon == last_) {
+    return false;
+  }
+  canvas.drawIcon(x_, y_, iconColumns(icon));
+  valid_ = true;
+  last_ = icon;
+  return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include "FrameCanvas.h"
+#include "IconAtlas.h"
+
+// Retained regions of the status screen. Each widget owns a fixed box,
+// remembers what it last drew there, and repaints only its box when the
+// content or the pixel-shift offset changes. Boxes must not overlap.
+
+class TextWidget {
+ public:
+  static constexpr size_t kMaxChars = 21;
+
+  // Box is boxW wide and one text line (8 * size rows) tall.
+  TextWidget(int16_t boxX, int16_t boxY, int16_t boxW, uint8_t size);
+
+  void invalidate();
+  // Draws up to kMaxChars of text at (x, boxY). Returns true if it repainted.
+  bool update(FrameCanvas& canvas, int16_t x, const char* text);
+
+ private:
+  int16_t boxX_;
+  int16_t boxY_;
+  int16_t boxW_;
+  uint8_t size_;
+  bool valid_;
+  int16_t lastX_;
+  char last_[kMaxChars + 1];
+};
+
+class BarWidget {
+ public:
+  // Outline of w x h at (x + shift, y), filled from the left with up to
+  // w - 2 columns. The box covers the outline at shifts of -1..+1.
+  BarWidget(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  void invalidate();
+  bool update(FrameCanvas& canvas, int16_t shift, int16_t fill);
+
+ private:
+  int16_t x_;
+  int16_t y_;
+  int16_t w_;
+  int16_t h_;
+  bool valid_;
+  int16_t lastShift_;
+  int16_t lastFill_;
+};
+
+class IconWidget {
+ public:
+  // One 8x8 icon box at (x, y).
+  IconWidget(int16_t x, int16_t y);
+
+  void invalidate();
+  bool update(FrameCanvas& canvas, Icon icon);
+
+ private:
+  int16_t x_;
+  int16_t y_;
+  bool valid_;
+  Icon last_;
+};
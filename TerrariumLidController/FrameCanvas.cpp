@@ -0,0 +1,138 @@
+#include "FrameCanvas.h"
+#include "GlyphFont.h"
+
+#include <string.h>
+
+namespace {
+uint8_t reverseBits(uint8_t b) {
+  b = static_cast<uint8_t>((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+  b = static_cast<uint8_t>((b & 0xCC) >> 2 | (b & 0x33) << 2);
+  return static_cast<uint8_t>((b & 0xAA) >> 1 | (b & 0x55) << 1);
+}
+}  // namespace
+
+FrameCanvas::FrameCanvas(uint8_t* buffer, uint8_t width, uint8_t height)
+    : buffer_(buffer),
+      width_(width),
+      height_(height),
+      pages_(static_cast<uint8_t>(height / 8)),
+      flipped_(false),
+      dirtyPages_(0) {}
+
+void FrameCanvas::setFlipped(bool flipped) {
+  flipped_ = flipped;
+}
+
+void FrameCanvas::clear() {
+  memset(buffer_, 0, static_cast<size_t>(width_) * pages_);
+  dirtyPages_ = static_cast<uint8_t>((1u << pages_) - 1);
+}
+
+void FrameCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, bool on) {
+  if (flipped_) {
+    x = static_cast<int16_t>(width_ - x - w);
+    y = static_cast<int16_t>(height_ - y - h);
+  }
+  const int16_t x0 = x < 0 ? 0 : x;
+  const int16_t x1 = x + w > width_ ? width_ : static_cast<int16_t>(x + w);
+  const int16_t y0 = y < 0 ? 0 : y;
+  const int16_t y1 = y + h > height_ ? height_ : static_cast<int16_t>(y + h);
+  if (x0 >= x1 || y0 >= y1) {
+    return;
+  }
+  for (int16_t page = y0 / 8; page <= (y1 - 1) / 8; ++page) {
+    const int16_t top = page * 8 > y0 ? page * 8 : y0;
+    const int16_t bottom = page * 8 + 8 < y1 ? page * 8 + 8 : y1;
+    const uint8_t mask = static_cast<uint8_t>(((1u << (bottom - top)) - 1) << (top - page * 8));
+    uint8_t* row = buffer_ + static_cast<size_t>(page) * width_;
+    for (int16_t col = x0; col < x1; ++col) {
+      row[col] = on ? (row[col] | mask) : (row[col] & ~mask);
+    }
+    dirtyPages_ |= static_cast<uint8_t>(1u << page);
+  }
+}
+
+void FrameCanvas::drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+  fillRect(x, y, w, 1, true);
+  fillRect(x, static_cast<int16_t>(y + h - 1), w, 1, true);
+  fillRect(x, y, 1, h, true);
+  fillRect(static_cast<int16_t>(x + w - 1), y, 1, h, true);
+}
+
+int16_t FrameCanvas::drawText(int16_t x, int16_t y, const char* text, uint8_t size) {
+  for (; *text != '\0'; ++text) {
+    const uint8_t g = glyphIndex(*text);
+    if (size == 2) {
+      for (int16_t i = 0; i < 10; ++i) {
+        const uint16_t column = kFont10x16.columns[g][i];
+        blitColumn(static_cast<int16_t>(x + i), y, static_cast<uint8_t>(column));
+        blitColumn(static_cast<int16_t>(x + i), static_cast<int16_t>(y + 8), static_cast<uint8_t>(column >> 8));
+      }
+      x = static_cast<int16_t>(x + 12);
+    } else {
+      for (int16_t i = 0; i < 5; ++i) {
+        blitColumn(static_cast<int16_t>(x + i), y, kFont5x7.columns[g][i]);
+      }
+      x = static_cast<int16_t>(x + 6);
+    }
+  }
+  return x;
+}
+
+void FrameCanvas::drawIcon(int16_t x, int16_t y, const uint8_t* columns) {
+  if (columns != nullptr && y % 8 == 0 && x >= 0 && x + 8 <= width_ && y >= 0 && y + 8 <= height_) {
+    const uint8_t page = static_cast<uint8_t>((flipped_ ? height_ - 8 - y : y) / 8);
+    uint8_t* dst = buffer_ + static_cast<size_t>(page) * width_;
+    if (flipped_) {
+      dst += width_ - 8 - x;
+      for (uint8_t i = 0; i < 8; ++i) {
+        dst[7 - i] = reverseBits(columns[i]);
+      }
+    } else {
+      memcpy(dst + x, columns, 8);
+    }
+    dirtyPages_ |= static_cast<uint8_t>(1u << page);
+    return;
+  }
+  fillRect(x, y, 8, 8, false);
+  if (columns == nullptr) {
+    return;
+  }
+  for (int16_t i = 0; i < 8; ++i) {
+    blitColumn(static_cast<int16_t>(x + i), y, columns[i]);
+  }
+}
+
+uint8_t FrameCanvas::takeDirtyPages() {
+  const uint8_t pages = dirtyPages_;
+  dirtyPages_ = 0;
+  return pages;
+}
+
+void FrameCanvas::blitColumn(int16_t x, int16_t y, uint8_t bits) {
+  // Eight rows starting at y; in physical rows they straddle at most two pages.
+  if (bits == 0) {
+    return;
+  }
+  if (flipped_) {
+    x = static_cast<int16_t>(width_ - 1 - x);
+    y = static_cast<int16_t>(height_ - 8 - y);
+    bits = reverseBits(bits);
+  }
+  if (x < 0 || x >= width_ || y <= -8 || y >= height_) {
+    return;
+  }
+  if (y < 0) {
+    buffer_[x] |= static_cast<uint8_t>(bits >> -y);
+    dirtyPages_ |= 1;
+    return;
+  }
+  const uint8_t page = static_cast<uint8_t>(y / 8);
+  const uint8_t shift = static_cast<uint8_t>(y % 8);
+  buffer_[static_cast<size_t>(page) * width_ + x] |= static_cast<uint8_t>(bits << shift);
+  dirtyPages_ |= static_cast<uint8_t>(1u << page);
+  if (shift != 0 && page + 1 < pages_) {
+    buffer_[static_cast<size_t>(page + 1) * width_ + x] |= static_cast<uint8_t>(bits >> (8 - shift));
+    dirtyPages_ |= static_cast<uint8_t>(1u << (page + 1));
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Drawing surface over an SSD1306-layout framebuffer (one byte per column
+// per 8-row page, bit 0 on top). Text is OR-ed in a glyph column at a time
+// from the tables in GlyphFont.h rather than pixel by pixel, and every
+// write records the pages it touched so a flush can skip the others.
+//
+// Coordinates are logical: when flipped they go through the same 180 degree
+// turn as Adafruit_GFX rotation 2. Everything is clipped to the buffer, and
+// text does not wrap.
+class FrameCanvas {
+ public:
+  FrameCanvas(uint8_t* buffer, uint8_t width, uint8_t height);
+
+  void setFlipped(bool flipped);
+  void clear();
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, bool on);
+  // One pixel outline.
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h);
+  // Size 1 is the 5x7 font on a 6 px pitch, size 2 the 10x16 font on 12 px.
+  // Returns the x just past the text.
+  int16_t drawText(int16_t x, int16_t y, const char* text, uint8_t size);
+  // Replaces the 8x8 block at (x, y) with eight page columns (IconAtlas.h).
+  // On a page boundary this is a straight byte copy; nullptr blanks it.
+  void drawIcon(int16_t x, int16_t y, const uint8_t* columns);
+  // Pages written since the last call; bit n is page n.
+  uint8_t takeDirtyPages();
+
+ private:
+  void blitColumn(int16_t x, int16_t y, uint8_t bits);
+
+  uint8_t* buffer_;
+  uint8_t width_;
+  uint8_t height_;
+  uint8_t pages_;
+  bool flipped_;
+  uint8_t dirtyPages_;
+};
@@ -0,0 +1,558 @@
+#include "HistoryLog.h"
+#include "LedDimmer.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+
+uint16_t crc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+void putU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+uint16_t getU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+size_t putVarint(uint8_t* out, int32_t value) {
+  uint32_t zz = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  size_t n = 0;
+  while (zz >= 0x80) {
+    out[n++] = static_cast<uint8_t>(zz | 0x80);
+    zz >>= 7;
+  }
+  out[n++] = static_cast<uint8_t>(zz);
+  return n;
+}
+
+bool getVarint(const uint8_t* in, size_t end, size_t& offset, int32_t& value) {
+  uint32_t zz = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (offset >= end) {
+      return false;
+    }
+    const uint8_t b = in[offset++];
+    zz |= static_cast<uint32_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      value = static_cast<int32_t>((zz >> 1) ^ (~(zz & 1) + 1));
+      return true;
+    }
+  }
+  return false;
+}
+
+int32_t roundCenti(float v) {
+  return static_cast<int32_t>(lroundf(v * 100.0f));
+}
+
+}  // namespace
+
+static_assert(HistoryLog::kMaxDuty == LedDimmer::kMaxDuty, "a new duty range needs a new sample record type");
+
+HistoryLog::HistoryLog()
+    : partition_(nullptr),
+      sectorCount_(0),
+      headSector_(0),
+      headSlot_(0),
+      nextSeq_(1),
+      usedRecords_(0),
+      oldestUnix_(0),
+      pending_{0},
+      pendingLen_(0),
+      pendingCount_(0),
+      pendingBaseUnix_(0),
+      pendingLastUnix_(0),
+      pendingLast_{0, 0, 0},
+      events_{},
+      eventCount_(0),
+      queryActive_(false),
+      queryInPending_(false),
+      queryFrom_(0),
+      queryTo_(0),
+      querySector_(0),
+      querySlot_(0),
+      querySectorsLeft_(0),
+      queryHaveRecord_(false),
+      decoder_{},
+      recordsWritten_(0),
+      samplesWritten_(0),
+      erases_(0),
+      crcErrors_(0),
+      writeErrors_(0),
+      droppedEvents_(0) {}
+
+bool HistoryLog::begin(const char* label) {
+  partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (partition_ == nullptr || partition_->size / kSectorSize < 2) {
+    partition_ = nullptr;
+    return false;
+  }
+  sectorCount_ = partition_->size / kSectorSize;
+
+  // The head is the sector whose first record has the highest sequence.
+  uint8_t record[kRecordSize];
+  bool found = false;
+  uint32_t bestSeq = 0;
+  size_t usedSectors = 0;
+  for (size_t s = 0; s < sectorCount_; ++s) {
+    uint8_t type = 0;
+    uint32_t seq = 0;
+    uint32_t baseUnix = 0;
+    if (!readHeader(s, 0, type, seq, baseUnix) || type == 0xFF) {
+      continue;
+    }
+    usedSectors++;
+    if (!loadRecord(s, 0, record)) {
+      continue;
+    }
+    seq = getU32(record + 2);
+    if (!found || static_cast<int32_t>(seq - bestSeq) > 0) {
+      found = true;
+      bestSeq = seq;
+      headSector_ = s;
+    }
+  }
+
+  headSlot_ = 0;
+  nextSeq_ = 1;
+  if (found) {
+    // First fully erased slot; a torn write leaves a partly programmed
+    // slot, which is skipped.
+    uint32_t lastSeq = bestSeq;
+    headSlot_ = kRecordsPerSector;
+    for (size_t slot = 0; slot < kRecordsPerSector; ++slot) {
+      esp_partition_read(partition_, slotOffset(headSector_, slot), record, kRecordSize);
+      bool erased = true;
+      for (uint8_t b : record) {
+        if (b != 0xFF) {
+          erased = false;
+          break;
+        }
+      }
+      if (erased) {
+        headSlot_ = slot;
+        break;
+      }
+      if (getU16(record + kRecordSize - 2) == crc16(record, kRecordSize - 2)) {
+        const uint32_t seq = getU32(record + 2);
+        if (static_cast<int32_t>(seq - lastSeq) > 0) lastSeq = seq;
+      }
+    }
+    nextSeq_ = lastSeq + 1;
+    usedRecords_ = (usedSectors - 1) * kRecordsPerSector + headSlot_;
+  }
+  refreshOldest();
+  return true;
+}
+
+bool HistoryLog::isReady() const {
+  return partition_ != nullptr;
+}
+
+bool HistoryLog::appendSample(const Sample& sample) {
+  if (partition_ == nullptr) {
+    return false;
+  }
+  if (eventCount_ > 0 && !flush()) {
+    return false;
+  }
+  const Packed p = pack(sample);
+  if (pendingCount_ > 0) {
+    uint8_t delta[20];
+    const size_t n = encodeDelta(delta, static_cast<int32_t>(sample.unixTime - pendingLastUnix_), pendingLast_, p);
+    if (pendingLen_ + n <= kPayloadSize && pendingCount_ < 255) {
+      memcpy(pending_ + pendingLen_, delta, n);
+      pendingLen_ += n;
+      pendingCount_++;
+      pendingLastUnix_ = sample.unixTime;
+      pendingLast_ = p;
+      samplesWritten_++;
+      return true;
+    }
+    if (!flush()) {
+      return false;
+    }
+  }
+
+  putU16(pending_, static_cast<uint16_t>(p.tempCenti));
+  putU16(pending_ + 2, p.rhCenti);
+  putU16(pending_ + 4, p.duty);
+  pendingLen_ = 6;
+  pendingCount_ = 1;
+  pendingBaseUnix_ = sample.unixTime;
+  pendingLastUnix_ = sample.unixTime;
+  pendingLast_ = p;
+  samplesWritten_++;
+  return true;
+}
+
+void HistoryLog::appendHeaterEvent(const HeaterEvent& event) {
+  if (partition_ == nullptr) {
+    return;
+  }
+  if (eventCount_ == kEventQueueSize) {
+    memmove(events_, events_ + 1, sizeof(events_[0]) * (kEventQueueSize - 1));
+    eventCount_--;
+    droppedEvents_++;
+  }
+  events_[eventCount_++] = event;
+}
+
+bool HistoryLog::flush() {
+  if (partition_ == nullptr) {
+    return true;
+  }
+  bool ok = true;
+  if (pendingCount_ > 0) {
+    ok = writeRecord(kTypeSamples, pendingCount_, pendingBaseUnix_, pending_, pendingLen_);
+    // A failed write drops the samples rather than retrying forever.
+    pendingCount_ = 0;
+    pendingLen_ = 0;
+  }
+  for (size_t i = 0; i < eventCount_; ++i) {
+    ok = writeHeaterEvent(events_[i]) && ok;
+  }
+  eventCount_ = 0;
+  return ok;
+}
+
+bool HistoryLog::writeHeaterEvent(const HeaterEvent& event) {
+  uint8_t payload[24];
+  putU32(payload, event.durationMs);
+  const Sample before{event.unixTime, true, event.tempBeforeC, event.rhBefore, 0};
+  const Sample after{event.unixTime, true, event.tempAfterC, event.rhAfter, 0};
+  const Packed pb = pack(before);
+  const Packed pa = pack(after);
+  putU16(payload + 4, static_cast<uint16_t>(pb.tempCenti));
+  putU16(payload + 6, pb.rhCenti);
+  putU16(payload + 8, static_cast<uint16_t>(pa.tempCenti));
+  putU16(payload + 10, pa.rhCenti);
+  memset(payload + 12, 0, 12);
+  const size_t reasonLen = strnlen(event.reason, sizeof(event.reason) - 1);
+  memcpy(payload + 12, event.reason, reasonLen);
+  return writeRecord(kTypeHeater, 1, event.unixTime, payload, sizeof(payload));
+}
+
+void HistoryLog::beginQuery(uint32_t fromUnix, uint32_t toUnix) {
+  queryActive_ = partition_ != nullptr;
+  queryInPending_ = false;
+  queryHaveRecord_ = false;
+  queryFrom_ = fromUnix;
+  queryTo_ = toUnix;
+  querySlot_ = 0;
+  querySectorsLeft_ = 0;
+  if (!queryActive_ || usedRecords_ == 0) {
+    return;
+  }
+
+  // Oldest sector: the one after the head once the ring has wrapped.
+  uint8_t type = 0xFF;
+  uint32_t seq = 0;
+  uint32_t baseUnix = 0;
+  const size_t after = (headSector_ + 1) % sectorCount_;
+  readHeader(after, 0, type, seq, baseUnix);
+  querySector_ = type != 0xFF ? after : 0;
+  querySectorsLeft_ = (headSector_ + sectorCount_ - querySector_) % sectorCount_ + 1;
+}
+
+HistoryLog::Item HistoryLog::next(Sample& sample, HeaterEvent& event) {
+  while (queryActive_) {
+    if (queryHaveRecord_) {
+      while (decodeNext(sample)) {
+        if (sample.unixTime >= queryFrom_ && sample.unixTime <= queryTo_) {
+          return Item::Sample;
+        }
+      }
+      queryHaveRecord_ = false;
+    }
+
+    if (queryInPending_) {
+      queryActive_ = false;
+      break;
+    }
+
+    if (advanceQuery()) {
+      if (decoder_.record[0] == kTypeHeater) {
+        decodeHeater(decoder_.record, event);
+        if (event.unixTime >= queryFrom_ && event.unixTime <= queryTo_) {
+          return Item::HeaterEvent;
+        }
+        continue;
+      }
+      queryHaveRecord_ = startDecode(decoder_.record);
+      continue;
+    }
+
+    // Flash is done; finish with the samples still in RAM.
+    queryInPending_ = true;
+    if (pendingCount_ > 0) {
+      memset(decoder_.record, 0xFF, kRecordSize);
+      decoder_.record[0] = kTypeSamples;
+      decoder_.record[1] = pendingCount_;
+      putU32(decoder_.record + 6, pendingBaseUnix_);
+      memcpy(decoder_.record + kHeaderSize, pending_, pendingLen_);
+      queryHaveRecord_ = startDecode(decoder_.record);
+    }
+  }
+  return Item::None;
+}
+
+bool HistoryLog::isQueryActive() const {
+  return queryActive_;
+}
+
+HistoryLog::Status HistoryLog::getStatus() const {
+  Status st{};
+  st.ready = partition_ != nullptr;
+  st.sectors = sectorCount_;
+  st.usedRecords = usedRecords_;
+  st.capacityRecords = sectorCount_ * kRecordsPerSector;
+  st.nextSeq = nextSeq_;
+  st.oldestUnix = oldestUnix_;
+  st.recordsWritten = recordsWritten_;
+  st.samplesWritten = samplesWritten_;
+  st.erases = erases_;
+  st.crcErrors = crcErrors_;
+  st.writeErrors = writeErrors_;
+  st.droppedEvents = droppedEvents_;
+  st.pendingSamples = pendingCount_;
+  st.pendingEvents = eventCount_;
+  return st;
+}
+
+HistoryLog::Packed HistoryLog::pack(const Sample& sample) {
+  Packed p{kInvalidCenti, 0, sample.duty};
+  if (sample.valid) {
+    p.tempCenti = static_cast<int16_t>(constrainCenti(roundCenti(sample.temperatureC), -32767, 32767));
+    p.rhCenti = static_cast<uint16_t>(constrainCenti(roundCenti(sample.humidity), 0, 65535));
+  }
+  return p;
+}
+
+void HistoryLog::unpack(const Packed& p, uint32_t unixTime, Sample& sample) {
+  sample.unixTime = unixTime;
+  sample.valid = p.tempCenti != kInvalidCenti;
+  sample.temperatureC = sample.valid ? p.tempCenti / 100.0f : 0.0f;
+  sample.humidity = sample.valid ? p.rhCenti / 100.0f : 0.0f;
+  sample.duty = p.duty;
+}
+
+size_t HistoryLog::encodeDelta(uint8_t* out, int32_t dt, const Packed& from, const Packed& to) {
+  size_t n = putVarint(out, dt);
+  n += putVarint(out + n, static_cast<int32_t>(to.tempCenti) - from.tempCenti);
+  n += putVarint(out + n, static_cast<int32_t>(to.rhCenti) - from.rhCenti);
+  n += putVarint(out + n, static_cast<int32_t>(to.duty) - from.duty);
+  return n;
+}
+
+int32_t HistoryLog::constrainCenti(int32_t v, int32_t lo, int32_t hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+size_t HistoryLog::slotOffset(size_t sector, size_t slot) const {
+  return sector * kSectorSize + slot * kRecordSize;
+}
+
+bool HistoryLog::readHeader(size_t sector, size_t slot, uint8_t& type, uint32_t& seq, uint32_t& baseUnix) {
+  uint8_t header[kHeaderSize];
+  if (esp_partition_read(partition_, slotOffset(sector, slot), header, sizeof(header)) != ESP_OK) {
+    return false;
+  }
+  type = header[0];
+  seq = getU32(header + 2);
+  baseUnix = getU32(header + 6);
+  return true;
+}
+
+bool HistoryLog::writeRecord(uint8_t type, uint8_t count, uint32_t baseUnix, const uint8_t* payload, size_t len) {
+  if (headSlot_ >= kRecordsPerSector) {
+    headSector_ = (headSector_ + 1) % sectorCount_;
+    headSlot_ = 0;
+  }
+  if (headSlot_ == 0) {
+    uint8_t oldType = 0xFF;
+    uint32_t oldSeq = 0;
+    uint32_t oldUnix = 0;
+    readHeader(headSector_, 0, oldType, oldSeq, oldUnix);
+    if (esp_partition_erase_range(partition_, headSector_ * kSectorSize, kSectorSize) != ESP_OK) {
+      writeErrors_++;
+      return false;
+    }
+    erases_++;
+    if (oldType != 0xFF && usedRecords_ >= kRecordsPerSector) {
+      usedRecords_ -= kRecordsPerSector;
+    }
+  }
+
+  uint8_t record[kRecordSize];
+  memset(record, 0xFF, sizeof(record));
+  record[0] = type;
+  record[1] = count;
+  putU32(record + 2, nextSeq_);
+  putU32(record + 6, baseUnix);
+  memcpy(record + kHeaderSize, payload, len);
+  putU16(record + kRecordSize - 2, crc16(record, kRecordSize - 2));
+
+  const bool ok = esp_partition_write(partition_, slotOffset(headSector_, headSlot_), record, kRecordSize) == ESP_OK;
+  // The slot is consumed either way; a half-written one fails its CRC.
+  headSlot_++;
+  nextSeq_++;
+  usedRecords_++;
+  if (!ok) {
+    writeErrors_++;
+    return false;
+  }
+  recordsWritten_++;
+  if (headSlot_ == 1) {
+    refreshOldest();
+  }
+  return true;
+}
+
+bool HistoryLog::loadRecord(size_t sector, size_t slot, uint8_t* record) {
+  if (esp_partition_read(partition_, slotOffset(sector, slot), record, kRecordSize) != ESP_OK) {
+    return false;
+  }
+  if (record[0] == 0xFF) {
+    return false;
+  }
+  if (getU16(record + kRecordSize - 2) != crc16(record, kRecordSize - 2)) {
+    crcErrors_++;
+    return false;
+  }
+  return record[0] == kTypeSamples || record[0] == kTypeSamplesV1 || record[0] == kTypeHeater;
+}
+
+bool HistoryLog::startDecode(const uint8_t* record) {
+  if (record != decoder_.record) {
+    memcpy(decoder_.record, record, kRecordSize);
+  }
+  decoder_.count = decoder_.record[1];
+  decoder_.index = 0;
+  decoder_.offset = kHeaderSize;
+  decoder_.unixTime = getU32(decoder_.record + 6);
+  return decoder_.count > 0;
+}
+
+bool HistoryLog::decodeNext(Sample& sample) {
+  Decoder& d = decoder_;
+  if (d.index >= d.count) {
+    return false;
+  }
+  const size_t end = kHeaderSize + kPayloadSize;
+  if (d.index == 0) {
+    d.last.tempCenti = static_cast<int16_t>(getU16(d.record + d.offset));
+    d.last.rhCenti = getU16(d.record + d.offset + 2);
+    d.last.duty = getU16(d.record + d.offset + 4);
+    d.offset += 6;
+  } else {
+    int32_t dt = 0;
+    int32_t dTemp = 0;
+    int32_t dRh = 0;
+    int32_t dDuty = 0;
+    if (!getVarint(d.record, end, d.offset, dt) || !getVarint(d.record, end, d.offset, dTemp) ||
+        !getVarint(d.record, end, d.offset, dRh) || !getVarint(d.record, end, d.offset, dDuty)) {
+      d.index = d.count;
+      return false;
+    }
+    d.unixTime += static_cast<uint32_t>(dt);
+    d.last.tempCenti = static_cast<int16_t>(d.last.tempCenti + dTemp);
+    d.last.rhCenti = static_cast<uint16_t>(d.last.rhCenti + dRh);
+    d.last.duty = static_cast<uint16_t>(d.last.duty + dDuty);
+  }
+  d.index++;
+  unpack(d.last, d.unixTime, sample);
+  if (d.record[0] == kTypeSamplesV1) {
+    sample.duty = static_cast<uint16_t>((sample.duty * static_cast<uint32_t>(kMaxDuty) + kMaxDutyV1 / 2) / kMaxDutyV1);
+  }
+  return true;
+}
+
+void HistoryLog::decodeHeater(const uint8_t* record, HeaterEvent& event) const {
+  const uint8_t* p = record + kHeaderSize;
+  Sample before{};
+  Sample after{};
+  unpack(Packed{static_cast<int16_t>(getU16(p + 4)), getU16(p + 6), 0}, 0, before);
+  unpack(Packed{static_cast<int16_t>(getU16(p + 8)), getU16(p + 10), 0}, 0, after);
+  event.unixTime = getU32(record + 6);
+  event.durationMs = getU32(p);
+  memcpy(event.reason, p + 12, sizeof(event.reason) - 1);
+  event.reason[sizeof(event.reason) - 1] = '\0';
+  event.tempBeforeC = before.temperatureC;
+  event.rhBefore = before.humidity;
+  event.tempAfterC = after.temperatureC;
+  event.rhAfter = after.humidity;
+}
+
+bool HistoryLog::advanceQuery() {
+  while (querySectorsLeft_ > 0) {
+    const bool atHead = querySector_ == headSector_;
+    if (querySlot_ >= kRecordsPerSector || (atHead && querySlot_ >= headSlot_)) {
+      querySector_ = (querySector_ + 1) % sectorCount_;
+      querySlot_ = 0;
+      querySectorsLeft_--;
+      continue;
+    }
+
+    if (querySlot_ == 0 && querySectorsLeft_ > 1) {
+      // Skip the whole sector if the next one already starts before the
+      // range: everything in this one is older still.
+      uint8_t type = 0xFF;
+      uint32_t seq = 0;
+      uint32_t nextBase = 0;
+      if (readHeader((querySector_ + 1) % sectorCount_, 0, type, seq, nextBase) && type != 0xFF &&
+          nextBase < queryFrom_) {
+        querySector_ = (querySector_ + 1) % sectorCount_;
+        querySectorsLeft_--;
+        continue;
+      }
+    }
+
+    if (!loadRecord(querySector_, querySlot_++, decoder_.record)) {
+      continue;
+    }
+    if (getU32(decoder_.record + 6) > queryTo_) {
+      querySectorsLeft_ = 0;
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+void HistoryLog::refreshOldest() {
+  oldestUnix_ = 0;
+  for (size_t k = 1; k <= sectorCount_; ++k) {
+    const size_t s = (headSector_ + k) % sectorCount_;
+    uint8_t type = 0xFF;
+    uint32_t seq = 0;
+    uint32_t baseUnix = 0;
+    if (readHeader(s, 0, type, seq, baseUnix) && type != 0xFF) {
+      oldestUnix_ = baseUnix;
+      return;
+    }
+  }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Append-only sensor history in the "history" flash partition (see
+// partitions.csv). The partition is a ring of 4 KB sectors holding
+// fixed-size 64-byte records, each with a sequence number and a CRC. The
+// oldest sector is erased when the write head reaches it, so every sector
+// wears at the same rate.
+//
+// Samples are packed into records as deltas (zigzag varints) from the
+// previous sample; the open record is kept in RAM until it is full, so up
+// to one record of samples is lost on power failure. Heater events get a
+// record each. Only appendSample() and flush() touch flash, so a sector
+// erase (~45 ms) lands in whichever task owns the sampling.
+//
+// Duty is stored as 14-bit LEDC duty. Sample records written before the
+// move from 10-bit duty have their own record type and are rescaled when
+// read.
+class HistoryLog {
+ public:
+  struct Sample {
+    uint32_t unixTime;
+    bool valid;
+    float temperatureC;
+    float humidity;
+    uint16_t duty;
+  };
+
+  struct HeaterEvent {
+    uint32_t unixTime;
+    uint32_t durationMs;
+    char reason[12];
+    float rhBefore;
+    float tempBeforeC;
+    float rhAfter;
+    float tempAfterC;
+  };
+
+  enum class Item : uint8_t {
+    None = 0,
+    Sample = 1,
+    HeaterEvent = 2,
+  };
+
+  struct Status {
+    bool ready;
+    size_t sectors;
+    size_t usedRecords;
+    size_t capacityRecords;
+    uint32_t nextSeq;
+    uint32_t oldestUnix;
+    unsigned long recordsWritten;
+    unsigned long samplesWritten;
+    unsigned long erases;
+    unsigned long crcErrors;
+    unsigned long writeErrors;
+    unsigned long droppedEvents;
+    size_t pendingSamples;
+    size_t pendingEvents;
+  };
+
+  static constexpr size_t kSectorSize = 4096;
+  static constexpr size_t kRecordSize = 64;
+  static constexpr size_t kRecordsPerSector = kSectorSize / kRecordSize;
+  // Range of Sample::duty.
+  static constexpr uint16_t kMaxDuty = 16383;
+
+  HistoryLog();
+
+  // Finds the partition and the write head. Returns false (and the log
+  // stays inert) if the partition is missing.
+  bool begin(const char* label = "history");
+  bool isReady() const;
+  bool appendSample(const Sample& sample);
+  // Queued in RAM and written, after the samples that precede it, by the
+  // next appendSample() or flush(). The oldest is dropped if the queue is
+  // full.
+  void appendHeaterEvent(const HeaterEvent& event);
+  // Writes the open sample record even if it is not full.
+  bool flush();
+
+  // Walks stored records (oldest first, then the open record) and returns
+  // the items with fromUnix <= time <= toUnix, one per next() call.
+  void beginQuery(uint32_t fromUnix, uint32_t toUnix);
+  Item next(Sample& sample, HeaterEvent& event);
+  bool isQueryActive() const;
+
+  Status getStatus() const;
+
+ private:
+  static constexpr size_t kHeaderSize = 10;
+  static constexpr size_t kPayloadSize = kRecordSize - kHeaderSize - 2;
+  static constexpr uint8_t kTypeSamplesV1 = 0x5A;  // 10-bit duty, read only
+  static constexpr uint8_t kTypeHeater = 0x5B;
+  static constexpr uint8_t kTypeSamples = 0x5C;
+  static constexpr uint16_t kMaxDutyV1 = 1023;
+  static constexpr int16_t kInvalidCenti = INT16_MIN;
+  static constexpr size_t kEventQueueSize = 8;
+
+  struct Packed {
+    int16_t tempCenti;
+    uint16_t rhCenti;
+    uint16_t duty;
+  };
+
+  struct Decoder {
+    uint8_t record[kRecordSize];
+    uint8_t count;
+    uint8_t index;
+    size_t offset;
+    uint32_t unixTime;
+    Packed last;
+  };
+
+  static Packed pack(const Sample& sample);
+  static void unpack(const Packed& p, uint32_t unixTime, Sample& sample);
+  static size_t encodeDelta(uint8_t* out, int32_t dt, const Packed& from, const Packed& to);
+  static int32_t constrainCenti(int32_t v, int32_t lo, int32_t hi);
+
+  size_t slotOffset(size_t sector, size_t slot) const;
+  bool readHeader(size_t sector, size_t slot, uint8_t& type, uint32_t& seq, uint32_t& baseUnix);
+  bool writeHeaterEvent(const HeaterEvent& event);
+  bool writeRecord(uint8_t type, uint8_t count, uint32_t baseUnix, const uint8_t* payload, size_t len);
+  bool loadRecord(size_t sector, size_t slot, uint8_t* record);
+  bool startDecode(const uint8_t* record);
+  bool decodeNext(Sample& sample);
+  void decodeHeater(const uint8_t* record, HeaterEvent& event) const;
+  bool advanceQuery();
+  void refreshOldest();
+
+  const esp_partition_t* partition_;
+  size_t sectorCount_;
+  size_t headSector_;
+  size_t headSlot_;
+  uint32_t nextSeq_;
+  size_t usedRecords_;
+  uint32_t oldestUnix_;
+
+  uint8_t pending_[kPayloadSize];
+  size_t pendingLen_;
+  uint8_t pendingCount_;
+  uint32_t pendingBaseUnix_;
+  uint32_t pendingLastUnix_;
+  Packed pendingLast_;
+  HeaterEvent events_[kEventQueueSize];
+  size_t eventCount_;
+
+  bool queryActive_;
+  bool queryInPending_;
+  uint32_t queryFrom_;
+  uint32_t queryTo_;
+  size_t querySector_;
+  size_t querySlot_;
+  size_t querySectorsLeft_;
+  bool queryHaveRecord_;
+  Decoder decoder_;
+
+  unsigned long recordsWritten_;
+  unsigned long samplesWritten_;
+  unsigned long erases_;
+  unsigned long crcErrors_;
+  unsigned long writeErrors_;
+  unsigned long droppedEvents_;
+};
@@ -0,0 +1,367 @@
+#include "I2cBus.h"
+
+#include <string.h>
+
+namespace {
+struct KnownDevice {
+  uint8_t address;
+  uint32_t maxClockHz;
+};
+
+// Parts this lid is built with, and the fastest clock each is rated for.
+const KnownDevice kKnownDevices[] = {
+    {0x3C, 400000},   // SSD1306
+    {0x3D, 400000},   // SSD1306 (alt)
+    {0x44, 1000000},  // SHT3x
+    {0x45, 1000000},  // SHT3x (alt)
+    {0x57, 400000},   // AT24C32 EEPROM on DS3231 modules
+    {0x68, 400000},   // DS3231
+};
+}
+
+const unsigned long I2cBus::kLatencyBucketUs[I2cBus::kLatencyBuckets - 1] = {100, 250, 500, 1000, 2500, 5000};
+
+I2cBus::I2cBus(TwoWire& wire)
+    : wire_(wire),
+      clockHz_(100000),
+      present_{0},
+      unknownPresent_(false),
+      queue_{},
+      tail_(-1),
+      nextSeq_(0),
+      devices_{},
+      deviceCount_(0),
+      coalescedWrites_(0),
+      prefsOpened_(false) {}
+
+bool I2cBus::begin(int sda, int scl) {
+  if (!wire_.begin(sda, scl)) {
+    return false;
+  }
+  clockHz_ = 100000;
+  applyClock();
+  scan();
+
+  uint32_t hz = maxSafeClockHz();
+  loadClockFromNvs(hz);
+  clockHz_ = hz;
+  applyClock();
+  return true;
+}
+
+TwoWire& I2cBus::wire() {
+  return wire_;
+}
+
+void I2cBus::scan() {
+  memset(present_, 0, sizeof(present_));
+  unknownPresent_ = false;
+  applyClock();
+  for (uint8_t addr = 1; addr < 127; addr++) {
+    // Raw probe: empty addresses should not take a stats slot.
+    wire_.beginTransmission(addr);
+    if (wire_.endTransmission() != 0) {
+      continue;
+    }
+    present_[addr / 8] |= static_cast<uint8_t>(1u << (addr % 8));
+    bool known = false;
+    for (const KnownDevice& d : kKnownDevices) {
+      if (d.address == addr) known = true;
+    }
+    if (!known) unknownPresent_ = true;
+  }
+}
+
+bool I2cBus::isPresent(uint8_t address) const {
+  if (address >= 128) {
+    return false;
+  }
+  return (present_[address / 8] & (1u << (address % 8))) != 0;
+}
+
+bool I2cBus::isSupportedClock(uint32_t hz) {
+  return hz == 100000 || hz == 400000 || hz == 1000000;
+}
+
+bool I2cBus::setClock(uint32_t hz, bool force) {
+  if (!isSupportedClock(hz)) {
+    return false;
+  }
+  const bool safe = hz <= maxSafeClockHz();
+  if (!safe && !force) {
+    return false;
+  }
+  clockHz_ = hz;
+  applyClock();
+  if (safe) {
+    saveClockToNvs();
+  }
+  return true;
+}
+
+uint32_t I2cBus::getClock() const {
+  return clockHz_;
+}
+
+uint32_t I2cBus::maxSafeClockHz() const {
+  if (unknownPresent_) {
+    return 100000;
+  }
+  uint32_t hz = 1000000;
+  bool any = false;
+  for (const KnownDevice& d : kKnownDevices) {
+    if (isPresent(d.address)) {
+      any = true;
+      if (d.maxClockHz < hz) hz = d.maxClockHz;
+    }
+  }
+  return any ? hz : 100000;
+}
+
+bool I2cBus::probe(uint8_t address) {
+  return write(address, nullptr, 0);
+}
+
+bool I2cBus::write(uint8_t address, const uint8_t* data, size_t len) {
+  drainAddress(address);
+  applyClock();
+  const unsigned long t0 = micros();
+  wire_.beginTransmission(address);
+  if (len > 0) {
+    wire_.write(data, len);
+  }
+  const bool ok = wire_.endTransmission() == 0;
+  record(address, len, ok, micros() - t0);
+  return ok;
+}
+
+bool I2cBus::read(uint8_t address, uint8_t* rx, size_t rxLen) {
+  return writeRead(address, nullptr, 0, rx, rxLen);
+}
+
+bool I2cBus::writeRead(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) {
+  drainAddress(address);
+  applyClock();
+  const unsigned long t0 = micros();
+  bool ok = true;
+  if (txLen > 0) {
+    wire_.beginTransmission(address);
+    wire_.write(tx, txLen);
+    ok = wire_.endTransmission(false) == 0;
+  }
+  size_t got = 0;
+  if (ok && rxLen > 0) {
+    got = wire_.requestFrom(address, rxLen);
+    for (size_t i = 0; i < got && i < rxLen; ++i) {
+      rx[i] = static_cast<uint8_t>(wire_.read());
+    }
+    ok = got == rxLen;
+  }
+  record(address, txLen + got, ok, micros() - t0);
+  return ok;
+}
+
+bool I2cBus::enqueueWrite(uint8_t address, Priority priority, const uint8_t* data, size_t len, bool coalesce) {
+  if (len == 0 || len > kMaxPayload) {
+    return false;
+  }
+
+  if (coalesce && tail_ >= 0) {
+    Pending& t = queue_[tail_];
+    if (t.used && t.coalesce && t.address == address && t.priority == priority && t.data[0] == data[0] &&
+        t.len + len - 1 <= kMaxPayload) {
+      memcpy(t.data + t.len, data + 1, len - 1);
+      t.len += len - 1;
+      coalescedWrites_++;
+      return true;
+    }
+  }
+
+  int slot = -1;
+  for (size_t i = 0; i < kQueueDepth; ++i) {
+    if (!queue_[i].used) {
+      slot = static_cast<int>(i);
+      break;
+    }
+  }
+  if (slot < 0) {
+    // Full: make room by sending the most urgent entry now.
+    slot = nextPendingIndex(-1);
+    sendPending(static_cast<size_t>(slot));
+  }
+
+  Pending& p = queue_[slot];
+  p.used = true;
+  p.coalesce = coalesce;
+  p.address = address;
+  p.priority = priority;
+  p.seq = nextSeq_++;
+  p.queuedUs = micros();
+  p.len = len;
+  memcpy(p.data, data, len);
+  tail_ = slot;
+  return true;
+}
+
+size_t I2cBus::service(unsigned long budgetUs) {
+  const unsigned long t0 = micros();
+  size_t sent = 0;
+  for (;;) {
+    int index = nextPendingIndex(-1);
+    if (index < 0) {
+      break;
+    }
+    sendPending(static_cast<size_t>(index));
+    sent++;
+    if ((micros() - t0) >= budgetUs) {
+      break;
+    }
+  }
+  return sent;
+}
+
+size_t I2cBus::pendingCount() const {
+  size_t n = 0;
+  for (const Pending& p : queue_) {
+    if (p.used) n++;
+  }
+  return n;
+}
+
+size_t I2cBus::getDeviceCount() const {
+  return deviceCount_;
+}
+
+I2cBus::DeviceStats I2cBus::getDeviceStats(size_t index) const {
+  if (index >= deviceCount_) {
+    return DeviceStats{};
+  }
+  return devices_[index];
+}
+
+unsigned long I2cBus::getNackCount(uint8_t address) const {
+  for (size_t i = 0; i < deviceCount_; ++i) {
+    if (devices_[i].address == address) {
+      return devices_[i].nacks;
+    }
+  }
+  return 0;
+}
+
+unsigned long I2cBus::getCoalescedWrites() const {
+  return coalescedWrites_;
+}
+
+void I2cBus::resetStats() {
+  for (size_t i = 0; i < deviceCount_; ++i) {
+    const uint8_t address = devices_[i].address;
+    devices_[i] = DeviceStats{};
+    devices_[i].address = address;
+  }
+  coalescedWrites_ = 0;
+}
+
+void I2cBus::applyClock() {
+  // Adafruit_SSD1306 sets its own clock around transfers; put ours back.
+  if (wire_.getClock() != clockHz_) {
+    wire_.setClock(clockHz_);
+  }
+}
+
+int I2cBus::nextPendingIndex(int address) const {
+  int best = -1;
+  for (size_t i = 0; i < kQueueDepth; ++i) {
+    const Pending& p = queue_[i];
+    if (!p.used || (address >= 0 && p.address != address)) {
+      continue;
+    }
+    if (best < 0 || p.priority < queue_[best].priority ||
+        (p.priority == queue_[best].priority && static_cast<int32_t>(p.seq - queue_[best].seq) < 0)) {
+      best = static_cast<int>(i);
+    }
+  }
+  return best;
+}
+
+bool I2cBus::sendPending(size_t index) {
+  Pending& p = queue_[index];
+  applyClock();
+  wire_.beginTransmission(p.address);
+  wire_.write(p.data, p.len);
+  const bool ok = wire_.endTransmission() == 0;
+  record(p.address, p.len, ok, micros() - p.queuedUs);
+  p.used = false;
+  if (tail_ == static_cast<int>(index)) {
+    tail_ = -1;
+  }
+  return ok;
+}
+
+void I2cBus::drainAddress(uint8_t address) {
+  // Keep per-device ordering: queued writes to this device go out before
+  // a blocking transaction to it.
+  int index;
+  while ((index = nextPendingIndex(address)) >= 0) {
+    sendPending(static_cast<size_t>(index));
+  }
+}
+
+void I2cBus::record(uint8_t address, size_t bytes, bool ok, unsigned long latencyUs) {
+  DeviceStats* st = statsFor(address);
+  if (st == nullptr) {
+    return;
+  }
+  st->transactions++;
+  st->bytes += bytes;
+  if (!ok) {
+    st->nacks++;
+  }
+  if (latencyUs > st->maxLatencyUs) {
+    st->maxLatencyUs = latencyUs;
+  }
+  size_t bucket = 0;
+  while (bucket < kLatencyBuckets - 1 && latencyUs >= kLatencyBucketUs[bucket]) {
+    bucket++;
+  }
+  st->latency[bucket]++;
+}
+
+I2cBus::DeviceStats* I2cBus::statsFor(uint8_t address) {
+  for (size_t i = 0; i < deviceCount_; ++i) {
+    if (devices_[i].address == address) {
+      return &devices_[i];
+    }
+  }
+  if (deviceCount_ >= kMaxDevices) {
+    return nullptr;
+  }
+  DeviceStats& st = devices_[deviceCount_++];
+  st = DeviceStats{};
+  st.address = address;
+  return &st;
+}
+
+void I2cBus::loadClockFromNvs(uint32_t& hz) {
+  if (!prefsOpened_) {
+    prefsOpened_ = prefs_.begin("i2c", false);
+  }
+  if (!prefsOpened_) {
+    return;
+  }
+  // The saved clock may predate a device added to the bus since; never
+  // let it exceed what this boot's scan found safe.
+  const uint32_t saved = prefs_.getUInt("clock_hz", hz);
+  if (isSupportedClock(saved) && saved <= hz) {
+    hz = saved;
+  }
+}
+
+void I2cBus::saveClockToNvs() {
+  if (!prefsOpened_) {
+    prefsOpened_ = prefs_.begin("i2c", false);
+  }
+  if (!prefsOpened_) {
+    return;
+  }
+  prefs_.putUInt("clock_hz", clockHz_);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Preferences.h>
+
+// Owner of the shared I2C bus. Blocking transactions run immediately;
+// queued writes wait in a small priority queue and go out from service(),
+// so sensor and RTC traffic is never stuck behind a display frame. Every
+// transaction is counted per device address.
+class I2cBus {
+ public:
+  enum class Priority : uint8_t {
+    High = 0,
+    Normal = 1,
+    Low = 2,
+  };
+
+  static constexpr size_t kLatencyBuckets = 7;
+
+  struct DeviceStats {
+    uint8_t address;
+    unsigned long transactions;
+    unsigned long bytes;
+    unsigned long nacks;
+    unsigned long maxLatencyUs;
+    // Submit-to-completion time; bucket i counts latencies below
+    // kLatencyBucketUs[i], the last bucket everything slower.
+    unsigned long latency[kLatencyBuckets];
+  };
+
+  static const unsigned long kLatencyBucketUs[kLatencyBuckets - 1];
+
+  explicit I2cBus(TwoWire& wire);
+
+  // Starts the bus, scans it and applies the saved (or fastest safe) clock.
+  bool begin(int sda, int scl);
+  TwoWire& wire();
+  void scan();
+  bool isPresent(uint8_t address) const;
+  static bool isSupportedClock(uint32_t hz);
+  // Accepts 100000, 400000 or 1000000 Hz up to maxSafeClockHz(); the choice
+  // is saved to NVS. With force a faster clock is applied too, but only
+  // until reboot.
+  bool setClock(uint32_t hz, bool force = false);
+  uint32_t getClock() const;
+  // Fastest clock every detected device is rated for (100 kHz if any
+  // unknown device answers the scan).
+  uint32_t maxSafeClockHz() const;
+
+  bool probe(uint8_t address);
+  bool write(uint8_t address, const uint8_t* data, size_t len);
+  bool read(uint8_t address, uint8_t* rx, size_t rxLen);
+  bool writeRead(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen);
+
+  // Queues a write. With coalesce set, a write whose first (control) byte
+  // matches the queue tail for the same device is appended to it instead
+  // of becoming its own transaction (for SSD1306-style 0x00/0x40 streams).
+  bool enqueueWrite(uint8_t address, Priority priority, const uint8_t* data, size_t len, bool coalesce = false);
+  // Sends queued writes in priority order until empty or budgetUs is used.
+  size_t service(unsigned long budgetUs);
+  size_t pendingCount() const;
+
+  size_t getDeviceCount() const;
+  DeviceStats getDeviceStats(size_t index) const;
+  // Failed transactions to one device so far (0 if it has no stats slot).
+  unsigned long getNackCount(uint8_t address) const;
+  unsigned long getCoalescedWrites() const;
+  void resetStats();
+
+ private:
+  static constexpr size_t kQueueDepth = 8;
+  static constexpr size_t kMaxPayload = I2C_BUFFER_LENGTH;
+  static constexpr size_t kMaxDevices = 8;
+
+  struct Pending {
+    bool used;
+    bool coalesce;
+    uint8_t address;
+    Priority priority;
+    uint32_t seq;
+    unsigned long queuedUs;
+    size_t len;
+    uint8_t data[kMaxPayload];
+  };
+
+  void applyClock();
+  int nextPendingIndex(int address) const;
+  bool sendPending(size_t index);
+  void drainAddress(uint8_t address);
+  void record(uint8_t address, size_t bytes, bool ok, unsigned long latencyUs);
+  DeviceStats* statsFor(uint8_t address);
+  void loadClockFromNvs(uint32_t& hz);
+  void saveClockToNvs();
+
+  TwoWire& wire_;
+  uint32_t clockHz_;
+  uint8_t present_[16];
+  bool unknownPresent_;
+  Pending queue_[kQueueDepth];
+  int tail_;
+  uint32_t nextSeq_;
+  DeviceStats devices_[kMaxDevices];
+  size_t deviceCount_;
+  unsigned long coalescedWrites_;
+  Preferences prefs_;
+  bool prefsOpened_;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+// 8x8 status-bar icons for FrameCanvas::drawIcon(). They are drawn below as
+// rows (MSB on the left) and turned into SSD1306 page columns (bit 0 on top)
+// at compile time, so the atlas sits in flash ready to copy.
+
+enum class Icon : uint8_t {
+  UsbOff = 0,
+  UsbOn = 1,
+  RtcOk = 2,
+  RtcFault = 3,
+  ModePot = 4,
+  ModeSchedule = 5,
+  ModeOverride = 6,
+  Water = 7,
+  Cold = 8,
+  Hot = 9,
+  None = 0xFF,  // blank box
+};
+constexpr uint8_t kIconCount = 10;
+
+struct IconRows {
+  uint8_t rows[8];
+};
+
+constexpr IconRows kIconRows[kIconCount] = {
+    // UsbOff: the plug outline from the display spec.
+    {{0b00111000, 0b00101000, 0b11111110, 0b00101000, 0b00111000, 0b00010000, 0b00010000, 0b00010000}},
+    // UsbOn: the same plug knocked out of a solid block.
+    {{0b11000111, 0b11010111, 0b00000001, 0b11010111, 0b11000111, 0b11101111, 0b11101111, 0b11101111}},
+    // RtcOk: clock face.
+    {{0b00111100, 0b01000010, 0b10011001, 0b10001001, 0b10000001, 0b10000001, 0b01000010, 0b00111100}},
+    // RtcFault: clock face with a bar through it.
+    {{0b00111101, 0b01000010, 0b10000101, 0b10001001, 0b10010001, 0b10100001, 0b01000010, 0b10111100}},
+    // ModePot: "M".
+    {{0b10000010, 0b11000110, 0b10101010, 0b10010010, 0b10000010, 0b10000010, 0b10000010, 0b00000000}},
+    // ModeSchedule: "S".
+    {{0b01111100, 0b10000010, 0b10000000, 0b01111100, 0b00000010, 0b10000010, 0b01111100, 0b00000000}},
+    // ModeOverride: "!" knocked out of a solid block.
+    {{0b11100111, 0b11100111, 0b11100111, 0b11100111, 0b11100111, 0b11111111, 0b11100111, 0b11100111}},
+    // Water: drop.
+    {{0b00010000, 0b00010000, 0b00101000, 0b01000100, 0b10000010, 0b10000010, 0b01000100, 0b00111000}},
+    // Cold: snowflake.
+    {{0b00010000, 0b01010100, 0b00111000, 0b11111110, 0b00111000, 0b01010100, 0b00010000, 0b00000000}},
+    // Hot: flame.
+    {{0b00010000, 0b00011000, 0b00111000, 0b00111100, 0b01111110, 0b01111110, 0b01111110, 0b00111100}},
+};
+
+struct IconAtlas {
+  uint8_t columns[kIconCount][8];
+
+  constexpr IconAtlas() : columns{} {
+    for (uint8_t i = 0; i < kIconCount; ++i) {
+      for (uint8_t x = 0; x < 8; ++x) {
+        uint8_t column = 0;
+        for (uint8_t y = 0; y < 8; ++y) {
+          column = static_cast<uint8_t>(column | ((kIconRows[i].rows[y] >> (7 - x)) & 1) << y);
+        }
+        columns[i][x] = column;
+      }
+    }
+  }
+};
+
+constexpr IconAtlas kIconAtlas{};
+
+static_assert(kIconAtlas.columns[static_cast<uint8_t>(Icon::UsbOff)][2] == 0x1F, "plug body on rows 0..4");
+static_assert(kIconAtlas.columns[static_cast<uint8_t>(Icon::ModeOverride)][3] == 0x20, "bang knocked out of the block");
+
+// Columns of icon, or nullptr for Icon::None.
+constexpr const uint8_t* iconColumns(Icon icon) {
+  return static_cast<uint8_t>(icon) < kIconCount ? kIconAtlas.columns[static_cast<uint8_t>(icon)] : nullptr;
+}
@@ -0,0 +1,84 @@
+#include "LedDimmer.h"
+
+namespace {
+
+// CIE 1931 lightness L* (0..100) to relative luminance Y (0..1).
+constexpr double cieLuminance(double lightness) {
+  if (lightness <= 8.0) {
+    return lightness / 903.3;
+  }
+  const double f = (lightness + 16.0) / 116.0;
+  return f * f * f;
+}
+
+// 257 points so index + 1 never runs off the end while interpolating.
+struct CieTable {
+  uint16_t values[257];
+  constexpr CieTable() : values{} {
+    for (int i = 0; i <= 256; ++i) {
+      values[i] = static_cast<uint16_t>(cieLuminance(100.0 * i / 256.0) * 65535.0 + 0.5);
+    }
+  }
+};
+
+constexpr CieTable kCie;
+static_assert(kCie.values[0] == 0 && kCie.values[256] == 65535, "CIE table endpoints");
+
+}  // namespace
+
+LedDimmer::LedDimmer(uint16_t ceilingQ16, Curve curve)
+    : ceilingQ16_(ceilingQ16),
+      curve_(curve),
+      carry_(0) {}
+
+void LedDimmer::setCeiling(uint16_t ceilingQ16) {
+  ceilingQ16_ = ceilingQ16;
+}
+
+void LedDimmer::setCurve(Curve curve) {
+  curve_ = curve;
+}
+
+LedDimmer::Curve LedDimmer::getCurve() const {
+  return curve_;
+}
+
+uint16_t LedDimmer::toLinear(uint16_t levelQ16) {
+  if (levelQ16 == 65535) {
+    return 65535;
+  }
+  const uint32_t index = levelQ16 >> 8;
+  const uint32_t frac = levelQ16 & 0xFF;
+  const uint32_t a = kCie.values[index];
+  const uint32_t b = kCie.values[index + 1];
+  return static_cast<uint16_t>(a + (((b - a) * frac + 128) >> 8));
+}
+
+uint16_t LedDimmer::shape(uint16_t levelQ16) const {
+  return curve_ == Curve::Cie ? toLinear(levelQ16) : levelQ16;
+}
+
+uint32_t LedDimmer::nextDuty(uint16_t levelQ16) {
+  if (levelQ16 == 0) {
+    carry_ = 0;
+    return 0;
+  }
+  const uint32_t linear = (static_cast<uint32_t>(shape(levelQ16)) * (ceilingQ16_ + 1u)) >> 16;
+  const uint32_t total = linear + carry_;
+  const uint32_t duty = total >> kDitherBits;
+  if (duty > kMaxDuty) {
+    carry_ = 0;
+    return kMaxDuty;
+  }
+  carry_ = total - (duty << kDitherBits);
+  return duty;
+}
+
+uint32_t LedDimmer::dutyFor(uint16_t levelQ16) const {
+  if (levelQ16 == 0) {
+    return 0;
+  }
+  const uint32_t linear = (static_cast<uint32_t>(shape(levelQ16)) * (ceilingQ16_ + 1u)) >> 16;
+  const uint32_t duty = (linear + (1u << (kDitherBits - 1))) >> kDitherBits;
+  return duty > kMaxDuty ? kMaxDuty : duty;
+}
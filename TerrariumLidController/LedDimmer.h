@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Perceptual LED dimming. A perceived level (Q16, 0..65535) goes through
+// the CIE 1931 lightness curve (a constexpr table with linear
+// interpolation) to linear light, or passes straight through for the
+// Linear curve. It is then scaled by a ceiling and spread
+// over kDutyBits of LEDC duty with first-order temporal dithering: the
+// kDitherBits below the duty LSB are carried from one light-task frame to
+// the next, so slow fades have no visible steps even near black.
+class LedDimmer {
+ public:
+  static constexpr uint8_t kDutyBits = 14;
+  static constexpr uint32_t kMaxDuty = (1u << kDutyBits) - 1;
+  static constexpr uint8_t kDitherBits = 16 - kDutyBits;
+
+  enum class Curve : uint8_t {
+    Cie = 0,     // perceived brightness (white and coloured strings)
+    Linear = 1,  // radiant output (UV, where dose matters, not looks)
+  };
+
+  // ceilingQ16 caps the linear output (65535 = full duty).
+  explicit LedDimmer(uint16_t ceilingQ16 = 65535, Curve curve = Curve::Cie);
+
+  void setCeiling(uint16_t ceilingQ16);
+  void setCurve(Curve curve);
+  Curve getCurve() const;
+  // Linear light (Q16) for a perceived level; no dithering.
+  static uint16_t toLinear(uint16_t levelQ16);
+  // toLinear() or the identity, per the dimmer's curve.
+  uint16_t shape(uint16_t levelQ16) const;
+  // Duty for this frame. Level 0 gives duty 0 and clears the carry.
+  uint32_t nextDuty(uint16_t levelQ16);
+  // Rounded duty for a level, without dithering (hardware fade targets).
+  uint32_t dutyFor(uint16_t levelQ16) const;
+
+ private:
+  uint16_t ceilingQ16_;
+  Curve curve_;
+  uint32_t carry_;
+};
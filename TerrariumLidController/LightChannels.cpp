@@ -0,0 +1,145 @@
+#include "LightChannels.h"
+
+LightChannels::LightChannels()
+    : configs_{},
+      count_(0),
+      tuning_{0, 0, 0, 0},
+      knobLow_{},
+      knobHigh_{},
+      allowed_{},
+      gateQ16_{},
+      ramping_{},
+      levels_{},
+      duties_{},
+      fadeKnobQ16_{},
+      knobQ16_(0),
+      forceOn_(false) {}
+
+size_t LightChannels::begin(const Config* configs, size_t count, const Tuning& tuning, uint32_t freqHz,
+                            uint8_t bits) {
+  count_ = count > kMaxChannels ? kMaxChannels : count;
+  tuning_ = tuning;
+  for (size_t i = 0; i < count_; ++i) {
+    const Config& cfg = configs[i];
+    configs_[i] = cfg;
+    dimmers_[i] = LedDimmer(cfg.ceilingQ16, cfg.curve);
+    outputs_[i] = PwmOutput(cfg.pin, cfg.ledcChannel);
+    outputs_[i].begin(freqHz, bits);
+    schedules_[i].begin(cfg.defaults, cfg.defaultCount, cfg.scheduleNamespace);
+    knobLow_[i] = cfg.knobLowQ16;
+    knobHigh_[i] = cfg.knobHighQ16;
+    duties_[i] = 0;
+  }
+  return count_;
+}
+
+uint16_t LightChannels::levelFor(uint32_t low, uint32_t high, uint32_t knobQ16, uint32_t gateQ16) {
+  // Both products stay below 2^32: 65535 * 65536 at most.
+  const uint32_t mapped = (low * (65536U - knobQ16) + high * knobQ16) >> 16;
+  const uint32_t level = (mapped * gateQ16) >> 16;
+  return static_cast<uint16_t>(level > 65535U ? 65535U : level);
+}
+
+void LightChannels::updateSchedules(uint32_t nowUnix, unsigned long nowMs, bool forceOn) {
+  forceOn_ = forceOn;
+  for (size_t i = 0; i < count_; ++i) {
+    LightSchedule::State state = schedules_[i].evaluate(nowUnix);
+    allowed_[i] = state.active;
+    gateQ16_[i] = state.active ? state.levelQ16 : 0;
+    ramping_[i] = state.active && schedules_[i].isRamping();
+    planFade(i, nowUnix, nowMs);
+  }
+}
+
+// While a channel's schedule ramps, each fade runs from the current duty to
+// the duty the ramp reaches at the end of the chunk (or of the segment).
+void LightChannels::planFade(size_t index, uint32_t nowUnix, unsigned long nowMs) {
+  PwmOutput& out = outputs_[index];
+  if (!PwmOutput::kHardwareFade || forceOn_ || !ramping_[index] || knobQ16_ < tuning_.deadzoneQ16) {
+    return;
+  }
+  if (out.fadeRemainingMs(nowMs) > tuning_.fadeLeadMs) {
+    return;
+  }
+  LightSchedule& sched = schedules_[index];
+  const LightSchedule::Span span = sched.getSpan();
+  uint32_t untilUnix = nowUnix + tuning_.fadeChunkS;
+  if (untilUnix > span.segmentEndUnix) {
+    untilUnix = span.segmentEndUnix;
+  }
+  if (untilUnix <= nowUnix) {
+    return;
+  }
+  const uint16_t level = levelFor(knobLow_[index], knobHigh_[index], knobQ16_, sched.levelQ16At(untilUnix));
+  if (out.fade(dimmers_[index].dutyFor(level), (untilUnix - nowUnix) * 1000UL, nowMs)) {
+    fadeKnobQ16_[index] = knobQ16_;
+  }
+}
+
+void LightChannels::update(uint32_t knobQ16, bool forceOn, unsigned long nowMs) {
+  knobQ16_ = knobQ16 > 65535U ? 65535U : knobQ16;
+  forceOn_ = forceOn;
+
+  // Level pass: the same integer math for every channel, no branches.
+  const uint32_t knob = knobQ16_;
+  const uint16_t onMask = knob >= tuning_.deadzoneQ16 ? 0xFFFF : 0;
+  for (size_t i = 0; i < count_; ++i) {
+    const uint32_t gate = forceOn ? 65536U : gateQ16_[i];
+    levels_[i] = levelFor(knobLow_[i], knobHigh_[i], knob, gate) & onMask;
+  }
+
+  // Duty pass: a channel the fade engine is ramping is left alone unless
+  // the knob or an override moved its target; otherwise only changed
+  // duties are written.
+  for (size_t i = 0; i < count_; ++i) {
+    PwmOutput& out = outputs_[i];
+    const bool fading = out.isFading(nowMs);
+    const uint32_t knobDelta = knob > fadeKnobQ16_[i] ? knob - fadeKnobQ16_[i] : fadeKnobQ16_[i] - knob;
+    if (fading && ramping_[i] && !forceOn && knobDelta <= tuning_.fadeKnobToleranceQ16) {
+      duties_[i] = out.getDuty(nowMs);
+      continue;
+    }
+    const uint32_t duty = dimmers_[i].nextDuty(levels_[i]);
+    if (duty != duties_[i] || fading) {
+      out.write(duty);
+    }
+    duties_[i] = duty;
+  }
+}
+
+void LightChannels::writeAll(uint32_t duty) {
+  for (size_t i = 0; i < count_; ++i) {
+    outputs_[i].write(duty);
+    duties_[i] = duty;
+  }
+}
+
+size_t LightChannels::getCount() const {
+  return count_;
+}
+
+const LightChannels::Config& LightChannels::getConfig(size_t index) const {
+  return configs_[index];
+}
+
+LightSchedule& LightChannels::schedule(size_t index) {
+  return schedules_[index];
+}
+
+const LedDimmer& LightChannels::dimmer(size_t index) const {
+  return dimmers_[index];
+}
+
+const PwmOutput& LightChannels::output(size_t index) const {
+  return outputs_[index];
+}
+
+LightChannels::ChannelState LightChannels::getState(size_t index, unsigned long nowMs) const {
+  ChannelState st{};
+  st.allowed = allowed_[index];
+  st.gateQ16 = gateQ16_[index];
+  st.levelQ16 = levels_[index];
+  st.duty = duties_[index];
+  st.fading = outputs_[index].isFading(nowMs);
+  return st;
+}
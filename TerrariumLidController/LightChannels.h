@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Arduino.h>
+#include "LedDimmer.h"
+#include "LightSchedule.h"
+#include "PwmOutput.h"
+
+// Up to kMaxChannels independent LED strings (e.g. white, red, UV), each on
+// its own LEDC channel with its own schedule, ceiling, curve and mapping
+// from the shared knob. The light task computes every channel's level in
+// one pass over flat arrays and writes only the outputs whose duty
+// changed. The RTC task evaluates the schedules and keeps each channel's
+// hardware fade one chunk ahead while its schedule ramps.
+class LightChannels {
+ public:
+  static constexpr size_t kMaxChannels = 4;
+
+  struct Config {
+    const char* name;
+    uint8_t pin;
+    uint8_t ledcChannel;
+    uint16_t ceilingQ16;  // linear output cap (65535 = full duty)
+    LedDimmer::Curve curve;
+    uint16_t knobLowQ16;   // level with the knob at the bottom
+    uint16_t knobHighQ16;  // level with the knob at the top
+    const char* scheduleNamespace;  // NVS namespace of the channel's schedule
+    const LightSchedule::Segment* defaults;
+    size_t defaultCount;
+  };
+
+  struct Tuning {
+    uint16_t deadzoneQ16;           // knob below this switches every channel off
+    uint32_t fadeChunkS;            // length of one hardware fade
+    unsigned long fadeLeadMs;       // start the next chunk this close to the end
+    uint16_t fadeKnobToleranceQ16;  // knob movement that cancels a fade
+  };
+
+  struct ChannelState {
+    bool allowed;       // the channel's schedule is on (forceOn aside)
+    uint32_t gateQ16;   // schedule level, 0..65536
+    uint16_t levelQ16;  // perceived level after knob mapping and gate
+    uint32_t duty;
+    bool fading;
+  };
+
+  LightChannels();
+
+  // Attaches the outputs (all at duty 0) and loads the schedules. Returns
+  // the number of channels in use.
+  size_t begin(const Config* configs, size_t count, const Tuning& tuning, uint32_t freqHz, uint8_t bits);
+  // 1 Hz: evaluates the schedules and plans hardware fades.
+  void updateSchedules(uint32_t nowUnix, unsigned long nowMs, bool forceOn);
+  // Every light-task frame.
+  void update(uint32_t knobQ16, bool forceOn, unsigned long nowMs);
+  // Sets every output to one duty (LED test, fail-safe, factory test).
+  void writeAll(uint32_t duty);
+
+  size_t getCount() const;
+  const Config& getConfig(size_t index) const;
+  LightSchedule& schedule(size_t index);
+  const LedDimmer& dimmer(size_t index) const;
+  const PwmOutput& output(size_t index) const;
+  ChannelState getState(size_t index, unsigned long nowMs) const;
+
+  // Knob mapping and gate for one channel; branch-free so the per-frame
+  // loop over all channels stays a straight run of integer math.
+  static uint16_t levelFor(uint32_t low, uint32_t high, uint32_t knobQ16, uint32_t gateQ16);
+
+ private:
+  void planFade(size_t index, uint32_t nowUnix, unsigned long nowMs);
+
+  Config configs_[kMaxChannels];
+  size_t count_;
+  Tuning tuning_;
+  LightSchedule schedules_[kMaxChannels];
+  LedDimmer dimmers_[kMaxChannels];
+  PwmOutput outputs_[kMaxChannels];
+
+  // Per-channel working state, one array per field.
+  uint32_t knobLow_[kMaxChannels];
+  uint32_t knobHigh_[kMaxChannels];
+  bool allowed_[kMaxChannels];
+  uint32_t gateQ16_[kMaxChannels];  // 0 while the schedule is off
+  bool ramping_[kMaxChannels];
+  uint16_t levels_[kMaxChannels];
+  uint32_t duties_[kMaxChannels];
+  uint32_t fadeKnobQ16_[kMaxChannels];
+
+  uint32_t knobQ16_;
+  bool forceOn_;
+};
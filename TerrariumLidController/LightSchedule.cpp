@@ -0,0 +1,281 @@
+#include "LightSchedule.h"
+
+namespace {
+constexpr uint32_t kSecondsPerDay = 86400UL;
+constexpr uint32_t kHorizonDays = 8;
+constexpr int kMaxOnOffSteps = 64;
+}
+
+LightSchedule::LightSchedule()
+    : segments_{},
+      count_(0),
+      daySegments_{},
+      dayCount_(0),
+      useDaySegments_(false),
+      namespace_("sched"),
+      span_{0, 0, -1, 0, 0},
+      spanValid_(false),
+      fromLevel_(0),
+      deltaLevel_(0),
+      durationS_(1),
+      prefsOpened_(false),
+      stored_(false),
+      evaluations_(0),
+      recomputes_(0) {}
+
+void LightSchedule::begin(const Segment* defaults, size_t count, const char* nvsNamespace) {
+  namespace_ = nvsNamespace;
+  prefsOpened_ = prefs_.begin(namespace_, false);
+  bool loaded = false;
+  if (prefsOpened_ && prefs_.getUChar("ver", 0) == kStoreVersion) {
+    const size_t len = prefs_.getBytesLength("segs");
+    if (len % sizeof(Segment) == 0 && len <= sizeof(segments_)) {
+      Segment stored[kMaxSegments];
+      const size_t n = len > 0 ? prefs_.getBytes("segs", stored, len) / sizeof(Segment) : 0;
+      loaded = true;
+      for (size_t i = 0; i < n; ++i) {
+        if (!isValid(stored[i])) {
+          loaded = false;
+          break;
+        }
+      }
+      if (loaded) {
+        memcpy(segments_, stored, n * sizeof(Segment));
+        count_ = n;
+        sortSegments(segments_, count_);
+      }
+    }
+  }
+  stored_ = loaded;
+  if (!loaded) {
+    count_ = copyValid(segments_, kMaxSegments, defaults, count);
+  }
+  invalidate();
+}
+
+LightSchedule::State LightSchedule::evaluate(uint32_t unixTime) {
+  evaluations_++;
+  if (!spanValid_ || unixTime < span_.fromUnix || unixTime >= span_.untilUnix) {
+    computeSpan(unixTime, span_);
+    spanValid_ = true;
+    recomputes_++;
+    if (span_.segment >= 0) {
+      const Segment& seg = activeSegments()[span_.segment];
+      fromLevel_ = seg.fromLevel;
+      deltaLevel_ = static_cast<int32_t>(seg.toLevel) - seg.fromLevel;
+      durationS_ = span_.segmentEndUnix - span_.segmentStartUnix;
+    }
+  }
+  if (span_.segment < 0) {
+    return State{false, 0, -1};
+  }
+  return State{true, levelQ16At(unixTime), span_.segment};
+}
+
+uint32_t LightSchedule::levelQ16At(uint32_t unixTime) const {
+  if (!spanValid_ || span_.segment < 0) {
+    return 0;
+  }
+  if (deltaLevel_ == 0) {
+    return static_cast<uint32_t>(fromLevel_) * kLevelOneQ16 / 1000U;
+  }
+  if (unixTime > span_.segmentEndUnix) unixTime = span_.segmentEndUnix;
+  if (unixTime < span_.segmentStartUnix) unixTime = span_.segmentStartUnix;
+  // Permille-seconds fit 32 bits (1000 * 86400); the Q16 scale needs 64.
+  const int32_t elapsed = static_cast<int32_t>(unixTime - span_.segmentStartUnix);
+  const int64_t num = static_cast<int64_t>(fromLevel_ * static_cast<int32_t>(durationS_) + deltaLevel_ * elapsed) *
+                      kLevelOneQ16;
+  return static_cast<uint32_t>(num / (1000LL * durationS_));
+}
+
+bool LightSchedule::isRamping() const {
+  return spanValid_ && span_.segment >= 0 && deltaLevel_ != 0;
+}
+
+uint32_t LightSchedule::nextOnOffChange(uint32_t unixTime) const {
+  Span span;
+  computeSpan(unixTime, span);
+  const bool active = span.segment >= 0;
+  const uint32_t horizon = unixTime + kHorizonDays * kSecondsPerDay;
+  for (int i = 0; i < kMaxOnOffSteps && span.untilUnix <= horizon; ++i) {
+    const uint32_t at = span.untilUnix;
+    computeSpan(at, span);
+    if ((span.segment >= 0) != active) {
+      return at;
+    }
+  }
+  return 0;
+}
+
+size_t LightSchedule::getSegmentCount() const {
+  return activeCount();
+}
+
+const LightSchedule::Segment& LightSchedule::getSegment(size_t index) const {
+  return activeSegments()[index];
+}
+
+bool LightSchedule::addSegment(const Segment& segment) {
+  if (count_ >= kMaxSegments || !isValid(segment)) {
+    return false;
+  }
+  segments_[count_++] = segment;
+  sortSegments(segments_, count_);
+  save();
+  invalidate();
+  return true;
+}
+
+bool LightSchedule::removeSegment(size_t index) {
+  if (index >= count_) {
+    return false;
+  }
+  for (size_t i = index + 1; i < count_; ++i) {
+    segments_[i - 1] = segments_[i];
+  }
+  count_--;
+  save();
+  invalidate();
+  return true;
+}
+
+void LightSchedule::setSegments(const Segment* segments, size_t count) {
+  count_ = copyValid(segments_, kMaxSegments, segments, count);
+  save();
+  invalidate();
+}
+
+void LightSchedule::setDaySegments(const Segment* segments, size_t count) {
+  dayCount_ = copyValid(daySegments_, kMaxDaySegments, segments, count);
+  useDaySegments_ = true;
+  invalidate();
+}
+
+void LightSchedule::clearDaySegments() {
+  if (!useDaySegments_) {
+    return;
+  }
+  useDaySegments_ = false;
+  dayCount_ = 0;
+  invalidate();
+}
+
+bool LightSchedule::hasDaySegments() const {
+  return useDaySegments_;
+}
+
+LightSchedule::Span LightSchedule::getSpan() const {
+  return span_;
+}
+
+LightSchedule::Status LightSchedule::getStatus() const {
+  return Status{activeCount(), evaluations_, recomputes_, stored_};
+}
+
+uint8_t LightSchedule::weekdayOf(uint32_t unixTime) {
+  // 1970-01-01 was a Thursday.
+  return static_cast<uint8_t>((unixTime / kSecondsPerDay + 4) % 7);
+}
+
+bool LightSchedule::isValid(const Segment& segment) {
+  return (segment.days & kAllDays) != 0 && segment.startMin < 1440 && segment.durationMin >= 1 &&
+         segment.durationMin <= 1440 && segment.fromLevel <= 1000 && segment.toLevel <= 1000;
+}
+
+size_t LightSchedule::copyValid(Segment* out, size_t max, const Segment* segments, size_t count) {
+  size_t n = 0;
+  for (size_t i = 0; i < count && n < max; ++i) {
+    if (isValid(segments[i])) {
+      out[n++] = segments[i];
+    }
+  }
+  sortSegments(out, n);
+  return n;
+}
+
+const LightSchedule::Segment* LightSchedule::activeSegments() const {
+  return useDaySegments_ ? daySegments_ : segments_;
+}
+
+size_t LightSchedule::activeCount() const {
+  return useDaySegments_ ? dayCount_ : count_;
+}
+
+// Finds the segment occurrence covering unixTime and the nearest boundary
+// after it. Occurrences run from the day before (for segments that wrap
+// midnight) up to kHorizonDays ahead (for sparse weekday masks).
+void LightSchedule::computeSpan(uint32_t unixTime, Span& span) const {
+  const uint32_t dayStart = unixTime - unixTime % kSecondsPerDay;
+  span.fromUnix = unixTime;
+  span.untilUnix = dayStart + kSecondsPerDay;
+  span.segment = -1;
+  span.segmentStartUnix = 0;
+  span.segmentEndUnix = 0;
+
+  const Segment* segments = activeSegments();
+  bool haveBoundary = false;
+  for (size_t i = 0; i < activeCount(); ++i) {
+    const Segment& seg = segments[i];
+    for (uint32_t d = 0; d <= kHorizonDays + 1; ++d) {
+      if (d == 0 && dayStart < kSecondsPerDay) {
+        continue;
+      }
+      const uint32_t day = dayStart + d * kSecondsPerDay - kSecondsPerDay;
+      if ((seg.days & (1u << weekdayOf(day))) == 0) {
+        continue;
+      }
+      const uint32_t start = day + seg.startMin * 60UL;
+      const uint32_t end = start + seg.durationMin * 60UL;
+      if (start > unixTime) {
+        if (!haveBoundary || start < span.untilUnix) {
+          span.untilUnix = start;
+          haveBoundary = true;
+        }
+        break;  // later days of this segment are further out
+      }
+      if (end > unixTime) {
+        if (span.segment < 0) {
+          span.segment = static_cast<int>(i);
+          span.segmentStartUnix = start;
+          span.segmentEndUnix = end;
+        }
+        if (!haveBoundary || end < span.untilUnix) {
+          span.untilUnix = end;
+          haveBoundary = true;
+        }
+      }
+    }
+  }
+}
+
+void LightSchedule::sortSegments(Segment* segments, size_t count) {
+  for (size_t i = 1; i < count; ++i) {
+    const Segment seg = segments[i];
+    size_t j = i;
+    while (j > 0 && segments[j - 1].startMin > seg.startMin) {
+      segments[j] = segments[j - 1];
+      --j;
+    }
+    segments[j] = seg;
+  }
+}
+
+void LightSchedule::invalidate() {
+  spanValid_ = false;
+}
+
+void LightSchedule::save() {
+  if (!prefsOpened_) {
+    prefsOpened_ = prefs_.begin(namespace_, false);
+  }
+  if (!prefsOpened_) {
+    return;
+  }
+  prefs_.putUChar("ver", kStoreVersion);
+  if (count_ > 0) {
+    prefs_.putBytes("segs", segments_, count_ * sizeof(Segment));
+  } else {
+    prefs_.remove("segs");
+  }
+  stored_ = true;
+}
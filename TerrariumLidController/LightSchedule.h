@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Table-driven lighting schedule. Each segment is a linear brightness ramp
+// (fromLevel -> toLevel, in permille of the pot setting) that starts at a
+// minute of the day on the weekdays in its mask and may run past midnight.
+// Outside every segment the light is off; where segments overlap the one
+// listed first (earliest start) wins. A generated day table (solar mode)
+// can temporarily stand in for the stored one.
+//
+// evaluate() caches the span between two transitions, so until the next
+// segment boundary it costs a range check plus, on a ramp, one lerp.
+// Levels are Q16 fractions (kLevelOneQ16 = 100%), rounded down exactly.
+class LightSchedule {
+ public:
+  struct Segment {
+    uint8_t days;          // bit 0 = Sunday ... bit 6 = Saturday
+    uint16_t startMin;     // minute of the day, 0..1439
+    uint16_t durationMin;  // 1..1440
+    uint16_t fromLevel;    // permille
+    uint16_t toLevel;      // permille
+  };
+
+  struct State {
+    bool active;
+    uint32_t levelQ16;  // 0..kLevelOneQ16
+    int segment;        // -1 when off
+  };
+
+  // The span evaluate() is currently serving: [fromUnix, untilUnix).
+  struct Span {
+    uint32_t fromUnix;
+    uint32_t untilUnix;
+    int segment;
+    uint32_t segmentStartUnix;
+    uint32_t segmentEndUnix;
+  };
+
+  struct Status {
+    size_t segments;
+    unsigned long evaluations;
+    unsigned long recomputes;
+    bool stored;
+  };
+
+  static constexpr size_t kMaxSegments = 16;
+  static constexpr size_t kMaxDaySegments = 4;
+  static constexpr uint8_t kAllDays = 0x7F;
+  static constexpr uint32_t kLevelOneQ16 = 65536;
+
+  LightSchedule();
+
+  // Loads the table from NVS, or installs the given defaults if none is
+  // stored. Each schedule needs its own namespace (the string must
+  // outlive the schedule).
+  void begin(const Segment* defaults, size_t count, const char* nvsNamespace = "sched");
+  State evaluate(uint32_t unixTime);
+  // Level of the cached segment at unixTime (clamped to the segment), so
+  // callers can look ahead along the ramp evaluate() is serving.
+  uint32_t levelQ16At(uint32_t unixTime) const;
+  // True while evaluate() is serving a segment whose level changes.
+  bool isRamping() const;
+  // Next time (after unixTime) the light goes from on to off or back.
+  // Returns 0 if it never changes within a week.
+  uint32_t nextOnOffChange(uint32_t unixTime) const;
+
+  // The table in effect: the day table if one is set, else the stored one.
+  size_t getSegmentCount() const;
+  const Segment& getSegment(size_t index) const;
+  // Table edits are saved to NVS and drop the cached span. Returns false
+  // if the table is full, the index is out of range or the segment is
+  // malformed.
+  bool addSegment(const Segment& segment);
+  bool removeSegment(size_t index);
+  void setSegments(const Segment* segments, size_t count);
+  // Replaces the stored table (not saved) until clearDaySegments().
+  void setDaySegments(const Segment* segments, size_t count);
+  void clearDaySegments();
+  bool hasDaySegments() const;
+  Span getSpan() const;
+  Status getStatus() const;
+
+  static uint8_t weekdayOf(uint32_t unixTime);
+
+ private:
+  static constexpr uint8_t kStoreVersion = 1;
+
+  static bool isValid(const Segment& segment);
+  static size_t copyValid(Segment* out, size_t max, const Segment* segments, size_t count);
+  static void sortSegments(Segment* segments, size_t count);
+  const Segment* activeSegments() const;
+  size_t activeCount() const;
+  void computeSpan(uint32_t unixTime, Span& span) const;
+  void invalidate();
+  void save();
+
+  Segment segments_[kMaxSegments];
+  size_t count_;
+  Segment daySegments_[kMaxDaySegments];
+  size_t dayCount_;
+  bool useDaySegments_;
+  const char* namespace_;
+  Span span_;
+  bool spanValid_;
+  // Ramp of the cached segment, in permille and seconds.
+  int32_t fromLevel_;
+  int32_t deltaLevel_;
+  uint32_t durationS_;
+  Preferences prefs_;
+  bool prefsOpened_;
+  bool stored_;
+  unsigned long evaluations_;
+  unsigned long recomputes_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+// Stage markers for the main control loop. Firmware builds compile them
+// out; the host benchmark (host/bench) defines TLC_LOOP_PROFILE=1 and
+// supplies loopProfileBegin()/loopProfileEnd() to time each stage.
+
+enum class LoopStage : uint8_t {
+  Console = 0,
+  PotRead,
+  RtcGating,
+  Sht3xUpdate,
+  DisplayUpdate,
+  PwmWrite,
+  UiState,
+  Count,
+};
+
+#ifndef TLC_LOOP_PROFILE
+#define TLC_LOOP_PROFILE 0
+#endif
+
+#if TLC_LOOP_PROFILE
+// Starts timing a stage; implicitly ends the one in progress.
+void loopProfileBegin(LoopStage stage);
+void loopProfileEnd();
+#define TLC_PROFILE_STAGE(stage) loopProfileBegin(LoopStage::stage)
+#define TLC_PROFILE_END() loopProfileEnd()
+#else
+#define TLC_PROFILE_STAGE(stage) \
+  do {                           \
+  } while (0)
+#define TLC_PROFILE_END() \
+  do {                    \
+  } while (0)
+#endif
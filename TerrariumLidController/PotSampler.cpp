@@ -0,0 +1,172 @@
+#include "PotSampler.h"
+
+static_assert(PotSampler::kBlockSize % 2 == 1, "median block must be odd");
+static_assert(static_cast<uint64_t>(PotSampler::kMaxDepth) * PotSampler::kMaxCounts * 65535ULL <= 0xFFFFFFFFULL,
+              "getLevelQ16() math must fit in 32 bits");
+
+namespace {
+// Driver pool: ~70 ms of samples at 3.6 kHz, so a late light-task frame
+// loses nothing. Frames are what the DMA hands over at once.
+constexpr uint32_t kPoolBytes = 1024;
+constexpr uint32_t kFrameBytes = 4 * PotSampler::kBlockSize * 4;
+}  // namespace
+
+PotSampler::PotSampler()
+    : pin_(0),
+      sampleRateHz_(0),
+      depth_(1),
+      continuous_(false),
+#if TLC_ADC_CONTINUOUS
+      handle_(nullptr),
+      channel_(0),
+      readBuf_{},
+#endif
+      block_{},
+      blockFill_(0),
+      medians_{},
+      medianHead_(0),
+      medianFill_(0),
+      medianSum_(0),
+      samples_(0),
+      medianCount_(0),
+      lastSample_(0),
+      blockSpread_(0) {}
+
+bool PotSampler::begin(uint8_t pin, uint32_t sampleRateHz, uint8_t depth) {
+  pin_ = pin;
+  sampleRateHz_ = sampleRateHz;
+  setDepth(depth);
+  continuous_ = false;
+#if TLC_ADC_CONTINUOUS
+  adc_unit_t unit;
+  adc_channel_t channel;
+  if (adc_continuous_io_to_channel(pin, &unit, &channel) != ESP_OK || unit != ADC_UNIT_1) {
+    return false;
+  }
+  channel_ = static_cast<uint8_t>(channel);
+  adc_continuous_handle_cfg_t handleCfg{};
+  handleCfg.max_store_buf_size = kPoolBytes;
+  handleCfg.conv_frame_size = kFrameBytes;
+  if (adc_continuous_new_handle(&handleCfg, &handle_) != ESP_OK) {
+    handle_ = nullptr;
+    return false;
+  }
+  adc_digi_pattern_config_t pattern{};
+  pattern.atten = ADC_ATTEN_DB_12;
+  pattern.channel = channel_;
+  pattern.unit = ADC_UNIT_1;
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+  adc_continuous_config_t cfg{};
+  cfg.pattern_num = 1;
+  cfg.adc_pattern = &pattern;
+  cfg.sample_freq_hz = sampleRateHz;
+  cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+  if (adc_continuous_config(handle_, &cfg) != ESP_OK || adc_continuous_start(handle_) != ESP_OK) {
+    adc_continuous_deinit(handle_);
+    handle_ = nullptr;
+    return false;
+  }
+  continuous_ = true;
+#endif
+  return continuous_;
+}
+
+void PotSampler::setDepth(uint8_t depth) {
+  if (depth < 1) depth = 1;
+  if (depth > kMaxDepth) depth = kMaxDepth;
+  depth_ = depth;
+  // Restart the mean; the first update() refills it.
+  medianFill_ = 0;
+  medianSum_ = 0;
+}
+
+void PotSampler::update() {
+#if TLC_ADC_CONTINUOUS
+  if (continuous_) {
+    uint32_t bytes = 0;
+    while (adc_continuous_read(handle_, readBuf_, sizeof(readBuf_), &bytes, 0) == ESP_OK && bytes > 0) {
+      for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= bytes; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* out = reinterpret_cast<const adc_digi_output_data_t*>(readBuf_ + i);
+        if (out->type2.channel == channel_) {
+          push(static_cast<uint16_t>(out->type2.data));
+        }
+      }
+      if (bytes < sizeof(readBuf_)) {
+        break;
+      }
+    }
+    return;
+  }
+#endif
+  burstRead();
+}
+
+void PotSampler::burstRead() {
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    push(static_cast<uint16_t>(analogRead(pin_)));
+  }
+}
+
+void PotSampler::push(uint16_t sample) {
+  samples_++;
+  lastSample_ = sample;
+  block_[blockFill_++] = sample;
+  if (blockFill_ < kBlockSize) {
+    return;
+  }
+  blockFill_ = 0;
+  // Insertion sort; nine elements is cheaper than any selection scheme.
+  for (size_t i = 1; i < kBlockSize; ++i) {
+    const uint16_t v = block_[i];
+    size_t j = i;
+    while (j > 0 && block_[j - 1] > v) {
+      block_[j] = block_[j - 1];
+      --j;
+    }
+    block_[j] = v;
+  }
+  blockSpread_ = static_cast<uint16_t>(block_[kBlockSize - 1] - block_[0]);
+  pushMedian(block_[kBlockSize / 2]);
+}
+
+void PotSampler::pushMedian(uint16_t median) {
+  medianCount_++;
+  if (medianFill_ == 0) {
+    // First median after begin() or a depth change: start level, not ramp.
+    for (size_t i = 0; i < depth_; ++i) {
+      medians_[(medianHead_ + kMaxDepth - i) % kMaxDepth] = median;
+    }
+    medianSum_ = static_cast<uint32_t>(median) * depth_;
+    medianFill_ = depth_;
+  }
+  medianHead_ = (medianHead_ + 1) % kMaxDepth;
+  const size_t oldest = (medianHead_ + kMaxDepth - depth_) % kMaxDepth;
+  medianSum_ = medianSum_ - medians_[oldest] + median;
+  medians_[medianHead_] = median;
+}
+
+uint16_t PotSampler::getLevelQ16() const {
+  if (medianFill_ == 0) {
+    return 0;
+  }
+  return static_cast<uint16_t>((medianSum_ * 65535U) / (static_cast<uint32_t>(kMaxCounts) * depth_));
+}
+
+uint16_t PotSampler::getCounts() const {
+  if (medianFill_ == 0) {
+    return 0;
+  }
+  return static_cast<uint16_t>((medianSum_ + depth_ / 2) / depth_);
+}
+
+unsigned long PotSampler::getLatencyUs() const {
+  if (!continuous_ || sampleRateHz_ == 0) {
+    return 0;
+  }
+  return static_cast<unsigned long>(static_cast<uint64_t>(kBlockSize) * depth_ * 1000000ULL / (2ULL * sampleRateHz_));
+}
+
+PotSampler::Status PotSampler::getStatus() const {
+  return Status{continuous_, sampleRateHz_, depth_, samples_, medianCount_, lastSample_, blockSpread_};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+  #define TLC_ADC_CONTINUOUS 1
+  #include "esp_adc/adc_continuous.h"
+#else
+  #define TLC_ADC_CONTINUOUS 0
+#endif
+
+// Potentiometer front end. The ADC runs in continuous (DMA) mode at a fixed
+// rate; each update() drains whatever the driver's ring buffer collected
+// since the last call. Every kBlockSize samples are reduced to their median
+// (rejects ADC spikes), and the output is the mean of the last `depth`
+// medians, so depth sets the latency/steadiness trade-off:
+//   latency ~= kBlockSize * depth / (2 * sampleRateHz)
+// All integer math. Without the continuous driver (Arduino-ESP32 2.x, or
+// if it fails to start) each update() takes one burst of kBlockSize
+// analogRead() conversions instead.
+class PotSampler {
+ public:
+  static constexpr size_t kBlockSize = 9;  // samples per median (odd)
+  static constexpr uint8_t kMaxDepth = 16;
+  static constexpr uint16_t kMaxCounts = 4095;
+
+  struct Status {
+    bool continuous;
+    uint32_t sampleRateHz;
+    uint8_t depth;
+    unsigned long samples;
+    unsigned long medians;
+    uint16_t lastSample;
+    uint16_t blockSpread;  // max - min of the last block (noise)
+  };
+
+  PotSampler();
+
+  // Falls back to analogRead() bursts if continuous mode cannot start.
+  bool begin(uint8_t pin, uint32_t sampleRateHz, uint8_t depth);
+  void update();
+  void setDepth(uint8_t depth);
+
+  // Filtered position, 0..65535.
+  uint16_t getLevelQ16() const;
+  // Filtered position in ADC counts, 0..4095.
+  uint16_t getCounts() const;
+  unsigned long getLatencyUs() const;
+  Status getStatus() const;
+
+ private:
+  static constexpr size_t kReadSamples = 64;  // per driver read
+
+  void push(uint16_t sample);
+  void pushMedian(uint16_t median);
+  void burstRead();
+
+  uint8_t pin_;
+  uint32_t sampleRateHz_;
+  uint8_t depth_;
+  bool continuous_;
+#if TLC_ADC_CONTINUOUS
+  adc_continuous_handle_t handle_;
+  uint8_t channel_;
+  uint8_t readBuf_[kReadSamples * SOC_ADC_DIGI_RESULT_BYTES];
+#endif
+  uint16_t block_[kBlockSize];
+  size_t blockFill_;
+  uint16_t medians_[kMaxDepth];  // ring of the newest medians
+  size_t medianHead_;
+  size_t medianFill_;
+  uint32_t medianSum_;  // of the newest depth_ medians
+  unsigned long samples_;
+  unsigned long medianCount_;
+  uint16_t lastSample_;
+  uint16_t blockSpread_;
+};
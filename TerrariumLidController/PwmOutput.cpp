@@ -0,0 +1,112 @@
+#include "PwmOutput.h"
+
+#if TLC_LEDC_NEW_API
+#include "driver/ledc.h"
+#endif
+
+PwmOutput::PwmOutput() : PwmOutput(0, 0) {}
+
+PwmOutput::PwmOutput(uint8_t pin, uint8_t channel)
+    : pin_(pin),
+      channel_(channel),
+      freqHz_(0),
+      duty_(0),
+      fadeTarget_(0),
+      fadeStartMs_(0),
+      fadeDurationMs_(0),
+      fading_(false),
+      stats_{0, 0, 0} {}
+
+void PwmOutput::begin(uint32_t freqHz, uint8_t resolutionBits) {
+  freqHz_ = freqHz;
+#if TLC_LEDC_NEW_API
+  ledcAttachChannel(pin_, freqHz, resolutionBits, channel_);
+#else
+  ledcSetup(channel_, freqHz, resolutionBits);
+  ledcAttachPin(pin_, channel_);
+#endif
+  write(0);
+}
+
+void PwmOutput::write(uint32_t duty) {
+#if TLC_LEDC_NEW_API
+  if (fading_) {
+    // Freezes the engine; the write below then sets the new duty.
+    if (isFading(millis())) {
+      stats_.fadeStops++;
+    }
+    ledc_fade_stop(LEDC_LOW_SPEED_MODE, static_cast<ledc_channel_t>(channel_));
+    fading_ = false;
+  }
+  ledcWrite(pin_, duty);
+#else
+  ledcWrite(channel_, duty);
+#endif
+  duty_ = duty;
+  stats_.writes++;
+}
+
+bool PwmOutput::fade(uint32_t targetDuty, uint32_t durationMs, unsigned long nowMs) {
+#if TLC_LEDC_NEW_API
+  const uint32_t startDuty = getDuty(nowMs);
+  const uint32_t steps = targetDuty > startDuty ? targetDuty - startDuty : startDuty - targetDuty;
+  if (steps == 0 || durationMs == 0 || freqHz_ == 0) {
+    return false;
+  }
+  const uint64_t longestMs = static_cast<uint64_t>(steps) * kMaxCyclesPerStep * 1000ULL / freqHz_;
+  if (durationMs > longestMs) {
+    durationMs = static_cast<uint32_t>(longestMs);
+  }
+  if (durationMs == 0) {
+    return false;
+  }
+  if (fading_) {
+    // The driver holds the channel's fade lock until the running fade
+    // ends, so ledcFade() would block for the rest of it; freeze it first.
+    if (isFading(nowMs)) {
+      stats_.fadeStops++;
+    }
+    ledc_fade_stop(LEDC_LOW_SPEED_MODE, static_cast<ledc_channel_t>(channel_));
+    fading_ = false;
+  }
+  duty_ = startDuty;
+  if (!ledcFade(pin_, startDuty, targetDuty, static_cast<int>(durationMs))) {
+    return false;
+  }
+  fadeTarget_ = targetDuty;
+  fadeStartMs_ = nowMs;
+  fadeDurationMs_ = durationMs;
+  fading_ = true;
+  stats_.fades++;
+  return true;
+#else
+  (void)targetDuty;
+  (void)durationMs;
+  (void)nowMs;
+  return false;
+#endif
+}
+
+bool PwmOutput::isFading(unsigned long nowMs) const {
+  return fading_ && (nowMs - fadeStartMs_) < fadeDurationMs_;
+}
+
+unsigned long PwmOutput::fadeRemainingMs(unsigned long nowMs) const {
+  return isFading(nowMs) ? fadeDurationMs_ - (nowMs - fadeStartMs_) : 0;
+}
+
+uint32_t PwmOutput::getDuty(unsigned long nowMs) const {
+  if (!fading_) {
+    return duty_;
+  }
+  const unsigned long elapsed = nowMs - fadeStartMs_;
+  if (elapsed >= fadeDurationMs_) {
+    return fadeTarget_;
+  }
+  const int64_t span = static_cast<int64_t>(fadeTarget_) - duty_;
+  return static_cast<uint32_t>(duty_ + span * static_cast<int64_t>(elapsed) / static_cast<int64_t>(fadeDurationMs_));
+}
+
+PwmOutput::Stats PwmOutput::getStats() const {
+  return stats_;
+}
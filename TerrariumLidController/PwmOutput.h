@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+  #define TLC_LEDC_NEW_API 1
+#else
+  #define TLC_LEDC_NEW_API 0
+#endif
+
+// One LEDC output. Besides plain duty writes it can hand a linear ramp to
+// the LEDC fade engine, which then steps the duty in hardware with no
+// further CPU work; the ramp is tracked in software so getDuty() reports
+// where the hardware is. A write() or a new fade() cancels a running fade.
+//
+// Hardware fades need Arduino-ESP32 3.x (ledcFade); on 2.x fade() returns
+// false and the caller keeps writing duties itself.
+class PwmOutput {
+ public:
+  struct Stats {
+    unsigned long writes;
+    unsigned long fades;
+    unsigned long fadeStops;
+  };
+
+  static constexpr bool kHardwareFade = TLC_LEDC_NEW_API;
+  // The fade engine holds each duty step for at most this many PWM cycles,
+  // which bounds how slowly a small duty change can be spread out.
+  static constexpr uint32_t kMaxCyclesPerStep = 1023;
+
+  PwmOutput();
+  PwmOutput(uint8_t pin, uint8_t channel);
+
+  void begin(uint32_t freqHz, uint8_t resolutionBits);
+  void write(uint32_t duty);
+  // Ramps from the current duty to targetDuty over durationMs (shortened
+  // if the engine cannot step that slowly). Returns false if hardware fades
+  // are unavailable or there is nothing to ramp.
+  bool fade(uint32_t targetDuty, uint32_t durationMs, unsigned long nowMs);
+  bool isFading(unsigned long nowMs) const;
+  unsigned long fadeRemainingMs(unsigned long nowMs) const;
+  // Duty at nowMs, interpolated while a fade runs.
+  uint32_t getDuty(unsigned long nowMs) const;
+  Stats getStats() const;
+
+ private:
+  uint8_t pin_;
+  uint8_t channel_;
+  uint32_t freqHz_;
+  uint32_t duty_;  // last written duty, or the start of the running fade
+  uint32_t fadeTarget_;
+  unsigned long fadeStartMs_;
+  unsigned long fadeDurationMs_;
+  bool fading_;
+  Stats stats_;
+};
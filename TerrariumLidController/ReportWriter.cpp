@@ -0,0 +1,107 @@
+#include "ReportWriter.h"
+
+#include <math.h>
+
+namespace {
+char* putTwoDigits(char* p, int v) {
+  p[0] = static_cast<char>('0' + (v / 10) % 10);
+  p[1] = static_cast<char>('0' + v % 10);
+  return p + 2;
+}
+}
+
+ReportWriter::ReportWriter(Print& out)
+    : out_(out),
+      buffer_{0},
+      length_(0) {}
+
+size_t ReportWriter::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t ReportWriter::write(const uint8_t* buffer, size_t size) {
+  const size_t total = size;
+  while (size > 0) {
+    if (length_ == kCapacity) {
+      flush();
+    }
+    size_t n = kCapacity - length_;
+    if (n > size) n = size;
+    memcpy(buffer_ + length_, buffer, n);
+    length_ += n;
+    buffer += n;
+    size -= n;
+  }
+  return total;
+}
+
+void ReportWriter::flush() {
+  if (length_ == 0) {
+    return;
+  }
+  out_.write(buffer_, length_);
+  length_ = 0;
+}
+
+void printIsoDateTime(Print& out, const DateTime& dt, char separator) {
+  char text[20];
+  char* p = text;
+  const int year = dt.year();
+  p = putTwoDigits(p, year / 100);
+  p = putTwoDigits(p, year % 100);
+  *p++ = '-';
+  p = putTwoDigits(p, dt.month());
+  *p++ = '-';
+  p = putTwoDigits(p, dt.day());
+  *p++ = separator;
+  p = putTwoDigits(p, dt.hour());
+  *p++ = ':';
+  p = putTwoDigits(p, dt.minute());
+  *p++ = ':';
+  p = putTwoDigits(p, dt.second());
+  *p = '\0';
+  out.print(text);
+}
+
+void printFixed(Print& out, float value, uint8_t decimals) {
+  static const uint32_t kScale[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  if (isnan(value)) {
+    out.print("nan");
+    return;
+  }
+  if (decimals > 6) decimals = 6;
+
+  char text[32];
+  char* p = text + sizeof(text);
+  *--p = '\0';
+
+  const bool negative = value < 0.0f;
+  double magnitude = negative ? -static_cast<double>(value) : static_cast<double>(value);
+  if (magnitude > 4.0e12) {
+    out.print(negative ? "-ovf" : "ovf");
+    return;
+  }
+  uint64_t scaled = static_cast<uint64_t>(magnitude * kScale[decimals] + 0.5);
+  const bool showSign = negative && scaled != 0;
+  for (uint8_t i = 0; i < decimals; ++i) {
+    *--p = static_cast<char>('0' + scaled % 10);
+    scaled /= 10;
+  }
+  if (decimals > 0) {
+    *--p = '.';
+  }
+  do {
+    *--p = static_cast<char>('0' + scaled % 10);
+    scaled /= 10;
+  } while (scaled > 0);
+  if (showSign) {
+    *--p = '-';
+  }
+  out.print(p);
+}
+
+void printHexByte(Print& out, uint8_t value) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  char text[5] = {'0', 'x', kDigits[value >> 4], kDigits[value & 0x0F], '\0'};
+  out.print(text);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+#include "RTClib.h"
+
+// Print that collects console output in a fixed static buffer and hands it
+// to the real stream with a single write() on flush() (or when the buffer
+// fills). One instance is shared by every console report, so a whole report
+// costs one trip through the USB CDC stack instead of one per print().
+class ReportWriter : public Print {
+ public:
+  static constexpr size_t kCapacity = 1024;
+
+  explicit ReportWriter(Print& out);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  void flush() override;
+
+ private:
+  Print& out_;
+  uint8_t buffer_[kCapacity];
+  size_t length_;
+};
+
+// Formatting helpers for reports. Each one formats on the stack and issues
+// a single print(), so they are cheap on any Print.
+
+// "YYYY-MM-DD HH:MM:SS" (separator replaces the space, e.g. 'T').
+void printIsoDateTime(Print& out, const DateTime& dt, char separator = ' ');
+// Rounds to `decimals` places (max 6) using integer arithmetic.
+void printFixed(Print& out, float value, uint8_t decimals);
+// "0x3C".
+void printHexByte(Print& out, uint8_t value);
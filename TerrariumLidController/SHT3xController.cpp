@@ -2,13 +2,30 @@
 
 #include <math.h>
 
+namespace {
+uint8_t sensirionCrc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+}
+
 SHT3xController::SHT3xController()
-    : wire_(nullptr),
+    : bus_(nullptr),
+      mode_(Mode::SingleShot),
+      measuring_(false),
+      triggerMs_(0),
       logStream_(nullptr),
+      heaterEventHandler_(nullptr),
       present_(false),
       address_(0),
       lastReading_{false, false, false, 0.0f, 0.0f, DateTime(2000, 1, 1, 0, 0, 0)},
-      diagnostics_{false, 0, false, 0, false, 0, false},
+      diagnostics_{false, 0, false, 0, false, 0, false, Mode::SingleShot, 0, 0, 0},
       history_{},
       historyCount_(0),
       historyIndex_(0),
@@ -31,11 +48,12 @@ SHT3xController::SHT3xController()
       heaterEventIndex_(0),
       pendingEvent_{false, false, DateTime(2000, 1, 1, 0, 0, 0), 0, nullptr, 0.0f, 0.0f} {}
 
-bool SHT3xController::begin(TwoWire& wire, uint8_t primaryAddr, uint8_t fallbackAddr) {
-  wire_ = &wire;
+bool SHT3xController::begin(I2cBus& bus, uint8_t primaryAddr, uint8_t fallbackAddr) {
+  bus_ = &bus;
   present_ = false;
   address_ = 0;
-  diagnostics_ = {false, 0, false, 0, false, 0, false};
+  measuring_ = false;
+  diagnostics_ = {false, 0, false, 0, false, 0, false, mode_, 0, 0, 0};
 
   if (tryBegin(primaryAddr)) {
     address_ = primaryAddr;
@@ -45,6 +63,9 @@ bool SHT3xController::begin(TwoWire& wire, uint8_t primaryAddr, uint8_t fallback
     present_ = true;
   }
 
+  if (!present_) {
+    address_ = 0;
+  }
   diagnostics_.present = present_;
   diagnostics_.address = address_;
   diagnostics_.heaterEnabled = heaterEnabled_;
@@ -73,7 +94,10 @@ bool SHT3xController::begin(TwoWire& wire, uint8_t primaryAddr, uint8_t fallback
   pendingEvent_ = {false, false, DateTime(2000, 1, 1, 0, 0, 0), 0, nullptr, 0.0f, 0.0f};
 
   if (present_) {
-    sensor_.heater(false);
+    setHeater(false);
+    if (mode_ == Mode::Periodic) {
+      sendCommand(kCmdPeriodicArt);
+    }
   }
 
   return present_;
@@ -83,20 +107,118 @@ void SHT3xController::setLogStream(Stream& stream) {
   logStream_ = &stream;
 }
 
+void SHT3xController::setHeaterEventHandler(HeaterEventHandler handler) {
+  heaterEventHandler_ = handler;
+}
+
 bool SHT3xController::tryBegin(uint8_t addr) {
-  (void)wire_;
-  return sensor_.begin(addr);
+  address_ = addr;
+  if (!sendCommand(kCmdSoftReset)) {
+    return false;
+  }
+  delay(2);  // soft reset takes up to 1.5 ms
+
+  // A readable, CRC-valid status word tells an SHT3x from another part.
+  uint8_t status[3];
+  const uint8_t cmd[2] = {static_cast<uint8_t>(kCmdReadStatus >> 8), static_cast<uint8_t>(kCmdReadStatus & 0xFF)};
+  if (!bus_->write(addr, cmd, sizeof(cmd)) || !bus_->read(addr, status, sizeof(status))) {
+    return false;
+  }
+  return sensirionCrc8(status, 2) == status[2];
 }
 
 bool SHT3xController::isPresent() const {
   return present_;
 }
 
+bool SHT3xController::setMode(Mode mode) {
+  if (mode == mode_) {
+    return true;
+  }
+  mode_ = mode;
+  diagnostics_.mode = mode;
+  measuring_ = false;
+  if (!present_) {
+    return true;
+  }
+  if (mode_ == Mode::Periodic) {
+    return sendCommand(kCmdPeriodicArt);
+  }
+  return sendCommand(kCmdBreak);
+}
+
+SHT3xController::Mode SHT3xController::getMode() const {
+  return mode_;
+}
+
+bool SHT3xController::sendCommand(uint16_t cmd) {
+  const uint8_t buf[2] = {static_cast<uint8_t>(cmd >> 8), static_cast<uint8_t>(cmd & 0xFF)};
+  if (!bus_->write(address_, buf, sizeof(buf))) {
+    diagnostics_.busErrors++;
+    return false;
+  }
+  return true;
+}
+
+bool SHT3xController::fetchSample(float& temperatureC, float& humidity) {
+  uint8_t raw[6];
+  if (mode_ == Mode::Periodic) {
+    const uint8_t cmd[2] = {static_cast<uint8_t>(kCmdFetch >> 8), static_cast<uint8_t>(kCmdFetch & 0xFF)};
+    if (!bus_->write(address_, cmd, sizeof(cmd))) {
+      diagnostics_.busErrors++;
+      return false;
+    }
+  }
+  // A NACK on the read means the conversion is not finished (or, in
+  // periodic mode, no new result since the last fetch).
+  if (!bus_->read(address_, raw, sizeof(raw))) {
+    diagnostics_.busErrors++;
+    return false;
+  }
+  if (sensirionCrc8(raw, 2) != raw[2] || sensirionCrc8(raw + 3, 2) != raw[5]) {
+    diagnostics_.crcErrors++;
+    return false;
+  }
+  const uint16_t rawT = static_cast<uint16_t>((raw[0] << 8) | raw[1]);
+  const uint16_t rawH = static_cast<uint16_t>((raw[3] << 8) | raw[4]);
+  temperatureC = -45.0f + 175.0f * (rawT / 65535.0f);
+  humidity = 100.0f * (rawH / 65535.0f);
+  return true;
+}
+
+void SHT3xController::setHeater(bool on) {
+  // The sensor ignores heater commands while it is acquiring periodically.
+  if (mode_ == Mode::Periodic) {
+    sendCommand(kCmdBreak);
+    delay(1);
+  }
+  sendCommand(on ? kCmdHeaterOn : kCmdHeaterOff);
+  if (mode_ == Mode::Periodic) {
+    sendCommand(kCmdPeriodicArt);
+  }
+}
+
 void SHT3xController::update(const DateTime& now, unsigned long nowMs) {
   if (!present_) {
     return;
   }
 
+  if (measuring_) {
+    // The sensor NACKs everything until the conversion is done, so the
+    // heater is only switched once the result has been collected.
+    if ((nowMs - triggerMs_) < kConversionMs) {
+      return;
+    }
+    measuring_ = false;
+    float temperature = NAN;
+    float humidity = NAN;
+    if (!fetchSample(temperature, humidity)) {
+      temperature = NAN;
+      humidity = NAN;
+    }
+    processSample(now, nowMs, temperature, humidity);
+  }
+
   updateHeaterState(now, nowMs);
 
   if (lastSampleMs_ != 0 && (nowMs - lastSampleMs_) < kSampleIntervalMs) {
@@ -104,10 +226,24 @@ void SHT3xController::update(const DateTime& now, unsigned long nowMs) {
   }
   lastSampleMs_ = nowMs;
 
-  float temperature = sensor_.readTemperature();
-  float humidity = sensor_.readHumidity();
+  if (mode_ == Mode::SingleShot) {
+    if (sendCommand(kCmdSingleShotHigh)) {
+      measuring_ = true;
+      triggerMs_ = nowMs;
+    }
+    return;
+  }
 
+  float temperature = NAN;
+  float humidity = NAN;
+  if (fetchSample(temperature, humidity)) {
+    processSample(now, nowMs, temperature, humidity);
+  }
+}
+
+void SHT3xController::processSample(const DateTime& now, unsigned long nowMs, float temperature, float humidity) {
   diagnostics_.heaterEnabled = heaterEnabled_;
+  diagnostics_.samples++;
 
   bool valid = !(isnan(temperature) || isnan(humidity));
   bool settling = (!heaterEnabled_ && settleUntilMs_ != 0 && nowMs < settleUntilMs_);
@@ -173,6 +309,26 @@ void SHT3xController::update(const DateTime& now, unsigned long nowMs) {
   updateCondensationFault(nowMs);
 }
 
+unsigned long SHT3xController::msUntilNextUpdate(unsigned long nowMs) const {
+  if (measuring_) {
+    const unsigned long sinceTrigger = nowMs - triggerMs_;
+    return (sinceTrigger >= kConversionMs) ? 0 : (kConversionMs - sinceTrigger);
+  }
+  unsigned long waitMs = kSampleIntervalMs;
+  if (lastSampleMs_ != 0) {
+    const unsigned long sinceSample = nowMs - lastSampleMs_;
+    waitMs = (sinceSample >= kSampleIntervalMs) ? 0 : (kSampleIntervalMs - sinceSample);
+  }
+  if (heaterEnabled_) {
+    const unsigned long onMs = nowMs - heaterStartMs_;
+    const unsigned long leftMs = (onMs >= kHeaterPulseMs) ? 0 : (kHeaterPulseMs - onMs);
+    if (leftMs < waitMs) {
+      waitMs = leftMs;
+    }
+  }
+  return waitMs;
+}
+
 void SHT3xController::updateHeaterState(const DateTime& now, unsigned long nowMs) {
   (void)now;
   if (!heaterEnabled_) {
@@ -182,7 +338,7 @@ void SHT3xController::updateHeaterState(const DateTime& now, unsigned long nowMs
     return;
   }
 
-  sensor_.heater(false);
+  setHeater(false);
   heaterEnabled_ = false;
   diagnostics_.heaterEnabled = false;
   diagnostics_.lastHeaterMs = nowMs;
@@ -211,7 +367,7 @@ void SHT3xController::maybeStartHeaterPulse(const DateTime& now, unsigned long n
   pendingEvent_.rhBefore = current.humidity;
   pendingEvent_.tempBeforeC = current.temperatureC;
 
-  sensor_.heater(true);
+  setHeater(true);
   heaterEnabled_ = true;
   heaterStartMs_ = nowMs;
   diagnostics_.heaterEnabled = true;
@@ -253,6 +409,9 @@ void SHT3xController::recordHeaterEvent(const DateTime& ts, unsigned long durati
   if (heaterEventCount_ < kHeaterEventBufferSize) {
     heaterEventCount_++;
   }
+  if (heaterEventHandler_ != nullptr) {
+    heaterEventHandler_(event);
+  }
 }
 
 void SHT3xController::updateCondensationFault(unsigned long nowMs) {
@@ -270,8 +429,10 @@ void SHT3xController::updateCondensationFault(unsigned long nowMs) {
 
   if (hoursFilled_ >= kCondensationHours) {
     size_t prevIndex = (hourlyIndex_ + kCondensationHours - 1) % kCondensationHours;
-    if (hourlyPulseCounts_[hourlyIndex_] > kMaxPulsesPerHour &&
-        hourlyPulseCounts_[prevIndex] > kMaxPulsesPerHour) {
+    // canPulse() caps each hour at kMaxPulsesPerHour, so two hours at the
+    // cap is as wet as it can get.
+    if (hourlyPulseCounts_[hourlyIndex_] >= kMaxPulsesPerHour &&
+        hourlyPulseCounts_[prevIndex] >= kMaxPulsesPerHour) {
       if (!condensationFault_) {
         condensationFault_ = true;
         if (logStream_ != nullptr) {
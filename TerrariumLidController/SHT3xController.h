@@ -1,12 +1,19 @@
 #pragma once
 
 #include <Arduino.h>
-#include <Wire.h>
 #include "RTClib.h"
-#include "Adafruit_SHT31.h"
+#include "I2cBus.h"
 
 class SHT3xController {
  public:
+  // SingleShot triggers one high-repeatability conversion per sample and
+  // fetches it once the conversion time has passed. Periodic runs the
+  // sensor in ART mode (4 Hz) and fetches the latest result per sample.
+  enum class Mode : uint8_t {
+    SingleShot = 0,
+    Periodic = 1,
+  };
+
   struct Reading {
     bool valid;
     bool heaterInfluenced;
@@ -24,6 +31,10 @@ class SHT3xController {
     bool wetStuck;
     unsigned int pulsesLastHour;
     bool condensationFault;
+    Mode mode;
+    unsigned long samples;
+    unsigned long crcErrors;
+    unsigned long busErrors;
   };
 
   struct HeaterEvent {
@@ -36,12 +47,21 @@ class SHT3xController {
     float tempAfterC;
   };
 
+  using HeaterEventHandler = void (*)(const HeaterEvent& event);
+
   SHT3xController();
 
-  bool begin(TwoWire& wire, uint8_t primaryAddr = 0x44, uint8_t fallbackAddr = 0x45);
+  bool begin(I2cBus& bus, uint8_t primaryAddr = 0x44, uint8_t fallbackAddr = 0x45);
   void setLogStream(Stream& stream);
+  // Called once per completed heater event (after the post-pulse reading).
+  void setHeaterEventHandler(HeaterEventHandler handler);
   bool isPresent() const;
+  bool setMode(Mode mode);
+  Mode getMode() const;
   void update(const DateTime& now, unsigned long nowMs);
+  // Time until update() has work to do (next trigger, a conversion
+  // finishing, or the heater pulse ending).
+  unsigned long msUntilNextUpdate(unsigned long nowMs) const;
   Reading getLastReading() const;
   Reading getLastTrustedReading() const;
   Diagnostics getDiagnostics() const;
@@ -50,6 +70,17 @@ class SHT3xController {
 
  private:
   static constexpr unsigned long kSampleIntervalMs = 2000;
+  // High repeatability converts in at most 15.5 ms; one extra ms covers
+  // millis() truncation at the trigger.
+  static constexpr unsigned long kConversionMs = 17;
+  static constexpr uint16_t kCmdSingleShotHigh = 0x2400;
+  static constexpr uint16_t kCmdPeriodicArt = 0x2B32;
+  static constexpr uint16_t kCmdFetch = 0xE000;
+  static constexpr uint16_t kCmdBreak = 0x3093;
+  static constexpr uint16_t kCmdSoftReset = 0x30A2;
+  static constexpr uint16_t kCmdHeaterOn = 0x306D;
+  static constexpr uint16_t kCmdHeaterOff = 0x3066;
+  static constexpr uint16_t kCmdReadStatus = 0xF32D;
   static constexpr size_t kHistorySize = 4;
   static constexpr size_t kWetStuckSamples = 2;
   static constexpr float kWetStuckRhThreshold = 99.5f;
@@ -62,10 +93,17 @@ class SHT3xController {
   static constexpr unsigned int kCondensationHours = 2;
 
   bool tryBegin(uint8_t addr);
+  bool sendCommand(uint16_t cmd);
+  bool fetchSample(float& temperatureC, float& humidity);
+  void setHeater(bool on);
+  void processSample(const DateTime& now, unsigned long nowMs, float temperature, float humidity);
 
-  Adafruit_SHT31 sensor_;
-  TwoWire* wire_;
+  I2cBus* bus_;
+  Mode mode_;
+  bool measuring_;
+  unsigned long triggerMs_;
   Stream* logStream_;
+  HeaterEventHandler heaterEventHandler_;
   bool present_;
   uint8_t address_;
   Reading lastReading_;
@@ -0,0 +1,154 @@
+#include "SensorRollups.h"
+
+#include <math.h>
+
+SensorRollups::SensorRollups()
+    : minute_{},
+      quarter_{},
+      hour_{},
+      tiers_{
+          {minute_, kMinuteBuckets, 60, 0, 0, 0},
+          {quarter_, kQuarterBuckets, 15 * 60, 0, 0, 0},
+          {hour_, kHourBuckets, 60 * 60, 0, 0, 0},
+      } {}
+
+void SensorRollups::add(uint32_t unixTime, float temperatureC, float humidity) {
+  long t = lroundf(temperatureC * 100.0f);
+  long rh = lroundf(humidity * 100.0f);
+  if (t < -32767) t = -32767;
+  if (t > 32767) t = 32767;
+  if (rh < 0) rh = 0;
+  if (rh > 65535) rh = 65535;
+  for (TierState& tier : tiers_) {
+    addToTier(tier, unixTime, static_cast<int16_t>(t), static_cast<uint16_t>(rh));
+  }
+}
+
+void SensorRollups::clear() {
+  for (TierState& tier : tiers_) {
+    tier.head = 0;
+    tier.filled = 0;
+    tier.revision++;
+  }
+}
+
+size_t SensorRollups::getCapacity(Tier tier) const {
+  return tiers_[static_cast<size_t>(tier)].size;
+}
+
+uint32_t SensorRollups::getBucketSeconds(Tier tier) const {
+  return tiers_[static_cast<size_t>(tier)].seconds;
+}
+
+bool SensorRollups::getBucket(Tier tier, size_t age, Bucket& out) const {
+  const TierState& ts = tiers_[static_cast<size_t>(tier)];
+  if (age >= ts.filled) {
+    return false;
+  }
+  const Acc& acc = ts.buckets[(ts.head + ts.size - age) % ts.size];
+  if (acc.count == 0) {
+    return false;
+  }
+  out.startUnix = acc.startUnix;
+  out.count = acc.count;
+  out.temperatureC = Stat{acc.tMin / 100.0f, acc.tMax / 100.0f, acc.tSum / (100.0f * acc.count)};
+  out.humidity = Stat{acc.rhMin / 100.0f, acc.rhMax / 100.0f, acc.rhSum / (100.0f * acc.count)};
+  return true;
+}
+
+bool SensorRollups::getRange(Tier tier, Bucket& out) const {
+  const TierState& ts = tiers_[static_cast<size_t>(tier)];
+  Acc range;
+  resetAcc(range, 0);
+  uint32_t count = 0;
+  int64_t tSum = 0;
+  uint64_t rhSum = 0;
+  for (size_t age = 0; age < ts.filled; ++age) {
+    const Acc& acc = ts.buckets[(ts.head + ts.size - age) % ts.size];
+    if (acc.count == 0) {
+      continue;
+    }
+    range.startUnix = acc.startUnix;
+    if (acc.tMin < range.tMin) range.tMin = acc.tMin;
+    if (acc.tMax > range.tMax) range.tMax = acc.tMax;
+    if (acc.rhMin < range.rhMin) range.rhMin = acc.rhMin;
+    if (acc.rhMax > range.rhMax) range.rhMax = acc.rhMax;
+    count += acc.count;
+    tSum += acc.tSum;
+    rhSum += acc.rhSum;
+  }
+  if (count == 0) {
+    return false;
+  }
+  out.startUnix = range.startUnix;
+  out.count = count < UINT16_MAX ? static_cast<uint16_t>(count) : UINT16_MAX;
+  out.temperatureC = Stat{range.tMin / 100.0f, range.tMax / 100.0f, static_cast<float>(tSum) / (100.0f * count)};
+  out.humidity = Stat{range.rhMin / 100.0f, range.rhMax / 100.0f, static_cast<float>(rhSum) / (100.0f * count)};
+  return true;
+}
+
+uint32_t SensorRollups::getRevision(Tier tier) const {
+  return tiers_[static_cast<size_t>(tier)].revision;
+}
+
+void SensorRollups::resetAcc(Acc& acc, uint32_t startUnix) {
+  acc = Acc{startUnix, 0, INT16_MAX, INT16_MIN, 0, UINT16_MAX, 0, 0};
+}
+
+bool SensorRollups::accumulate(Acc& acc, int16_t tCenti, uint16_t rhCenti) {
+  if (acc.count == UINT16_MAX) {
+    return false;
+  }
+  const bool moved = tCenti < acc.tMin || tCenti > acc.tMax || rhCenti < acc.rhMin || rhCenti > acc.rhMax;
+  acc.count++;
+  if (tCenti < acc.tMin) acc.tMin = tCenti;
+  if (tCenti > acc.tMax) acc.tMax = tCenti;
+  acc.tSum += tCenti;
+  if (rhCenti < acc.rhMin) acc.rhMin = rhCenti;
+  if (rhCenti > acc.rhMax) acc.rhMax = rhCenti;
+  acc.rhSum += rhCenti;
+  return moved;
+}
+
+void SensorRollups::addToTier(TierState& tier, uint32_t unixTime, int16_t tCenti, uint16_t rhCenti) {
+  const uint32_t start = unixTime - unixTime % tier.seconds;
+  if (tier.filled > 0) {
+    Acc& current = tier.buckets[tier.head];
+    if (start == current.startUnix) {
+      if (accumulate(current, tCenti, rhCenti)) tier.revision++;
+      return;
+    }
+    if (start > current.startUnix) {
+      // Step over any empty buckets; a gap longer than the ring restarts it.
+      const uint32_t steps = (start - current.startUnix) / tier.seconds;
+      if (steps < tier.size) {
+        uint32_t next = current.startUnix;
+        for (uint32_t i = 0; i < steps; ++i) {
+          next += tier.seconds;
+          tier.head = (tier.head + 1) % tier.size;
+          resetAcc(tier.buckets[tier.head], next);
+          if (tier.filled < tier.size) tier.filled++;
+        }
+        accumulate(tier.buckets[tier.head], tCenti, rhCenti);
+        tier.revision++;
+        return;
+      }
+    } else {
+      // Clock stepped back: fill the matching older bucket if it is still
+      // in the ring, otherwise start over.
+      const uint32_t age = (current.startUnix - start) / tier.seconds;
+      if (age < tier.filled) {
+        Acc& older = tier.buckets[(tier.head + tier.size - age) % tier.size];
+        if (older.startUnix == start) {
+          if (accumulate(older, tCenti, rhCenti)) tier.revision++;
+          return;
+        }
+      }
+    }
+  }
+  tier.head = 0;
+  tier.filled = 1;
+  resetAcc(tier.buckets[0], start);
+  accumulate(tier.buckets[0], tCenti, rhCenti);
+  tier.revision++;
+}
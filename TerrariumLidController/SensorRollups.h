@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Min/max/mean rollups of temperature and RH at three resolutions, each a
+// fixed ring of buckets aligned to wall-clock boundaries:
+//   Minute  - 1 min  x 60  (last hour)
+//   Quarter - 15 min x 96  (last day)
+//   Hour    - 1 h    x 168 (last week)
+// add() updates every tier in O(1); readers get finished statistics per
+// bucket without touching raw samples. The display's 24 h graphs draw one
+// column per Quarter bucket.
+class SensorRollups {
+ public:
+  enum class Tier : uint8_t {
+    Minute = 0,
+    Quarter = 1,
+    Hour = 2,
+  };
+
+  struct Stat {
+    float min;
+    float max;
+    float mean;
+  };
+
+  struct Bucket {
+    uint32_t startUnix;
+    uint16_t count;
+    Stat temperatureC;
+    Stat humidity;
+  };
+
+  static constexpr size_t kTierCount = 3;
+  static constexpr size_t kMinuteBuckets = 60;
+  static constexpr size_t kQuarterBuckets = 96;
+  static constexpr size_t kHourBuckets = 168;
+
+  SensorRollups();
+
+  void add(uint32_t unixTime, float temperatureC, float humidity);
+  void clear();
+  size_t getCapacity(Tier tier) const;
+  uint32_t getBucketSeconds(Tier tier) const;
+  // age 0 is the current (possibly partial) bucket, 1 the one before, ...
+  // Returns false for buckets with no samples or beyond what was seen.
+  bool getBucket(Tier tier, size_t age, Bucket& out) const;
+  // Extremes and mean over every bucket of a tier, startUnix being the
+  // oldest one's; false if the tier is empty.
+  bool getRange(Tier tier, Bucket& out) const;
+  // Changes whenever a tier opens a bucket or a min/max in it moves, so a
+  // graph can tell it is up to date. Means alone do not count.
+  uint32_t getRevision(Tier tier) const;
+
+ private:
+  // Centi-units keep a bucket at 24 bytes.
+  struct Acc {
+    uint32_t startUnix;
+    uint16_t count;
+    int16_t tMin;
+    int16_t tMax;
+    int32_t tSum;
+    uint16_t rhMin;
+    uint16_t rhMax;
+    uint32_t rhSum;
+  };
+
+  struct TierState {
+    Acc* buckets;
+    size_t size;
+    uint32_t seconds;
+    size_t head;
+    size_t filled;
+    uint32_t revision;
+  };
+
+  static void resetAcc(Acc& acc, uint32_t startUnix);
+  // Returns true if the sample moved a min or max.
+  static bool accumulate(Acc& acc, int16_t tCenti, uint16_t rhCenti);
+  void addToTier(TierState& tier, uint32_t unixTime, int16_t tCenti, uint16_t rhCenti);
+
+  Acc minute_[kMinuteBuckets];
+  Acc quarter_[kQuarterBuckets];
+  Acc hour_[kHourBuckets];
+  TierState tiers_[kTierCount];
+};
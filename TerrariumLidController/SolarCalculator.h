@@ -0,0 +1,132 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Sunrise/sunset and civil twilight for one date and location, shared by
+// the firmware (SolarSchedule) and the host table generator
+// (host/tools/SolarTable.cpp). Kept free of Arduino types.
+//
+// Uses the Almanac for Computers approximation (about 1-2 min of error
+// below the polar circles). Results are minutes of the local day.
+
+enum class SolarDayKind : uint8_t {
+  Normal = 0,
+  PolarDay = 1,    // the sun never sets
+  PolarNight = 2,  // the sun never rises
+};
+
+struct SolarDay {
+  SolarDayKind kind;
+  int16_t dawnMin;  // civil twilight begins (== sunriseMin if it never ends)
+  int16_t sunriseMin;
+  int16_t sunsetMin;
+  int16_t duskMin;  // civil twilight ends (== sunsetMin if it never ends)
+};
+
+constexpr double kSolarZenithOfficial = 90.833;
+constexpr double kSolarZenithCivil = 96.0;
+
+inline int solarDayOfYear(int year, int month, int day) {
+  static const int kCumulative[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+  const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  return kCumulative[(month - 1) % 12] + day + ((leap && month > 2) ? 1 : 0);
+}
+
+// Minute of the local day of a rising or setting crossing of zenithDeg.
+// Returns +1 if the sun stays below that zenith all day, -1 if it stays
+// above, 0 on success.
+inline int solarEventMinute(int dayOfYear, double latitude, double longitude, int utcOffsetMin,
+                            double zenithDeg, bool rising, int16_t& minuteOut) {
+  constexpr double kRad = 3.14159265358979323846 / 180.0;
+  const double lngHour = longitude / 15.0;
+  const double t = dayOfYear + ((rising ? 6.0 : 18.0) - lngHour) / 24.0;
+  const double m = 0.9856 * t - 3.289;
+  double l = m + 1.916 * sin(m * kRad) + 0.020 * sin(2.0 * m * kRad) + 282.634;
+  l = fmod(l + 360.0, 360.0);
+  double ra = atan(0.91764 * tan(l * kRad)) / kRad;
+  ra = fmod(ra + 360.0, 360.0);
+  ra += floor(l / 90.0) * 90.0 - floor(ra / 90.0) * 90.0;
+  ra /= 15.0;
+  const double sinDec = 0.39782 * sin(l * kRad);
+  const double cosDec = cos(asin(sinDec));
+  const double cosH = (cos(zenithDeg * kRad) - sinDec * sin(latitude * kRad)) / (cosDec * cos(latitude * kRad));
+  if (cosH > 1.0) {
+    return 1;
+  }
+  if (cosH < -1.0) {
+    return -1;
+  }
+  const double h = (rising ? 360.0 - acos(cosH) / kRad : acos(cosH) / kRad) / 15.0;
+  const double localT = h + ra - 0.06571 * t - 6.622;
+  double hours = fmod(localT - lngHour + utcOffsetMin / 60.0, 24.0);
+  if (hours < 0.0) hours += 24.0;
+  int minute = static_cast<int>(floor(hours * 60.0 + 0.5));
+  minuteOut = static_cast<int16_t>(minute % 1440);
+  return 0;
+}
+
+inline SolarDay computeSolarDay(int dayOfYear, double latitude, double longitude, int utcOffsetMin) {
+  SolarDay day{SolarDayKind::Normal, 0, 0, 0, 0};
+  const int rise = solarEventMinute(dayOfYear, latitude, longitude, utcOffsetMin, kSolarZenithOfficial, true,
+                                    day.sunriseMin);
+  solarEventMinute(dayOfYear, latitude, longitude, utcOffsetMin, kSolarZenithOfficial, false, day.sunsetMin);
+  if (rise != 0) {
+    day.kind = rise > 0 ? SolarDayKind::PolarNight : SolarDayKind::PolarDay;
+    return day;
+  }
+  if (solarEventMinute(dayOfYear, latitude, longitude, utcOffsetMin, kSolarZenithCivil, true, day.dawnMin) != 0) {
+    day.dawnMin = day.sunriseMin;
+  }
+  if (solarEventMinute(dayOfYear, latitude, longitude, utcOffsetMin, kSolarZenithCivil, false, day.duskMin) != 0) {
+    day.duskMin = day.sunsetMin;
+  }
+  return day;
+}
+
+// Yearly table: the four event minutes sampled every kSolarTableStepDays
+// (day of year 1, 5, ...), stored per event as a u16 first sample followed
+// by i8 deltas between samples, and interpolated linearly between them.
+// 372 bytes instead of 2.9 KB for every day; only Normal days fit.
+constexpr int kSolarTableStepDays = 4;
+constexpr size_t kSolarTableSamples = (365 + kSolarTableStepDays - 1) / kSolarTableStepDays;
+constexpr size_t kSolarTableEventBytes = 2 + (kSolarTableSamples - 1);
+constexpr size_t kSolarTableBytes = 4 * kSolarTableEventBytes;
+
+inline int16_t solarEventField(const SolarDay& day, size_t event) {
+  switch (event) {
+    case 0: return day.dawnMin;
+    case 1: return day.sunriseMin;
+    case 2: return day.sunsetMin;
+    default: return day.duskMin;
+  }
+}
+
+inline bool decodeSolarTable(const uint8_t* table, size_t size, int dayOfYear, SolarDay& out) {
+  if (size != kSolarTableBytes || dayOfYear < 1) {
+    return false;
+  }
+  const int index = (dayOfYear - 1) / kSolarTableStepDays;
+  const int frac = (dayOfYear - 1) % kSolarTableStepDays;
+  int16_t values[4];
+  for (size_t e = 0; e < 4; ++e) {
+    const uint8_t* p = table + e * kSolarTableEventBytes;
+    int first = p[0] | (p[1] << 8);
+    int a = first;
+    for (int i = 1; i <= index && i < static_cast<int>(kSolarTableSamples); ++i) {
+      a += static_cast<int8_t>(p[1 + i]);
+    }
+    // Past the last sample, interpolate towards the first (next year).
+    const int b = index + 1 < static_cast<int>(kSolarTableSamples)
+                      ? a + static_cast<int8_t>(p[2 + index])
+                      : first;
+    int diff = b - a;
+    if (diff > 720) diff -= 1440;
+    if (diff < -720) diff += 1440;
+    int v = a + (diff * frac + (diff >= 0 ? kSolarTableStepDays / 2 : -kSolarTableStepDays / 2)) / kSolarTableStepDays;
+    values[e] = static_cast<int16_t>((v % 1440 + 1440) % 1440);
+  }
+  out = SolarDay{SolarDayKind::Normal, values[0], values[1], values[2], values[3]};
+  return true;
+}
@@ -0,0 +1,126 @@
+#include "SolarSchedule.h"
+
+#include "SolarTable.h"
+
+SolarSchedule::SolarSchedule()
+    : config_{false, 0.0f, 0.0f, 0},
+      prefsOpened_(false),
+      dirty_(true),
+      dayKey_(0),
+      day_{SolarDayKind::Normal, 0, 0, 0, 0},
+      haveDay_(false),
+      fromTable_(false),
+      dayOfYear_(0),
+      computes_(0) {}
+
+void SolarSchedule::begin() {
+  prefsOpened_ = prefs_.begin("solar", false);
+  if (prefsOpened_) {
+    config_.enabled = prefs_.getUChar("enabled", 0) != 0;
+    config_.latitude = prefs_.getFloat("lat", 0.0f);
+    config_.longitude = prefs_.getFloat("lon", 0.0f);
+    config_.utcOffsetMin = static_cast<int16_t>(prefs_.getInt("utc_min", 0));
+  }
+  dirty_ = true;
+}
+
+SolarSchedule::Config SolarSchedule::getConfig() const {
+  return config_;
+}
+
+void SolarSchedule::setEnabled(bool enabled) {
+  config_.enabled = enabled;
+  dirty_ = true;
+  save();
+}
+
+bool SolarSchedule::setLocation(float latitude, float longitude, int utcOffsetMin) {
+  if (!(latitude >= -90.0f && latitude <= 90.0f) || !(longitude >= -180.0f && longitude <= 180.0f) ||
+      utcOffsetMin < -14 * 60 || utcOffsetMin > 14 * 60) {
+    return false;
+  }
+  config_.latitude = latitude;
+  config_.longitude = longitude;
+  config_.utcOffsetMin = static_cast<int16_t>(utcOffsetMin);
+  dirty_ = true;
+  save();
+  return true;
+}
+
+bool SolarSchedule::update(const DateTime& now) {
+  const int dayOfYear = solarDayOfYear(now.year(), now.month(), now.day());
+  const uint32_t key = static_cast<uint32_t>(now.year()) * 400U + static_cast<uint32_t>(dayOfYear);
+  if (!dirty_ && (key == dayKey_ || !config_.enabled)) {
+    return false;
+  }
+  dirty_ = false;
+  if (!config_.enabled) {
+    dayKey_ = 0;
+    haveDay_ = false;
+    return true;
+  }
+  dayKey_ = key;
+  dayOfYear_ = static_cast<uint16_t>(dayOfYear);
+  fromTable_ = tableMatches() && decodeSolarTable(kSolarTable, kSolarTableSize, dayOfYear, day_);
+  if (!fromTable_) {
+    day_ = computeSolarDay(dayOfYear, config_.latitude, config_.longitude, config_.utcOffsetMin);
+  }
+  haveDay_ = true;
+  computes_++;
+  return true;
+}
+
+const SolarDay& SolarSchedule::getDay() const {
+  return day_;
+}
+
+size_t SolarSchedule::buildSegments(LightSchedule::Segment* out, size_t max) const {
+  if (!haveDay_ || max < 3) {
+    return 0;
+  }
+  if (day_.kind == SolarDayKind::PolarNight) {
+    return 0;
+  }
+  if (day_.kind == SolarDayKind::PolarDay) {
+    out[0] = LightSchedule::Segment{LightSchedule::kAllDays, 0, 1440, 1000, 1000};
+    return 1;
+  }
+  auto span = [](int16_t from, int16_t to) { return static_cast<uint16_t>((to - from + 1440) % 1440); };
+  size_t n = 0;
+  const uint16_t rise = span(day_.dawnMin, day_.sunriseMin);
+  const uint16_t light = span(day_.sunriseMin, day_.sunsetMin);
+  const uint16_t set = span(day_.sunsetMin, day_.duskMin);
+  if (rise > 0) {
+    out[n++] = LightSchedule::Segment{LightSchedule::kAllDays, static_cast<uint16_t>(day_.dawnMin), rise, 0, 1000};
+  }
+  if (light > 0) {
+    out[n++] = LightSchedule::Segment{LightSchedule::kAllDays, static_cast<uint16_t>(day_.sunriseMin), light, 1000, 1000};
+  }
+  if (set > 0) {
+    out[n++] = LightSchedule::Segment{LightSchedule::kAllDays, static_cast<uint16_t>(day_.sunsetMin), set, 1000, 0};
+  }
+  return n;
+}
+
+SolarSchedule::Status SolarSchedule::getStatus() const {
+  return Status{haveDay_, fromTable_, dayOfYear_, computes_};
+}
+
+void SolarSchedule::save() {
+  if (!prefsOpened_) {
+    prefsOpened_ = prefs_.begin("solar", false);
+  }
+  if (!prefsOpened_) {
+    return;
+  }
+  prefs_.putUChar("enabled", config_.enabled ? 1 : 0);
+  prefs_.putFloat("lat", config_.latitude);
+  prefs_.putFloat("lon", config_.longitude);
+  prefs_.putInt("utc_min", config_.utcOffsetMin);
+}
+
+bool SolarSchedule::tableMatches() const {
+  return kSolarTableSize > 0 && fabsf(config_.latitude - kSolarTableLatitude) < 0.01f &&
+         fabsf(config_.longitude - kSolarTableLongitude) < 0.01f &&
+         config_.utcOffsetMin == kSolarTableUtcOffsetMin;
+}
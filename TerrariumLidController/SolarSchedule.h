@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "LightSchedule.h"
+#include "RTClib.h"
+#include "SolarCalculator.h"
+
+// Solar mode for the light schedule: dawn -> sunrise ramp up, full level
+// until sunset, sunset -> dusk ramp down, for a configured location.
+// The day's times are worked out once when the RTC date changes (from
+// SolarTable.h if it matches the location, else with the trig in
+// SolarCalculator.h), so nothing per loop touches them.
+//
+// The RTC keeps local time; utcOffsetMin is the offset in effect (no DST
+// rules). Settings live in NVS namespace "solar".
+class SolarSchedule {
+ public:
+  struct Config {
+    bool enabled;
+    float latitude;
+    float longitude;
+    int16_t utcOffsetMin;
+  };
+
+  struct Status {
+    bool haveDay;
+    bool fromTable;
+    uint16_t dayOfYear;
+    unsigned long computes;
+  };
+
+  SolarSchedule();
+
+  void begin();
+  Config getConfig() const;
+  void setEnabled(bool enabled);
+  bool setLocation(float latitude, float longitude, int utcOffsetMin);
+  // Returns true when the generated segments need to be (re)applied: the
+  // date changed while enabled, or the settings changed.
+  bool update(const DateTime& now);
+  const SolarDay& getDay() const;
+  size_t buildSegments(LightSchedule::Segment* out, size_t max) const;
+  Status getStatus() const;
+
+ private:
+  void save();
+  bool tableMatches() const;
+
+  Config config_;
+  Preferences prefs_;
+  bool prefsOpened_;
+  bool dirty_;
+  uint32_t dayKey_;
+  SolarDay day_;
+  bool haveDay_;
+  bool fromTable_;
+  uint16_t dayOfYear_;
+  unsigned long computes_;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Optional precomputed solar table for one location (format in
+// SolarCalculator.h), written by tlc_solar_table:
+//   ./build/tlc_solar_table <lat> <lon> <utcOffsetMin> > TerrariumLidController/SolarTable.h
+// SolarSchedule uses it when its configured location matches; otherwise,
+// and while this file holds no table, each day is computed at runtime.
+constexpr float kSolarTableLatitude = 0.0f;
+constexpr float kSolarTableLongitude = 0.0f;
+constexpr int kSolarTableUtcOffsetMin = 0;
+constexpr size_t kSolarTableSize = 0;
+constexpr uint8_t kSolarTable[1] = {0};
@@ -0,0 +1,127 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler()
+    : tasks_{},
+      taskCount_(0),
+      sleptMs_(0) {}
+
+int TaskScheduler::addTask(const char* name, TaskFn fn, unsigned long periodMs, unsigned long budgetUs) {
+  if (taskCount_ >= kMaxTasks || fn == nullptr) {
+    return -1;
+  }
+  Task& task = tasks_[taskCount_];
+  task.fn = fn;
+  task.nextRunMs = millis();
+  task.stats = TaskStats{name, periodMs, budgetUs, 0, 0, 0, 0, 0};
+  return static_cast<int>(taskCount_++);
+}
+
+void TaskScheduler::setNextRunIn(int id, unsigned long delayMs) {
+  if (id < 0 || static_cast<size_t>(id) >= taskCount_) {
+    return;
+  }
+  tasks_[id].nextRunMs = millis() + delayMs;
+}
+
+void TaskScheduler::setPeriod(int id, unsigned long periodMs) {
+  if (id < 0 || static_cast<size_t>(id) >= taskCount_) {
+    return;
+  }
+  tasks_[id].stats.periodMs = periodMs;
+  tasks_[id].nextRunMs = millis() + periodMs;
+}
+
+bool TaskScheduler::isDue(const Task& task, unsigned long nowMs) const {
+  return static_cast<long>(nowMs - task.nextRunMs) >= 0;
+}
+
+void TaskScheduler::runDue() {
+  // Always restart from the highest-priority task so a slow task is
+  // followed by whatever fell due while it ran.
+  for (;;) {
+    const unsigned long nowMs = millis();
+    Task* next = nullptr;
+    for (size_t i = 0; i < taskCount_; ++i) {
+      if (isDue(tasks_[i], nowMs)) {
+        next = &tasks_[i];
+        break;
+      }
+    }
+    if (next == nullptr) {
+      return;
+    }
+
+    TaskStats& st = next->stats;
+    const unsigned long lateMs = nowMs - next->nextRunMs;
+    if (lateMs > st.maxLateMs) {
+      st.maxLateMs = lateMs;
+    }
+
+    // Keep the original cadence; if a whole period was missed, skip ahead
+    // instead of running a burst of catch-up iterations.
+    next->nextRunMs += st.periodMs;
+    if (isDue(*next, nowMs)) {
+      next->nextRunMs = nowMs + st.periodMs;
+    }
+
+    const unsigned long t0 = micros();
+    next->fn(nowMs);
+    const unsigned long dt = micros() - t0;
+
+    st.runs++;
+    st.lastRunUs = dt;
+    if (dt > st.maxRunUs) {
+      st.maxRunUs = dt;
+    }
+    if (st.budgetUs > 0 && dt > st.budgetUs) {
+      st.overruns++;
+    }
+  }
+}
+
+void TaskScheduler::sleepUntilNextDeadline() {
+  if (taskCount_ == 0) {
+    delay(1);
+    sleptMs_ += 1;
+    return;
+  }
+  const unsigned long nowMs = millis();
+  long waitMs = static_cast<long>(tasks_[0].nextRunMs - nowMs);
+  for (size_t i = 1; i < taskCount_; ++i) {
+    const long w = static_cast<long>(tasks_[i].nextRunMs - nowMs);
+    if (w < waitMs) {
+      waitMs = w;
+    }
+  }
+  if (waitMs > 0) {
+    delay(static_cast<unsigned long>(waitMs));
+    sleptMs_ += static_cast<unsigned long>(waitMs);
+  }
+}
+
+size_t TaskScheduler::getTaskCount() const {
+  return taskCount_;
+}
+
+TaskScheduler::TaskStats TaskScheduler::getTaskStats(size_t index) const {
+  if (index >= taskCount_) {
+    return TaskStats{nullptr, 0, 0, 0, 0, 0, 0, 0};
+  }
+  return tasks_[index].stats;
+}
+
+unsigned long TaskScheduler::getSleptMs() const {
+  return sleptMs_;
+}
+
+void TaskScheduler::resetStats() {
+  for (size_t i = 0; i < taskCount_; ++i) {
+    TaskStats& st = tasks_[i].stats;
+    st.runs = 0;
+    st.overruns = 0;
+    st.lastRunUs = 0;
+    st.maxRunUs = 0;
+    st.maxLateMs = 0;
+  }
+  sleptMs_ = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Cooperative deadline scheduler for the main loop. Tasks run to completion
+// in registration order (earlier = higher priority) once their deadline has
+// passed; between passes the loop sleeps until the earliest deadline.
+class TaskScheduler {
+ public:
+  using TaskFn = void (*)(unsigned long nowMs);
+
+  struct TaskStats {
+    const char* name;
+    unsigned long periodMs;
+    unsigned long budgetUs;
+    unsigned long runs;
+    unsigned long overruns;
+    unsigned long lastRunUs;
+    unsigned long maxRunUs;
+    unsigned long maxLateMs;
+  };
+
+  static constexpr size_t kMaxTasks = 8;
+
+  TaskScheduler();
+
+  // Returns the task id, or -1 when the table is full.
+  int addTask(const char* name, TaskFn fn, unsigned long periodMs, unsigned long budgetUs);
+  // Overrides the next deadline of a task (may be called from inside it).
+  void setNextRunIn(int id, unsigned long delayMs);
+  // Changes a task's period; its next run is one new period from now.
+  void setPeriod(int id, unsigned long periodMs);
+  void runDue();
+  void sleepUntilNextDeadline();
+  size_t getTaskCount() const;
+  TaskStats getTaskStats(size_t index) const;
+  unsigned long getSleptMs() const;
+  void resetStats();
+
+ private:
+  struct Task {
+    TaskFn fn;
+    unsigned long nextRunMs;
+    TaskStats stats;
+  };
+
+  bool isDue(const Task& task, unsigned long nowMs) const;
+
+  Task tasks_[kMaxTasks];
+  size_t taskCount_;
+  unsigned long sleptMs_;
+};
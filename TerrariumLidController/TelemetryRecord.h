@@ -0,0 +1,278 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Wire format of the 'stream' telemetry records, shared by the firmware and
+// the host decoder (host/tools/TelemetryDecode.cpp). Kept free of Arduino
+// types so both sides compile it unchanged.
+//
+// Frame on the wire: 0x00, COBS(record), 0x00. A record is kTelemetryRecordSize
+// little-endian bytes; the last two are CRC-16/CCITT-FALSE over the rest.
+// Text console output may appear between frames; it never contains 0x00, so
+// a decoder resynchronises at the next delimiter.
+//
+// Layout (version 2; version 1 is the same layout with a 10-bit duty):
+//   0  u8   version
+//   1  u8   record type (1 = state)
+//   2  u32  sequence number
+//   6  u32  uptime ms
+//  10  u32  RTC unix time
+//  14  u16  UiState flags (kTelemetryFlag*)
+//  16  u8   control mode
+//  17  u8   brightness percent
+//  18  u16  raw pot
+//  20  u16  PWM duty, 0..kTelemetryDutyMax
+//  22  f32  pot norm
+//  26  f32  pot scaled
+//  30  f32  pot filtered
+//  34  f32  gate
+//  38  f32  trusted humidity %
+//  42  f32  trusted temperature F
+//  46  c16  next event text (NUL padded)
+//  62  u8   SHT3x flags (kTelemetrySht*)
+//  63  u8   SHT3x address
+//  64  u16  heater pulses in the last hour
+//  66  u32  last heater pulse ms
+//  70  u32  SHT3x samples
+//  74  u32  SHT3x CRC errors
+//  78  u32  SHT3x bus errors
+//  82  f32  last reading temperature C
+//  86  f32  last reading humidity %
+//  90  u16  CRC
+//
+// New fields go on the end with a version bump, and so does a change in a
+// field's meaning; decoders reject versions they do not know.
+
+constexpr uint8_t kTelemetryVersion = 2;
+constexpr uint8_t kTelemetryTypeState = 1;
+constexpr size_t kTelemetryRecordSize = 92;
+constexpr size_t kTelemetryNextEventSize = 16;
+// Duty is 14-bit since version 2; version 1 sent 10-bit duty.
+constexpr uint16_t kTelemetryDutyMax = 16383;
+constexpr uint16_t kTelemetryDutyMaxV1 = 1023;
+// Delimiter + worst-case COBS overhead + delimiter.
+constexpr size_t kTelemetryFrameMax = 1 + kTelemetryRecordSize + kTelemetryRecordSize / 254 + 1 + 1;
+
+constexpr uint16_t kTelemetryFlagRtcValid = 1u << 0;
+constexpr uint16_t kTelemetryFlagLightOn = 1u << 1;
+constexpr uint16_t kTelemetryFlagScheduleAllowed = 1u << 2;
+constexpr uint16_t kTelemetryFlagForceOn = 1u << 3;
+constexpr uint16_t kTelemetryFlagHasHumidity = 1u << 4;
+constexpr uint16_t kTelemetryFlagHasTempF = 1u << 5;
+constexpr uint16_t kTelemetryFlagNeedsWatering = 1u << 6;
+constexpr uint16_t kTelemetryFlagTooCold = 1u << 7;
+constexpr uint16_t kTelemetryFlagTooHot = 1u << 8;
+constexpr uint16_t kTelemetryFlagUsbPowerLimited = 1u << 9;
+
+constexpr uint8_t kTelemetryShtPresent = 1u << 0;
+constexpr uint8_t kTelemetryShtHeater = 1u << 1;
+constexpr uint8_t kTelemetryShtWetStuck = 1u << 2;
+constexpr uint8_t kTelemetryShtCondensation = 1u << 3;
+constexpr uint8_t kTelemetryShtPeriodic = 1u << 4;
+constexpr uint8_t kTelemetryShtLastValid = 1u << 5;
+constexpr uint8_t kTelemetryShtLastInfluenced = 1u << 6;
+constexpr uint8_t kTelemetryShtLastSettling = 1u << 7;
+
+struct TelemetryRecord {
+  uint8_t version;
+  uint8_t type;
+  uint32_t seq;
+  uint32_t uptimeMs;
+  uint32_t rtcUnix;
+  uint16_t flags;
+  uint8_t controlMode;
+  uint8_t brightnessPercent;
+  uint16_t rawPot;
+  uint16_t duty;
+  float potNorm;
+  float potScaled;
+  float potFiltered;
+  float gate;
+  float humidityPercent;
+  float temperatureF;
+  char nextEvent[kTelemetryNextEventSize];
+  uint8_t shtFlags;
+  uint8_t shtAddress;
+  uint16_t shtPulsesLastHour;
+  uint32_t shtLastHeaterMs;
+  uint32_t shtSamples;
+  uint32_t shtCrcErrors;
+  uint32_t shtBusErrors;
+  float shtLastTemperatureC;
+  float shtLastHumidity;
+};
+
+inline uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+namespace telemetry_detail {
+
+inline void putU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+inline void putF32(uint8_t* p, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  putU32(p, bits);
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline float getF32(const uint8_t* p) {
+  const uint32_t bits = getU32(p);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+}  // namespace telemetry_detail
+
+// Serialises r into out[kTelemetryRecordSize], CRC included.
+inline void packTelemetryRecord(const TelemetryRecord& r, uint8_t* out) {
+  using namespace telemetry_detail;
+  out[0] = r.version;
+  out[1] = r.type;
+  putU32(out + 2, r.seq);
+  putU32(out + 6, r.uptimeMs);
+  putU32(out + 10, r.rtcUnix);
+  putU16(out + 14, r.flags);
+  out[16] = r.controlMode;
+  out[17] = r.brightnessPercent;
+  putU16(out + 18, r.rawPot);
+  putU16(out + 20, r.duty);
+  putF32(out + 22, r.potNorm);
+  putF32(out + 26, r.potScaled);
+  putF32(out + 30, r.potFiltered);
+  putF32(out + 34, r.gate);
+  putF32(out + 38, r.humidityPercent);
+  putF32(out + 42, r.temperatureF);
+  memcpy(out + 46, r.nextEvent, kTelemetryNextEventSize);
+  out[62] = r.shtFlags;
+  out[63] = r.shtAddress;
+  putU16(out + 64, r.shtPulsesLastHour);
+  putU32(out + 66, r.shtLastHeaterMs);
+  putU32(out + 70, r.shtSamples);
+  putU32(out + 74, r.shtCrcErrors);
+  putU32(out + 78, r.shtBusErrors);
+  putF32(out + 82, r.shtLastTemperatureC);
+  putF32(out + 86, r.shtLastHumidity);
+  putU16(out + 90, telemetryCrc16(out, kTelemetryRecordSize - 2));
+}
+
+// Returns false on a short record, CRC mismatch or unknown version. A
+// version 1 duty is rescaled to 0..kTelemetryDutyMax.
+inline bool unpackTelemetryRecord(const uint8_t* in, size_t len, TelemetryRecord& r) {
+  using namespace telemetry_detail;
+  if (len != kTelemetryRecordSize) {
+    return false;
+  }
+  if (getU16(in + 90) != telemetryCrc16(in, kTelemetryRecordSize - 2)) {
+    return false;
+  }
+  if (in[0] != kTelemetryVersion && in[0] != 1) {
+    return false;
+  }
+  r.version = in[0];
+  r.type = in[1];
+  r.seq = getU32(in + 2);
+  r.uptimeMs = getU32(in + 6);
+  r.rtcUnix = getU32(in + 10);
+  r.flags = getU16(in + 14);
+  r.controlMode = in[16];
+  r.brightnessPercent = in[17];
+  r.rawPot = getU16(in + 18);
+  r.duty = getU16(in + 20);
+  if (r.version == 1) {
+    r.duty = static_cast<uint16_t>((r.duty * static_cast<uint32_t>(kTelemetryDutyMax) + kTelemetryDutyMaxV1 / 2) /
+                                   kTelemetryDutyMaxV1);
+  }
+  r.potNorm = getF32(in + 22);
+  r.potScaled = getF32(in + 26);
+  r.potFiltered = getF32(in + 30);
+  r.gate = getF32(in + 34);
+  r.humidityPercent = getF32(in + 38);
+  r.temperatureF = getF32(in + 42);
+  memcpy(r.nextEvent, in + 46, kTelemetryNextEventSize);
+  r.nextEvent[kTelemetryNextEventSize - 1] = '\0';
+  r.shtFlags = in[62];
+  r.shtAddress = in[63];
+  r.shtPulsesLastHour = getU16(in + 64);
+  r.shtLastHeaterMs = getU32(in + 66);
+  r.shtSamples = getU32(in + 70);
+  r.shtCrcErrors = getU32(in + 74);
+  r.shtBusErrors = getU32(in + 78);
+  r.shtLastTemperatureC = getF32(in + 82);
+  r.shtLastHumidity = getF32(in + 86);
+  return true;
+}
+
+// COBS-encodes len bytes into out (room for len + len / 254 + 1 bytes).
+// Returns the encoded length; the output contains no 0x00.
+inline size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t codeIndex = 0;
+  size_t o = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; ++i) {
+    if (in[i] == 0) {
+      out[codeIndex] = code;
+      codeIndex = o++;
+      code = 1;
+      continue;
+    }
+    out[o++] = in[i];
+    if (++code == 0xFF) {
+      out[codeIndex] = code;
+      codeIndex = o++;
+      code = 1;
+    }
+  }
+  out[codeIndex] = code;
+  return o;
+}
+
+// Decodes one COBS block (delimiters stripped) into out[outMax]. Returns the
+// decoded length, or 0 if the block is malformed or does not fit.
+inline size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t outMax) {
+  size_t i = 0;
+  size_t o = 0;
+  while (i < len) {
+    const uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) {
+      return 0;
+    }
+    for (uint8_t k = 1; k < code; ++k) {
+      if (o >= outMax) return 0;
+      out[o++] = in[i++];
+    }
+    if (code != 0xFF && i < len) {
+      if (o >= outMax) return 0;
+      out[o++] = 0;
+    }
+  }
+  return o;
+}
@@ -0,0 +1,109 @@
+#include "TelemetryStream.h"
+#include "LedDimmer.h"
+
+static_assert(LedDimmer::kMaxDuty == kTelemetryDutyMax, "telemetry duty range needs a version bump");
+
+TelemetryStream::TelemetryStream(Print& out)
+    : out_(out),
+      enabled_(false),
+      rateHz_(0),
+      seq_(0),
+      frames_(0),
+      shortWrites_(0),
+      lastFrameBytes_(0) {}
+
+bool TelemetryStream::start(uint16_t rateHz) {
+  if (rateHz == 0 || rateHz > kMaxRateHz) {
+    return false;
+  }
+  rateHz_ = rateHz;
+  enabled_ = true;
+  return true;
+}
+
+void TelemetryStream::stop() {
+  enabled_ = false;
+}
+
+bool TelemetryStream::isEnabled() const {
+  return enabled_;
+}
+
+unsigned long TelemetryStream::periodMs() const {
+  return rateHz_ > 0 ? 1000UL / rateHz_ : 1000UL;
+}
+
+void TelemetryStream::send(const UiState& ui, const SHT3xController& sht, unsigned long nowMs) {
+  if (!enabled_) {
+    return;
+  }
+
+  TelemetryRecord r{};
+  r.version = kTelemetryVersion;
+  r.type = kTelemetryTypeState;
+  r.seq = seq_;
+  r.uptimeMs = nowMs;
+  r.rtcUnix = ui.rtcValid ? ui.rtcNow.unixtime() : 0;
+  r.flags = static_cast<uint16_t>((ui.rtcValid ? kTelemetryFlagRtcValid : 0) |
+                                  (ui.lightOn ? kTelemetryFlagLightOn : 0) |
+                                  (ui.scheduleAllowed ? kTelemetryFlagScheduleAllowed : 0) |
+                                  (ui.forceOn ? kTelemetryFlagForceOn : 0) |
+                                  (ui.hasHumidity ? kTelemetryFlagHasHumidity : 0) |
+                                  (ui.hasTempF ? kTelemetryFlagHasTempF : 0) |
+                                  (ui.needsWatering ? kTelemetryFlagNeedsWatering : 0) |
+                                  (ui.tooCold ? kTelemetryFlagTooCold : 0) |
+                                  (ui.tooHot ? kTelemetryFlagTooHot : 0) |
+                                  (ui.usbPowerLimited ? kTelemetryFlagUsbPowerLimited : 0));
+  r.controlMode = static_cast<uint8_t>(ui.controlMode);
+  r.brightnessPercent = static_cast<uint8_t>(ui.brightnessPercent < 0 ? 0 : ui.brightnessPercent);
+  r.rawPot = static_cast<uint16_t>(ui.rawPot);
+  r.duty = static_cast<uint16_t>(ui.duty);
+  r.potNorm = ui.potNormQ16 / 65535.0f;
+  r.potScaled = ui.potScaledQ16 / 65535.0f;
+  r.potFiltered = ui.potFilteredQ16 / 65535.0f;
+  r.gate = ui.gateQ16 / 65536.0f;
+  r.humidityPercent = ui.humidityPercent;
+  r.temperatureF = ui.temperatureF;
+  static_assert(sizeof(r.nextEvent) == sizeof(ui.nextEvent), "next event text size");
+  memcpy(r.nextEvent, ui.nextEvent, sizeof(r.nextEvent));
+
+  const SHT3xController::Diagnostics diag = sht.getDiagnostics();
+  const SHT3xController::Reading last = sht.getLastReading();
+  r.shtFlags = static_cast<uint8_t>((diag.present ? kTelemetryShtPresent : 0) |
+                                    (diag.heaterEnabled ? kTelemetryShtHeater : 0) |
+                                    (diag.wetStuck ? kTelemetryShtWetStuck : 0) |
+                                    (diag.condensationFault ? kTelemetryShtCondensation : 0) |
+                                    (diag.mode == SHT3xController::Mode::Periodic ? kTelemetryShtPeriodic : 0) |
+                                    (last.valid ? kTelemetryShtLastValid : 0) |
+                                    (last.heaterInfluenced ? kTelemetryShtLastInfluenced : 0) |
+                                    (last.settling ? kTelemetryShtLastSettling : 0));
+  r.shtAddress = diag.address;
+  r.shtPulsesLastHour = static_cast<uint16_t>(diag.pulsesLastHour);
+  r.shtLastHeaterMs = diag.lastHeaterMs;
+  r.shtSamples = diag.samples;
+  r.shtCrcErrors = diag.crcErrors;
+  r.shtBusErrors = diag.busErrors;
+  r.shtLastTemperatureC = last.temperatureC;
+  r.shtLastHumidity = last.humidity;
+
+  uint8_t record[kTelemetryRecordSize];
+  packTelemetryRecord(r, record);
+
+  // Leading delimiter isolates the frame from any console text before it.
+  uint8_t frame[kTelemetryFrameMax];
+  size_t len = 0;
+  frame[len++] = 0;
+  len += cobsEncode(record, sizeof(record), frame + len);
+  frame[len++] = 0;
+
+  if (out_.write(frame, len) != len) {
+    shortWrites_++;
+  }
+  seq_++;
+  frames_++;
+  lastFrameBytes_ = len;
+}
+
+TelemetryStream::Status TelemetryStream::getStatus() const {
+  return Status{enabled_, rateHz_, seq_, frames_, shortWrites_, lastFrameBytes_};
+}
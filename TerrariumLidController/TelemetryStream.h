@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include "SHT3xController.h"
+#include "TelemetryRecord.h"
+#include "UiState.h"
+
+// Binary telemetry for fleet logging: one COBS-framed TelemetryRecord per
+// send(), written to the console stream with a single write() call. See
+// TelemetryRecord.h for the wire format.
+class TelemetryStream {
+ public:
+  struct Status {
+    bool enabled;
+    uint16_t rateHz;
+    uint32_t nextSeq;
+    unsigned long frames;
+    unsigned long shortWrites;
+    size_t frameBytes;
+  };
+
+  static constexpr uint16_t kMaxRateHz = 50;
+
+  explicit TelemetryStream(Print& out);
+
+  // Accepts 1..kMaxRateHz.
+  bool start(uint16_t rateHz);
+  void stop();
+  bool isEnabled() const;
+  unsigned long periodMs() const;
+  void send(const UiState& ui, const SHT3xController& sht, unsigned long nowMs);
+  Status getStatus() const;
+
+ private:
+  Print& out_;
+  bool enabled_;
+  uint16_t rateHz_;
+  uint32_t seq_;
+  unsigned long frames_;
+  unsigned long shortWrites_;
+  size_t lastFrameBytes_;
+};
@@ -1,11 +1,28 @@
 #include <Wire.h>
+#include <ctype.h>
+#include <esp_system.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "RTClib.h"
+#include "AlertEngine.h"
+#include "ClockService.h"
 #include "ConsoleInterface.h"
 #include "SHT3xController.h"
 #include "DisplayConfig.h"
 #include "DisplayController.h"
+#include "HistoryLog.h"
+#include "I2cBus.h"
+#include "LedDimmer.h"
+#include "LightChannels.h"
+#include "LightSchedule.h"
+#include "LoopProfiler.h"
+#include "PotSampler.h"
+#include "ReportWriter.h"
+#include "SensorRollups.h"
+#include "SolarSchedule.h"
+#include "TaskScheduler.h"
+#include "TelemetryStream.h"
 #include "UiState.h"
 
 // ====================== Pins ======================
@@ -18,26 +35,57 @@ constexpr int I2C_SCL = 9;
 
 // ====================== PWM ======================
 constexpr int PWM_FREQ = 1000;        // Hz
-constexpr int PWM_RESOLUTION = 10;    // bits (0..1023)
+constexpr int PWM_RESOLUTION = LedDimmer::kDutyBits;  // 14 bits (0..16383)
 constexpr int MAX_DUTY = (1 << PWM_RESOLUTION) - 1;
 constexpr int PWM_CHANNEL = 0;
-
-#if defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
-  #define TLC_LEDC_NEW_API 1
-#else
-  #define TLC_LEDC_NEW_API 0
-#endif
+// Schedule ramps are handed to the LEDC fade engine in chunks of this
+// length, each aimed at the CIE-mapped level at its end.
+constexpr uint32_t FADE_CHUNK_S = 10;
+// Knob movement (Q16) that cancels a hardware ramp and retargets it.
+constexpr uint32_t FADE_KNOB_TOLERANCE_Q16 = 655;
 
 // ====================== Brightness behavior ======================
+// The knob and the schedule ramp are perceived brightness; LedDimmer maps
+// their product through the CIE lightness curve to linear duty, capped at
+// MAX_BRIGHTNESS of full duty (the main channel; see LIGHT_CHANNELS).
 constexpr bool INVERT_KNOB = false;
 constexpr float MAX_BRIGHTNESS = 0.70f;
-
-constexpr float FILTER_ALPHA = 0.90f; // 0.85..0.95 typical
-constexpr int DEADZONE_DUTY = 6;
-constexpr int LOOP_DELAY_MS = 10;
+constexpr uint16_t MAX_BRIGHTNESS_Q16 = static_cast<uint16_t>(MAX_BRIGHTNESS * 65535.0f + 0.5f);
+constexpr uint32_t DEADZONE_LEVEL_Q16 = 655;  // knob below 1% of travel switches the light off
+
+// ====================== Knob sampling ======================
+// The pot is sampled continuously by the ADC's DMA engine; the knob value
+// is the mean of the last POT_FILTER_DEPTH medians of 9 samples, which
+// lags the knob by about 9 * depth / (2 * rate), 10 ms with these values.
+constexpr uint32_t POT_SAMPLE_RATE_HZ = 3600;
+constexpr uint8_t POT_FILTER_DEPTH = 8;
+
+// ====================== Task timing ======================
+// Period (ms) and per-run budget (us) for each scheduler task. A run that
+// exceeds its budget is counted as an overrun (see the 'tasks' command).
+constexpr unsigned long LIGHT_TASK_PERIOD_MS = 10;
+constexpr unsigned long LIGHT_TASK_BUDGET_US = 500;
+constexpr unsigned long RTC_TASK_PERIOD_MS = 1000;
+constexpr unsigned long RTC_TASK_BUDGET_US = 2000;
+constexpr unsigned long SHT3X_TASK_PERIOD_MS = 2000;  // matches SHT3xController sample interval
+constexpr unsigned long SHT3X_TASK_BUDGET_US = 5000;
+constexpr unsigned long DISPLAY_TASK_BUDGET_US = 4000;
+constexpr unsigned long DISPLAY_FLUSH_STEP_INTERVAL_MS = 5;  // while a frame is still being sent
+constexpr unsigned long STREAM_TASK_IDLE_PERIOD_MS = 1000;  // while streaming is off
+constexpr unsigned long STREAM_TASK_BUDGET_US = 2000;
+constexpr unsigned long HISTORY_SAMPLE_INTERVAL_MS = 60000;
+constexpr unsigned long HISTORY_TASK_BUDGET_US = 60000;  // a sector erase (~45 ms) every ~10 h
+constexpr unsigned long CONSOLE_TASK_PERIOD_MS = 20;
+constexpr unsigned long CONSOLE_TASK_BUDGET_US = 20000;
+
+// Items the 'history' dump prints per console pass.
+constexpr int HISTORY_DUMP_ITEMS_PER_PASS = 48;
+// Logged days replayed into the rollups at boot (the hourly tier holds 7).
+constexpr uint32_t ROLLUP_SEED_DAYS = 7;
 
 // ====================== Schedule ======================
-// Local schedule according to DS3231 clock time.
+// Default schedule (local DS3231 time), installed until segments are
+// edited with the 'schedule' command and saved to NVS.
 constexpr int ON_HOUR   = 9;          // 09:00
 constexpr int ON_MINUTE = 0;
 constexpr int DURATION_MINUTES = (13 * 60) + 26; // 20 hours (for testing)
@@ -45,143 +93,112 @@ constexpr int DURATION_MINUTES = (13 * 60) + 26; // 20 hours (for testing)
 // Optional: fade in/out (set to 0 for none)
 constexpr int FADE_MINUTES = 10; // sunrise and sunset ramp length
 
+constexpr uint16_t DEFAULT_START_MIN = ON_HOUR * 60 + ON_MINUTE;
+constexpr LightSchedule::Segment DEFAULT_SCHEDULE[] = {
+    {LightSchedule::kAllDays, DEFAULT_START_MIN, FADE_MINUTES, 0, 1000},
+    {LightSchedule::kAllDays, (DEFAULT_START_MIN + FADE_MINUTES) % 1440, DURATION_MINUTES - 2 * FADE_MINUTES, 1000, 1000},
+    {LightSchedule::kAllDays, (DEFAULT_START_MIN + DURATION_MINUTES - FADE_MINUTES) % 1440, FADE_MINUTES, 1000, 0},
+};
+
+// ====================== Light channels ======================
+// One entry per LED string, up to LightChannels::kMaxChannels. Channel 0 is
+// the main string: it follows solar mode and feeds the telemetry and
+// history duty. knobLow/knobHigh map the shared knob onto each channel
+// (equal values make a channel ignore the knob; the knob's deadzone still
+// switches everything off). Extra strings look like:
+//   {"red", 3, 1, 65535, LedDimmer::Curve::Cie, 13107, 65535, "sched1", DEFAULT_SCHEDULE, 3},
+//   {"uv", 4, 2, 32768, LedDimmer::Curve::Linear, 65535, 65535, "sched2", UV_SCHEDULE, 1},
+constexpr LightChannels::Config LIGHT_CHANNELS[] = {
+    {"white", LED_PIN, PWM_CHANNEL, MAX_BRIGHTNESS_Q16, LedDimmer::Curve::Cie, 0, 65535, "sched",
+     DEFAULT_SCHEDULE, sizeof(DEFAULT_SCHEDULE) / sizeof(DEFAULT_SCHEDULE[0])},
+};
+constexpr size_t LIGHT_CHANNEL_COUNT = sizeof(LIGHT_CHANNELS) / sizeof(LIGHT_CHANNELS[0]);
+static_assert(LIGHT_CHANNEL_COUNT <= LightChannels::kMaxChannels, "too many light channels");
+static_assert(LightChannels::kMaxChannels == kUiMaxChannels, "UiState must hold every channel");
+
+I2cBus i2cBus(Wire);
 RTC_DS3231 rtc;
-ConsoleInterface console(Serial, rtc);
+ClockService clockService(rtc, i2cBus);
+ReportWriter report(Serial);
+ConsoleInterface console(Serial, report);
 SHT3xController sht3x;
 DisplayController displayController;
 UiState uiState{};
+TaskScheduler scheduler;
+TelemetryStream telemetry(Serial);
+HistoryLog historyLog;
+LightChannels lights;
+PotSampler potSampler;
+SolarSchedule solar;
+SensorRollups rollups;
+AlertEngine alerts;
+static unsigned long alertSamplesSeen = 0;
+static int rtcTaskId = -1;
+static int sht3xTaskId = -1;
+static int displayTaskId = -1;
+static int streamTaskId = -1;
 static bool forceOn = false;
+static unsigned long scheduleRecomputesSeen = 0;
+// Channel whose schedule the 'schedule' commands show and edit.
+static size_t scheduleChannel = 0;
+static bool historyDumpActive = false;
+static unsigned long historyDumpSamples = 0;
+static unsigned long historyDumpEvents = 0;
+static uint32_t lastRollupUnix = 0;
 static unsigned long displayMaxUpdateUs = 0;
 static unsigned long displayLastUpdateUs = 0;
 static unsigned long displayLastTimingLogMs = 0;
 
-// ====================== Helpers ======================
+void writePwm(int duty);
+void printSht3xStatus(Print& serial);
+void runConsoleTask(unsigned long nowMs);
+void runRtcTask(unsigned long nowMs);
+void runSht3xTask(unsigned long nowMs);
+void runDisplayTask(unsigned long nowMs);
+void runStreamTask(unsigned long nowMs);
+void runHistoryTask(unsigned long nowMs);
+void runLightTask(unsigned long nowMs);
 
-int minutesOfDay(int h, int m) {
-  return h * 60 + m;
-}
+// ====================== Helpers ======================
 
 float cToF(float c) {
   return (c * 9.0f / 5.0f) + 32.0f;
 }
 
-void formatNextEvent(char* out, size_t outSize, bool scheduleAllowed) {
-  int endMin = (minutesOfDay(ON_HOUR, ON_MINUTE) + DURATION_MINUTES) % (24 * 60);
-  if (scheduleAllowed) {
-    int hh = endMin / 60;
-    int mm = endMin % 60;
-    snprintf(out, outSize, "NEXT OFF %02d:%02d", hh, mm);
-  } else {
-    snprintf(out, outSize, "NEXT ON  %02d:%02d", ON_HOUR, ON_MINUTE);
+void formatNextEvent(const LightSchedule& sched, char* out, size_t outSize, uint32_t nowUnix, bool scheduleAllowed) {
+  const uint32_t at = sched.nextOnOffChange(nowUnix);
+  if (at == 0) {
+    snprintf(out, outSize, scheduleAllowed ? "ALWAYS ON" : "NO SCHEDULE");
+    return;
   }
+  const uint32_t minuteOfDay = (at % 86400UL) / 60;
+  snprintf(out, outSize, scheduleAllowed ? "NEXT OFF %02d:%02d" : "NEXT ON  %02d:%02d",
+           static_cast<int>(minuteOfDay / 60), static_cast<int>(minuteOfDay % 60));
 }
 
-void scanI2C() {
-  Serial.println("I2C scan:");
+void printI2cScan(Print& serial) {
+  serial.println("I2C scan:");
   int found = 0;
   for (uint8_t addr = 1; addr < 127; addr++) {
-    Wire.beginTransmission(addr);
-    uint8_t err = Wire.endTransmission();
-    if (err == 0) {
-      Serial.print("  Found device at 0x");
-      if (addr < 16) Serial.print("0");
-      Serial.println(addr, HEX);
+    if (i2cBus.isPresent(addr)) {
+      serial.print("  Found device at ");
+      printHexByte(serial, addr);
+      serial.println();
       found++;
     }
   }
-  if (found == 0) Serial.println("  (no I2C devices found)");
-}
-
-void debugSchedule(
-  Stream& serial,
-  const DateTime& now,
-  int nowMin,
-  int startMin,
-  int durationMin,
-  bool inWindow
-) {
-  int endMin = (startMin + durationMin) % (24 * 60);
-
-  serial.print("[RTC] ");
-  serial.print(now.hour()); serial.print(":");
-  if (now.minute() < 10) serial.print("0");
-  serial.print(now.minute());
-
-  serial.print(" | nowMin=");
-  serial.print(nowMin);
-
-  serial.print(" | window=");
-  serial.print(startMin);
-  serial.print(" -> ");
-  serial.print(endMin);
-
-  serial.print(" (");
-  serial.print(durationMin);
-  serial.print("m)");
-
-  serial.print(" | inWindow=");
-  serial.println(inWindow ? "YES" : "NO");
-}
-
-// Returns true if "nowMin" is inside [startMin, startMin+duration) wrapping midnight.
-bool isInWindow(int nowMin, int startMin, int durationMin) {
-  const int endMin = (startMin + durationMin) % (24 * 60);
-  if (durationMin <= 0) return false;
-  if (startMin == endMin) return true; // 24h or multiple of 24h
-  if (startMin < endMin) {
-    return nowMin >= startMin && nowMin < endMin;
-  } else {
-    // wraps midnight
-    return (nowMin >= startMin) || (nowMin < endMin);
-  }
+  if (found == 0) serial.println("  (no I2C devices found)");
 }
 
-// Compute a fade multiplier [0..1] within the window.
-// Linear fade in first FADE_MINUTES and fade out last FADE_MINUTES.
-float fadeMultiplier(int nowMin, int startMin, int durationMin, int fadeMin) {
-  if (fadeMin <= 0) return 1.0f;
-  if (fadeMin * 2 >= durationMin) return 1.0f; // avoid weird overlap
-
-  // Compute minutes since window start in [0..durationMin)
-  int sinceStart = nowMin - startMin;
-  if (sinceStart < 0) sinceStart += 24 * 60; // handle wrap
-
-  int untilEnd = durationMin - sinceStart;
-
-  if (sinceStart < fadeMin) {
-    return sinceStart / float(fadeMin);
-  }
-  if (untilEnd < fadeMin) {
-    return untilEnd / float(fadeMin);
-  }
-  return 1.0f;
-}
-
-void printStatus(Stream& serial) {
+void printStatus(Print& serial) {
   serial.print("rtc=");
-  serial.print(uiState.rtcNow.year());
-  serial.print('-');
-  if (uiState.rtcNow.month() < 10) serial.print('0');
-  serial.print(uiState.rtcNow.month());
-  serial.print('-');
-  if (uiState.rtcNow.day() < 10) serial.print('0');
-  serial.print(uiState.rtcNow.day());
-  serial.print(' ');
-  if (uiState.rtcNow.hour() < 10) serial.print('0');
-  serial.print(uiState.rtcNow.hour());
-  serial.print(':');
-  if (uiState.rtcNow.minute() < 10) serial.print('0');
-  serial.print(uiState.rtcNow.minute());
-  serial.print(':');
-  if (uiState.rtcNow.second() < 10) serial.print('0');
-  serial.print(uiState.rtcNow.second());
-  serial.print(' ');
-  serial.print("raw="); serial.print(uiState.rawPot);
-  serial.print(" x="); serial.print(uiState.potScaled, 3);
-  serial.print(" filtered="); serial.print(uiState.potFiltered, 3);
+  printIsoDateTime(serial, uiState.rtcNow);
+  serial.print(" raw="); serial.print(uiState.rawPot);
+  serial.print(" x="); printFixed(serial, uiState.potScaledQ16 / 65535.0f, 3);
+  serial.print(" filtered="); printFixed(serial, uiState.potFilteredQ16 / 65535.0f, 3);
   serial.print(" allowed="); serial.print(uiState.scheduleAllowed ? "Y" : "N");
   serial.print(" forced="); serial.print(uiState.forceOn ? "Y" : "N");
-  serial.print(" gate="); serial.print(uiState.gate, 3);
+  serial.print(" gate="); printFixed(serial, uiState.gateQ16 / 65536.0f, 3);
   serial.print(" duty="); serial.print(uiState.duty);
   serial.print(" mode=");
   if (uiState.controlMode == ControlMode::Override) serial.print("OVR");
@@ -191,39 +208,167 @@ void printStatus(Stream& serial) {
   serial.println(uiState.nextEvent);
 }
 
-void printPot(Stream& serial) {
+void printPot(Print& serial) {
+  const PotSampler::Status st = potSampler.getStatus();
   serial.print("pot=");
   serial.print(uiState.rawPot);
   serial.print(" norm=");
-  serial.print(uiState.potNorm, 3);
+  printFixed(serial, uiState.potNormQ16 / 65535.0f, 3);
   serial.print(" scaled=");
-  serial.print(uiState.potScaled, 3);
+  printFixed(serial, uiState.potScaledQ16 / 65535.0f, 3);
   serial.print(" filtered=");
-  serial.println(uiState.potFiltered, 3);
+  printFixed(serial, uiState.potFilteredQ16 / 65535.0f, 3);
+  serial.println();
+  serial.print("adc=");
+  serial.print(st.continuous ? "dma" : "burst");
+  if (st.continuous) {
+    serial.print(" rate=");
+    serial.print(st.sampleRateHz);
+    serial.print("Hz");
+  }
+  serial.print(" depth=");
+  serial.print(st.depth);
+  serial.print(" last=");
+  serial.print(st.lastSample);
+  serial.print(" spread=");
+  serial.print(st.blockSpread);
+  serial.print(" samples=");
+  serial.print(st.samples);
+  serial.print(" medians=");
+  serial.print(st.medians);
+  if (st.continuous) {
+    serial.print(" latency=");
+    serial.print(potSampler.getLatencyUs() / 1000UL);
+    serial.print("ms");
+  }
+  serial.println();
 }
 
-void printDebug(Stream& serial) {
-  DateTime now = rtc.now();
-  int nowMin = minutesOfDay(now.hour(), now.minute());
-  int startMin = minutesOfDay(ON_HOUR, ON_MINUTE);
-  bool allowed = isInWindow(nowMin, startMin, DURATION_MINUTES);
+void printClockMinute(Print& serial, uint32_t unixTime) {
+  const uint32_t minuteOfDay = (unixTime % 86400UL) / 60;
+  serial.print(minuteOfDay / 600);
+  serial.print((minuteOfDay / 60) % 10);
+  serial.print(':');
+  serial.print((minuteOfDay % 60) / 10);
+  serial.print(minuteOfDay % 10);
+}
+
+void printDebug(Print& serial) {
+  const uint32_t nowUnix = clockService.now().unixtime();
+  LightSchedule& sched = lights.schedule(scheduleChannel);
+  LightSchedule::State state = sched.evaluate(nowUnix);
+  LightSchedule::Span span = sched.getSpan();
+  LightSchedule::Status st = sched.getStatus();
+
+  serial.print("[RTC] ");
+  printClockMinute(serial, nowUnix);
+  serial.print(" | segment=");
+  serial.print(state.segment);
+  serial.print(" level=");
+  printFixed(serial, state.levelQ16 / 65536.0f, 3);
+  serial.print(" | span until ");
+  printClockMinute(serial, span.untilUnix);
+  serial.print(" | evals=");
+  serial.print(st.evaluations);
+  serial.print(" recomputes=");
+  serial.print(st.recomputes);
+  serial.print(" | inWindow=");
+  serial.println(state.active ? "YES" : "NO");
+
+  const unsigned long nowMs = millis();
+  for (size_t i = 0; i < lights.getCount(); ++i) {
+    const PwmOutput& out = lights.output(i);
+    PwmOutput::Stats pwm = out.getStats();
+    serial.print("[PWM ");
+    serial.print(lights.getConfig(i).name);
+    serial.print("] duty=");
+    serial.print(out.getDuty(nowMs));
+    serial.print(" fading=");
+    serial.print(out.isFading(nowMs) ? "YES" : "NO");
+    serial.print(" (");
+    serial.print(out.fadeRemainingMs(nowMs));
+    serial.print(" ms left) | writes=");
+    serial.print(pwm.writes);
+    serial.print(" fades=");
+    serial.print(pwm.fades);
+    serial.print(" stopped=");
+    serial.print(pwm.fadeStops);
+    serial.println(PwmOutput::kHardwareFade ? "" : " | no hardware fade (Arduino-ESP32 2.x)");
+  }
+}
+
+void printScheduleDays(Print& serial, uint8_t days) {
+  static const char kLetters[] = "SMTWTFS";
+  char text[8];
+  for (int d = 0; d < 7; ++d) {
+    text[d] = (days & (1u << d)) ? kLetters[d] : '-';
+  }
+  text[7] = '\0';
+  serial.print(text);
+}
 
-  debugSchedule(serial, now, nowMin, startMin, DURATION_MINUTES, allowed);
+void printSchedule(Print& serial) {
+  const uint32_t nowUnix = clockService.now().unixtime();
+  LightSchedule& sched = lights.schedule(scheduleChannel);
+  LightSchedule::State state = sched.evaluate(nowUnix);
+  LightSchedule::Status st = sched.getStatus();
+  serial.print("Schedule");
+  if (lights.getCount() > 1) {
+    serial.print(" [");
+    serial.print(lights.getConfig(scheduleChannel).name);
+    serial.print("]");
+  }
+  serial.print(": ");
+  serial.print(static_cast<unsigned long>(st.segments));
+  serial.print(" segments (");
+  serial.print(sched.hasDaySegments() ? "solar" : (st.stored ? "NVS" : "defaults"));
+  serial.print(") now ");
+  if (state.active) {
+    serial.print("segment ");
+    serial.print(state.segment);
+    serial.print(" at ");
+    printFixed(serial, state.levelQ16 * (100.0f / 65536.0f), 1);
+    serial.print("%");
+  } else {
+    serial.print("off");
+  }
+  char nextEvent[sizeof(uiState.nextEvent)];
+  formatNextEvent(sched, nextEvent, sizeof(nextEvent), nowUnix, state.active);
+  serial.print(", ");
+  serial.println(nextEvent);
+  for (size_t i = 0; i < sched.getSegmentCount(); ++i) {
+    const LightSchedule::Segment& seg = sched.getSegment(i);
+    serial.print("  ");
+    serial.print(static_cast<unsigned long>(i));
+    serial.print(' ');
+    printScheduleDays(serial, seg.days);
+    serial.print(' ');
+    printClockMinute(serial, seg.startMin * 60UL);
+    serial.print(" +");
+    serial.print(seg.durationMin);
+    serial.print("m ");
+    printFixed(serial, seg.fromLevel / 10.0f, 1);
+    serial.print("% -> ");
+    printFixed(serial, seg.toLevel / 10.0f, 1);
+    serial.println("%");
+  }
 }
 
-void handleForceOn(Stream& serial) {
+void handleForceOn(Print& serial, const char* args) {
+  (void)args;
   forceOn = true;
   uiState.forceOn = true;
   serial.println("Force on enabled (schedule overridden). Use 'forceOff' to return to schedule.");
 }
 
-void handleForceOff(Stream& serial) {
+void handleForceOff(Print& serial, const char* args) {
+  (void)args;
   forceOn = false;
   uiState.forceOn = false;
   serial.println("Force on disabled. Schedule timing re-enabled.");
 }
 
-void printSht3xStatus(Stream& serial) {
+void printSht3xStatus(Print& serial) {
   if (!sht3x.isPresent()) {
     serial.println("SHT3x: not detected");
     return;
@@ -233,9 +378,8 @@ void printSht3xStatus(Stream& serial) {
   SHT3xController::Reading trusted = sht3x.getLastTrustedReading();
   SHT3xController::Diagnostics diag = sht3x.getDiagnostics();
 
-  serial.print("SHT3x addr=0x");
-  if (diag.address < 16) serial.print("0");
-  serial.print(diag.address, HEX);
+  serial.print("SHT3x addr=");
+  printHexByte(serial, diag.address);
   serial.print(" heater=");
   serial.print(diag.heaterEnabled ? "Y" : "N");
   serial.print(" wetStuck=");
@@ -244,6 +388,14 @@ void printSht3xStatus(Stream& serial) {
   serial.print(diag.pulsesLastHour);
   serial.print(" condensationFault=");
   serial.println(diag.condensationFault ? "Y" : "N");
+  serial.print("mode=");
+  serial.print(diag.mode == SHT3xController::Mode::Periodic ? "ART" : "SINGLE");
+  serial.print(" samples=");
+  serial.print(diag.samples);
+  serial.print(" crcErrors=");
+  serial.print(diag.crcErrors);
+  serial.print(" busErrors=");
+  serial.println(diag.busErrors);
 
   serial.print("last valid=");
   serial.print(last.valid ? "Y" : "N");
@@ -252,17 +404,17 @@ void printSht3xStatus(Stream& serial) {
   serial.print(" settling=");
   serial.print(last.settling ? "Y" : "N");
   serial.print(" T=");
-  serial.print(cToF(last.temperatureC), 2);
+  printFixed(serial, cToF(last.temperatureC), 2);
   serial.print("F RH=");
-  serial.print(last.humidity, 2);
+  printFixed(serial, last.humidity, 2);
   serial.println("%");
 
   serial.print("trusted valid=");
   serial.print(trusted.valid ? "Y" : "N");
   serial.print(" T=");
-  serial.print(cToF(trusted.temperatureC), 2);
+  printFixed(serial, cToF(trusted.temperatureC), 2);
   serial.print("F RH=");
-  serial.print(trusted.humidity, 2);
+  printFixed(serial, trusted.humidity, 2);
   serial.println("%");
 
   size_t count = sht3x.getHeaterEventCount();
@@ -275,47 +427,30 @@ void printSht3xStatus(Stream& serial) {
   for (size_t i = 0; i < count; ++i) {
     SHT3xController::HeaterEvent ev = sht3x.getHeaterEvent(i);
     serial.print("  ");
-    serial.print(ev.timestamp.year());
-    serial.print("-");
-    if (ev.timestamp.month() < 10) serial.print("0");
-    serial.print(ev.timestamp.month());
-    serial.print("-");
-    if (ev.timestamp.day() < 10) serial.print("0");
-    serial.print(ev.timestamp.day());
-    serial.print(" ");
-    if (ev.timestamp.hour() < 10) serial.print("0");
-    serial.print(ev.timestamp.hour());
-    serial.print(":");
-    if (ev.timestamp.minute() < 10) serial.print("0");
-    serial.print(ev.timestamp.minute());
-    serial.print(":");
-    if (ev.timestamp.second() < 10) serial.print("0");
-    serial.print(ev.timestamp.second());
+    printIsoDateTime(serial, ev.timestamp);
     serial.print(" dur=");
     serial.print(ev.durationMs);
     serial.print("ms reason=");
     serial.print(ev.reason ? ev.reason : "unknown");
     serial.print(" RH=");
-    serial.print(ev.rhBefore, 2);
+    printFixed(serial, ev.rhBefore, 2);
     serial.print("->");
-    serial.print(ev.rhAfter, 2);
+    printFixed(serial, ev.rhAfter, 2);
     serial.print(" T=");
-    serial.print(cToF(ev.tempBeforeC), 2);
+    printFixed(serial, cToF(ev.tempBeforeC), 2);
     serial.print("->");
-    serial.print(cToF(ev.tempAfterC), 2);
+    printFixed(serial, cToF(ev.tempAfterC), 2);
     serial.println();
   }
 }
 
-void printDisplayStatus(Stream& serial) {
+void printDisplayStatus(Print& serial) {
   DisplayController::Status st = displayController.getStatus();
   serial.print("Display: ");
   serial.print(st.present ? "present" : "missing");
   serial.print(" addr=");
   if (st.present) {
-    serial.print("0x");
-    if (st.address < 16) serial.print("0");
-    serial.print(st.address, HEX);
+    printHexByte(serial, st.address);
   } else {
     serial.print("--");
   }
@@ -329,6 +464,13 @@ void printDisplayStatus(Stream& serial) {
   serial.print(st.enabled ? "on" : "off");
   serial.print(" dim=");
   serial.print(st.dimmed ? "yes" : "no");
+  serial.print(" screen=");
+  serial.print(DisplayController::screenName(st.screen));
+  if (st.autoRotate) {
+    serial.print("(auto ");
+    serial.print(st.rotateIntervalMs / 1000UL);
+    serial.print("s)");
+  }
   serial.print(" timeoutDimMin=");
   serial.print(st.dimTimeoutMin);
   serial.print(" timeoutOffMin=");
@@ -336,111 +478,1133 @@ void printDisplayStatus(Stream& serial) {
   serial.print(" updateUs(last/max)=");
   serial.print(displayLastUpdateUs);
   serial.print("/");
-  serial.println(displayMaxUpdateUs);
+  serial.print(displayMaxUpdateUs);
+  serial.print(" flushUs(last/max)=");
+  serial.print(st.lastFlushUs);
+  serial.print("/");
+  serial.print(st.maxFlushUs);
+  serial.print(" stepUsMax=");
+  serial.print(st.maxStepUs);
+  serial.print(" frameLatencyMs(last/max)=");
+  serial.print(st.lastFrameLatencyMs);
+  serial.print("/");
+  serial.print(st.maxFrameLatencyMs);
+  serial.print(" flushBytes(last)=");
+  serial.print(st.lastFlushBytes);
+  serial.print(" pages=");
+  serial.print(st.lastFlushPages);
+  serial.print(" steps=");
+  serial.print(st.lastFlushSteps);
+  if (st.flushPending) serial.print(" (flushing)");
+  serial.print(" flushes=");
+  serial.print(st.flushCount);
+  serial.print(" avgBytes=");
+  serial.println(st.flushCount > 0 ? st.totalFlushBytes / st.flushCount : 0UL);
+}
+
+void printTasks(Print& serial) {
+  serial.println("task      periodMs budgetUs     runs overruns  lastUs   maxUs lateMaxMs");
+  for (size_t i = 0; i < scheduler.getTaskCount(); ++i) {
+    TaskScheduler::TaskStats st = scheduler.getTaskStats(i);
+    char line[80];
+    snprintf(line, sizeof(line), "%-8s %9lu %8lu %8lu %8lu %7lu %7lu %9lu", st.name, st.periodMs, st.budgetUs,
+             st.runs, st.overruns, st.lastRunUs, st.maxRunUs, st.maxLateMs);
+    serial.println(line);
+  }
+  serial.print("sleptMs=");
+  serial.print(scheduler.getSleptMs());
+  serial.print(" uptimeMs=");
+  serial.println(millis());
+}
+
+void printHeap(Print& serial) {
+  serial.print("heap: free=");
+  serial.print(ESP.getFreeHeap());
+  serial.print(" minFree=");
+  serial.print(ESP.getMinFreeHeap());
+  serial.print(" largestBlock=");
+  serial.print(ESP.getMaxAllocHeap());
+  serial.print(" size=");
+  serial.println(ESP.getHeapSize());
+}
+
+void printI2cStats(Print& serial) {
+  char line[112];
+  serial.print("I2C: clock=");
+  serial.print(i2cBus.getClock() / 1000UL);
+  serial.print("kHz maxSafe=");
+  serial.print(i2cBus.maxSafeClockHz() / 1000UL);
+  serial.print("kHz queued=");
+  serial.print(i2cBus.pendingCount());
+  serial.print(" coalesced=");
+  serial.println(i2cBus.getCoalescedWrites());
+  serial.println("addr  txn      bytes     nack  maxUs  <100 <250 <500  <1m <2.5m  <5m  >=5m");
+  for (size_t i = 0; i < i2cBus.getDeviceCount(); ++i) {
+    I2cBus::DeviceStats st = i2cBus.getDeviceStats(i);
+    snprintf(line, sizeof(line), "0x%02X %-8lu %-9lu %-5lu %-6lu %4lu %4lu %4lu %4lu %5lu %4lu %5lu", st.address,
+             st.transactions, st.bytes, st.nacks, st.maxLatencyUs, st.latency[0], st.latency[1], st.latency[2],
+             st.latency[3], st.latency[4], st.latency[5], st.latency[6]);
+    serial.println(line);
+  }
 }
 
-void handleDisplayCommand(Stream& serial, const char* args) {
-  if (args == nullptr || *args == '\0') {
-    serial.println("Usage: display status | display on|off|dim | display flip [on|off] | display timeout dim|off <min> | display test");
+// ====================== Console commands ======================
+
+void cmdNow(Print& serial, const char* args) {
+  (void)args;
+  DateTime now = clockService.now();
+
+  serial.print("DS3231 datetime: ");
+  printIsoDateTime(serial, now);
+  serial.println();
+}
+
+bool parseDateTime(const char* args, DateTime& out) {
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+
+  int parsed = sscanf(args, "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+  if (parsed != 6) {
+    parsed = sscanf(args, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+  }
+  if (parsed != 6) {
+    return false;
+  }
+
+  if (year < 2000 || year > 2099) return false;
+  if (month < 1 || month > 12) return false;
+  if (day < 1 || day > 31) return false;
+  if (hour < 0 || hour > 23) return false;
+  if (minute < 0 || minute > 59) return false;
+  if (second < 0 || second > 59) return false;
+
+  out = DateTime(year, month, day, hour, minute, second);
+  return true;
+}
+
+void cmdSetTime(Print& serial, const char* args) {
+  DateTime dt;
+  if (*args == '\0' || !parseDateTime(args, dt)) {
+    serial.println("Usage:");
+    serial.println("  settime YYYY-MM-DD HH:MM:SS");
+    serial.println("  settime YYYY-MM-DDTHH:MM:SS");
     return;
   }
 
-  if (strncmp(args, "status", 6) == 0 && (args[6] == '\0' || args[6] == ' ')) {
-    printDisplayStatus(serial);
+  clockService.adjust(dt);
+  serial.println("RTC updated.");
+  cmdNow(serial, "");
+}
+
+void cmdClock(Print& serial, const char* args) {
+  (void)args;
+  ClockService::Status st = clockService.getStatus();
+  if (!st.valid) {
+    serial.println("Clock: not synced");
     return;
   }
+  serial.print("Clock: synced ");
+  serial.print(st.msSinceSync / 1000UL);
+  serial.print("s ago, resync every ");
+  serial.print(ClockService::kResyncIntervalMs / 1000UL);
+  serial.println("s");
+  serial.print("  rtcReads=");
+  serial.print(st.rtcReads);
+  serial.print(" readErrors=");
+  serial.print(st.readErrors);
+  serial.print(" resyncs=");
+  serial.print(st.resyncs);
+  serial.print(" corrections=");
+  serial.print(st.corrections);
+  serial.print(" lastError=");
+  serial.print(st.lastErrorS);
+  serial.print("s drift=");
+  printFixed(serial, st.driftPpm, 1);
+  serial.println("ppm");
+}
 
-  if (strncmp(args, "flip", 4) == 0 && (args[4] == '\0' || args[4] == ' ')) {
-    const char* p = args + 4;
-    while (*p == ' ') ++p;
+void cmdSchedule(Print& serial, const char* args) {
+  (void)args;
+  printSchedule(serial);
+}
 
-    if (*p == '\0') {
-      displayController.toggleFlip();
-      DisplayController::Status st = displayController.getStatus();
-      serial.print("Display orientation: ");
-      serial.print(st.flipped ? "INVERTED" : "NORMAL");
-      serial.println(" (saved)");
+void printChannels(Print& serial) {
+  const unsigned long nowMs = millis();
+  for (size_t i = 0; i < lights.getCount(); ++i) {
+    const LightChannels::Config& cfg = lights.getConfig(i);
+    const LightChannels::ChannelState st = lights.getState(i, nowMs);
+    serial.print(i == scheduleChannel ? "* " : "  ");
+    serial.print(static_cast<unsigned long>(i));
+    serial.print(' ');
+    serial.print(cfg.name);
+    serial.print(" pin=");
+    serial.print(cfg.pin);
+    serial.print(" ledc=");
+    serial.print(cfg.ledcChannel);
+    serial.print(cfg.curve == LedDimmer::Curve::Cie ? " cie" : " linear");
+    serial.print(" max=");
+    printFixed(serial, cfg.ceilingQ16 * 100.0f / 65535.0f, 1);
+    serial.print("% knob=");
+    printFixed(serial, cfg.knobLowQ16 * 100.0f / 65535.0f, 0);
+    serial.print("..");
+    printFixed(serial, cfg.knobHighQ16 * 100.0f / 65535.0f, 0);
+    serial.print("% | ");
+    serial.print(static_cast<unsigned long>(lights.schedule(i).getSegmentCount()));
+    serial.print(" segments, ");
+    serial.print(st.allowed ? "on" : "off");
+    serial.print(" level=");
+    printFixed(serial, st.levelQ16 * 100.0f / 65535.0f, 1);
+    serial.print("% duty=");
+    serial.print(st.duty);
+    serial.println(st.fading ? " (fading)" : "");
+  }
+}
+
+void cmdChannel(Print& serial, const char* args) {
+  while (*args == ' ') ++args;
+  if (*args != '\0') {
+    char* end = nullptr;
+    const long index = strtol(args, &end, 10);
+    if (end == args || index < 0 || static_cast<size_t>(index) >= lights.getCount()) {
+      serial.print("Usage: channel [0..");
+      serial.print(static_cast<unsigned long>(lights.getCount() - 1));
+      serial.println("]");
       return;
     }
+    scheduleChannel = static_cast<size_t>(index);
+    serial.print("'schedule' now edits channel ");
+    serial.println(lights.getConfig(scheduleChannel).name);
+  }
+  printChannels(serial);
+}
 
-    if (strcmp(p, "on") == 0) {
-      displayController.setFlip(true);
-      serial.println("Display orientation: INVERTED (saved)");
-      return;
+bool parseScheduleDays(const char* text, size_t len, uint8_t& days) {
+  if (len == 5 && strncmp(text, "daily", 5) == 0) {
+    days = LightSchedule::kAllDays;
+    return true;
+  }
+  if (len == 8 && strncmp(text, "weekdays", 8) == 0) {
+    days = 0x3E;
+    return true;
+  }
+  if (len == 8 && strncmp(text, "weekends", 8) == 0) {
+    days = 0x41;
+    return true;
+  }
+  // Sunday-first mask such as "-MTWTF-"; '-' marks an off day.
+  if (len != 7) {
+    return false;
+  }
+  days = 0;
+  for (size_t d = 0; d < 7; ++d) {
+    if (text[d] != '-') {
+      days |= static_cast<uint8_t>(1u << d);
     }
+  }
+  return days != 0;
+}
 
-    if (strcmp(p, "off") == 0) {
-      displayController.setFlip(false);
-      serial.println("Display orientation: NORMAL (saved)");
-      return;
+bool parsePermille(const char* text, uint16_t& out) {
+  char* end = nullptr;
+  const double percent = strtod(text, &end);
+  if (end == text || percent < 0.0 || percent > 100.0) {
+    return false;
+  }
+  out = static_cast<uint16_t>(percent * 10.0 + 0.5);
+  return true;
+}
+
+// The main channel's clock schedule is shadowed while solar mode is on,
+// so edits would be invisible.
+bool scheduleEditable(Print& serial) {
+  if (scheduleChannel == 0 && solar.getConfig().enabled) {
+    serial.println("Solar mode is on; 'schedule solar off' to edit the clock schedule");
+    return false;
+  }
+  return true;
+}
+
+void cmdScheduleAdd(Print& serial, const char* args) {
+  if (!scheduleEditable(serial)) {
+    return;
+  }
+  char daysText[9] = {0};
+  char startText[6] = {0};
+  char fromText[8] = {0};
+  char toText[8] = {0};
+  int duration = 0;
+  const int fields = sscanf(args, "%8s %5s %d %7s %7s", daysText, startText, &duration, fromText, toText);
+  LightSchedule::Segment seg{};
+  int hh = -1;
+  int mm = -1;
+  const bool ok = fields >= 4 && parseScheduleDays(daysText, strlen(daysText), seg.days) &&
+                  sscanf(startText, "%d:%d", &hh, &mm) == 2 && hh >= 0 && hh < 24 && mm >= 0 && mm < 60 &&
+                  duration >= 1 && duration <= 1440 && parsePermille(fromText, seg.fromLevel) &&
+                  (fields < 5 || parsePermille(toText, seg.toLevel));
+  if (!ok) {
+    serial.println("Usage: schedule add <daily|weekdays|weekends|SMTWTFS> <HH:MM> <minutes> <from%> [to%]");
+    return;
+  }
+  seg.startMin = static_cast<uint16_t>(hh * 60 + mm);
+  seg.durationMin = static_cast<uint16_t>(duration);
+  if (fields < 5) {
+    seg.toLevel = seg.fromLevel;
+  }
+  if (!lights.schedule(scheduleChannel).addSegment(seg)) {
+    serial.print("Schedule full (");
+    serial.print(static_cast<unsigned long>(LightSchedule::kMaxSegments));
+    serial.println(" segments)");
+    return;
+  }
+  printSchedule(serial);
+}
+
+void cmdScheduleClear(Print& serial, const char* args) {
+  (void)args;
+  if (!scheduleEditable(serial)) {
+    return;
+  }
+  lights.schedule(scheduleChannel).setSegments(nullptr, 0);
+  printSchedule(serial);
+}
+
+void cmdScheduleDel(Print& serial, const char* args) {
+  if (!scheduleEditable(serial)) {
+    return;
+  }
+  char* end = nullptr;
+  const long index = strtol(args, &end, 10);
+  if (end == args || index < 0 || !lights.schedule(scheduleChannel).removeSegment(static_cast<size_t>(index))) {
+    serial.println("Usage: schedule del <index>");
+    return;
+  }
+  printSchedule(serial);
+}
+
+void cmdScheduleReset(Print& serial, const char* args) {
+  (void)args;
+  if (!scheduleEditable(serial)) {
+    return;
+  }
+  const LightChannels::Config& cfg = lights.getConfig(scheduleChannel);
+  lights.schedule(scheduleChannel).setSegments(cfg.defaults, cfg.defaultCount);
+  printSchedule(serial);
+}
+
+// Solar mode drives the main channel only.
+void applySolarSchedule() {
+  if (!solar.getConfig().enabled) {
+    lights.schedule(0).clearDaySegments();
+    return;
+  }
+  LightSchedule::Segment segments[LightSchedule::kMaxDaySegments];
+  const size_t count = solar.buildSegments(segments, LightSchedule::kMaxDaySegments);
+  lights.schedule(0).setDaySegments(segments, count);
+}
+
+void printSolar(Print& serial) {
+  SolarSchedule::Config cfg = solar.getConfig();
+  SolarSchedule::Status st = solar.getStatus();
+  serial.print("Solar: ");
+  serial.print(cfg.enabled ? "on" : "off");
+  serial.print(" lat=");
+  printFixed(serial, cfg.latitude, 4);
+  serial.print(" lon=");
+  printFixed(serial, cfg.longitude, 4);
+  serial.print(" utcOffsetMin=");
+  serial.println(cfg.utcOffsetMin);
+  if (!st.haveDay) {
+    return;
+  }
+  const SolarDay& day = solar.getDay();
+  serial.print("  day ");
+  serial.print(st.dayOfYear);
+  serial.print(st.fromTable ? " (table): " : " (computed): ");
+  if (day.kind == SolarDayKind::PolarDay) {
+    serial.println("sun never sets");
+  } else if (day.kind == SolarDayKind::PolarNight) {
+    serial.println("sun never rises");
+  } else {
+    serial.print("dawn ");
+    printClockMinute(serial, day.dawnMin * 60UL);
+    serial.print(" sunrise ");
+    printClockMinute(serial, day.sunriseMin * 60UL);
+    serial.print(" sunset ");
+    printClockMinute(serial, day.sunsetMin * 60UL);
+    serial.print(" dusk ");
+    printClockMinute(serial, day.duskMin * 60UL);
+    serial.println();
+  }
+}
+
+void cmdScheduleSolar(Print& serial, const char* args) {
+  (void)args;
+  printSolar(serial);
+}
+
+void cmdScheduleSolarOn(Print& serial, const char* args) {
+  (void)args;
+  solar.setEnabled(true);
+  if (solar.update(clockService.now())) {
+    applySolarSchedule();
+  }
+  printSolar(serial);
+  printSchedule(serial);
+}
+
+void cmdScheduleSolarOff(Print& serial, const char* args) {
+  (void)args;
+  solar.setEnabled(false);
+  if (solar.update(clockService.now())) {
+    applySolarSchedule();
+  }
+  printSchedule(serial);
+}
+
+void cmdScheduleSolarSet(Print& serial, const char* args) {
+  float latitude = 0.0f;
+  float longitude = 0.0f;
+  int utcOffsetMin = 0;
+  if (sscanf(args, "%f %f %d", &latitude, &longitude, &utcOffsetMin) != 3 ||
+      !solar.setLocation(latitude, longitude, utcOffsetMin)) {
+    serial.println("Usage: schedule solar set <lat> <lon> <utcOffsetMin> (north/east positive)");
+    return;
+  }
+  if (solar.update(clockService.now())) {
+    applySolarSchedule();
+  }
+  printSolar(serial);
+}
+
+void printAlerts(Print& serial) {
+  const AlertEngine::Config cfg = alerts.getConfig();
+  const AlertEngine::Status st = alerts.getStatus();
+  serial.print("Alerts:");
+  for (size_t i = 0; i < AlertEngine::kAlertCount; ++i) {
+    serial.print(' ');
+    serial.print(AlertEngine::alertName(static_cast<AlertEngine::Alert>(i)));
+    serial.print(st.active[i] ? "=ON" : "=off");
+    if (st.pending[i] > 0) {
+      serial.print(" (");
+      serial.print(st.pending[i]);
+      serial.print('/');
+      serial.print(cfg.debounceSamples);
+      serial.print(')');
     }
   }
+  serial.print(" usb power limited=");
+  serial.println(uiState.usbPowerLimited ? "YES (brownout reset)" : "no");
+  serial.print("  cold <");
+  printFixed(serial, cfg.coldF, 1);
+  serial.print("F hot >");
+  printFixed(serial, cfg.hotF, 1);
+  serial.print("F dry <");
+  printFixed(serial, cfg.dryPercent, 1);
+  serial.print("%RH hysteresis ");
+  printFixed(serial, cfg.hysteresisF, 1);
+  serial.print("F ");
+  printFixed(serial, cfg.hysteresisPercent, 1);
+  serial.print("%RH debounce ");
+  serial.print(cfg.debounceSamples);
+  serial.println(" samples");
+  serial.print("  evaluations=");
+  serial.print(st.evaluations);
+  serial.print(" changes=");
+  serial.println(st.changes);
+}
+
+void cmdAlerts(Print& serial, const char* args) {
+  (void)args;
+  printAlerts(serial);
+}
+
+void setAlertThreshold(Print& serial, const char* args, AlertEngine::Alert alert, const char* usage) {
+  float value = 0.0f;
+  if (sscanf(args, "%f", &value) != 1 || !alerts.setThreshold(alert, value)) {
+    serial.println(usage);
+    return;
+  }
+  printAlerts(serial);
+}
+
+void cmdAlertsCold(Print& serial, const char* args) {
+  setAlertThreshold(serial, args, AlertEngine::Alert::TooCold, "Usage: alerts cold <F> (below the hot threshold)");
+}
+
+void cmdAlertsHot(Print& serial, const char* args) {
+  setAlertThreshold(serial, args, AlertEngine::Alert::TooHot, "Usage: alerts hot <F> (above the cold threshold)");
+}
+
+void cmdAlertsDry(Print& serial, const char* args) {
+  setAlertThreshold(serial, args, AlertEngine::Alert::NeedsWatering, "Usage: alerts dry <%RH> (0..100)");
+}
+
+void cmdAlertsHysteresis(Print& serial, const char* args) {
+  float degreesF = 0.0f;
+  float percent = 0.0f;
+  if (sscanf(args, "%f %f", &degreesF, &percent) != 2 || !alerts.setHysteresis(degreesF, percent)) {
+    serial.println("Usage: alerts hysteresis <F 0..20> <%RH 0..50>");
+    return;
+  }
+  printAlerts(serial);
+}
+
+void cmdAlertsDebounce(Print& serial, const char* args) {
+  const int samples = atoi(args);
+  if (samples < 1 || samples > AlertEngine::kMaxDebounceSamples ||
+      !alerts.setDebounce(static_cast<uint8_t>(samples))) {
+    serial.print("Usage: alerts debounce <samples 1..");
+    serial.print(AlertEngine::kMaxDebounceSamples);
+    serial.println(">");
+    return;
+  }
+  printAlerts(serial);
+}
+
+void cmdStatus(Print& serial, const char* args) {
+  (void)args;
+  printStatus(serial);
+}
+
+void cmdPot(Print& serial, const char* args) {
+  (void)args;
+  printPot(serial);
+}
+
+void cmdDebug(Print& serial, const char* args) {
+  (void)args;
+  printDebug(serial);
+}
+
+void cmdTasks(Print& serial, const char* args) {
+  (void)args;
+  printTasks(serial);
+}
+
+void cmdHeap(Print& serial, const char* args) {
+  (void)args;
+  printHeap(serial);
+}
+
+void cmdSht3xStatus(Print& serial, const char* args) {
+  (void)args;
+  printSht3xStatus(serial);
+}
+
+void cmdSht3xMode(Print& serial, const char* args) {
+  (void)args;
+  serial.print("SHT3x mode: ");
+  serial.println(sht3x.getMode() == SHT3xController::Mode::Periodic ? "ART" : "SINGLE");
+  serial.println("Usage: sht3x mode single|art");
+}
+
+void cmdSht3xModeArt(Print& serial, const char* args) {
+  (void)args;
+  sht3x.setMode(SHT3xController::Mode::Periodic);
+  serial.println("SHT3x mode: ART (periodic 4 Hz)");
+}
+
+void cmdSht3xModeSingle(Print& serial, const char* args) {
+  (void)args;
+  sht3x.setMode(SHT3xController::Mode::SingleShot);
+  serial.println("SHT3x mode: SINGLE (single-shot)");
+}
+
+void cmdDisplayUsage(Print& serial, const char* args) {
+  (void)args;
+  serial.println("Usage: display status | display on|off|dim | display flip [on|off] | display screen [auto [sec]|<name>] | display timeout dim|off <min> | display test");
+}
+
+void cmdDisplayStatus(Print& serial, const char* args) {
+  (void)args;
+  printDisplayStatus(serial);
+}
+
+void cmdDisplayFlip(Print& serial, const char* args) {
+  if (*args != '\0') {
+    cmdDisplayUsage(serial, args);
+    return;
+  }
+  displayController.toggleFlip();
+  DisplayController::Status st = displayController.getStatus();
+  serial.print("Display orientation: ");
+  serial.print(st.flipped ? "INVERTED" : "NORMAL");
+  serial.println(" (saved)");
+}
+
+void cmdDisplayFlipOn(Print& serial, const char* args) {
+  (void)args;
+  displayController.setFlip(true);
+  serial.println("Display orientation: INVERTED (saved)");
+}
 
-  if (strcmp(args, "on") == 0) {
-    displayController.setPowerMode(DisplayController::PowerMode::Auto);
-    serial.println("Display mode: AUTO");
+void cmdDisplayFlipOff(Print& serial, const char* args) {
+  (void)args;
+  displayController.setFlip(false);
+  serial.println("Display orientation: NORMAL (saved)");
+}
+
+void cmdDisplayOn(Print& serial, const char* args) {
+  (void)args;
+  displayController.setPowerMode(DisplayController::PowerMode::Auto);
+  serial.println("Display mode: AUTO");
+}
+
+void cmdDisplayOff(Print& serial, const char* args) {
+  (void)args;
+  displayController.setPowerMode(DisplayController::PowerMode::ForcedOff);
+  serial.println("Display mode: OFF");
+}
+
+void cmdDisplayDim(Print& serial, const char* args) {
+  (void)args;
+  displayController.setPowerMode(DisplayController::PowerMode::ForcedDim);
+  serial.println("Display mode: DIM");
+}
+
+// Whole minutes, 0 to disable. Anything else (including nothing) is
+// rejected so a typo cannot switch a timeout off.
+bool parseTimeoutMinutes(const char* text, uint16_t& out) {
+  if (*text < '0' || *text > '9') {
+    return false;
+  }
+  char* end = nullptr;
+  const unsigned long mins = strtoul(text, &end, 10);
+  while (*end == ' ') ++end;
+  if (*end != '\0' || mins > 65535UL) {
+    return false;
+  }
+  out = static_cast<uint16_t>(mins);
+  return true;
+}
+
+void cmdDisplayTimeoutDim(Print& serial, const char* args) {
+  uint16_t mins = 0;
+  if (!parseTimeoutMinutes(args, mins)) {
+    serial.println("Usage: display timeout dim <min> (0 disables)");
+    return;
+  }
+  displayController.setTimeoutDimMinutes(mins);
+  serial.print("Display dim timeout set to ");
+  serial.print(mins);
+  serial.println(" min");
+}
+
+void cmdDisplayTimeoutOff(Print& serial, const char* args) {
+  uint16_t mins = 0;
+  if (!parseTimeoutMinutes(args, mins)) {
+    serial.println("Usage: display timeout off <min> (0 disables)");
     return;
   }
+  displayController.setTimeoutOffMinutes(mins);
+  serial.print("Display off timeout set to ");
+  serial.print(mins);
+  serial.println(" min");
+}
+
+void printDisplayScreen(Print& serial) {
+  const DisplayController::Status st = displayController.getStatus();
+  serial.print("Display screen: ");
+  serial.print(DisplayController::screenName(st.screen));
+  if (st.autoRotate && st.rotateIntervalMs > 0) {
+    serial.print(" (rotating every ");
+    serial.print(st.rotateIntervalMs / 1000UL);
+    serial.println(" s)");
+  } else {
+    serial.println(st.autoRotate ? " (auto, rotation off)" : " (pinned)");
+  }
+}
 
-  if (strcmp(args, "off") == 0) {
-    displayController.setPowerMode(DisplayController::PowerMode::ForcedOff);
-    serial.println("Display mode: OFF");
+void cmdDisplayScreen(Print& serial, const char* args) {
+  if (*args != '\0') {
+    serial.println("Usage: display screen [auto [sec]|home|env|heater|temp|rh]");
     return;
   }
+  printDisplayScreen(serial);
+}
+
+void cmdDisplayScreenAuto(Print& serial, const char* args) {
+  const long sec = *args != '\0' ? atol(args) : static_cast<long>(DISPLAY_SCREEN_ROTATE_MS / 1000UL);
+  displayController.setAutoRotate(sec > 0 ? static_cast<unsigned long>(sec) * 1000UL : 0);
+  printDisplayScreen(serial);
+}
+
+void pinDisplayScreen(Print& serial, DisplayController::Screen screen) {
+  displayController.setScreen(screen);
+  printDisplayScreen(serial);
+}
+
+void cmdDisplayScreenEnv(Print& serial, const char* args) {
+  (void)args;
+  pinDisplayScreen(serial, DisplayController::Screen::Environment);
+}
+
+void cmdDisplayScreenHeater(Print& serial, const char* args) {
+  (void)args;
+  pinDisplayScreen(serial, DisplayController::Screen::Heater);
+}
+
+void cmdDisplayScreenHome(Print& serial, const char* args) {
+  (void)args;
+  pinDisplayScreen(serial, DisplayController::Screen::Home);
+}
 
-  if (strcmp(args, "dim") == 0) {
-    displayController.setPowerMode(DisplayController::PowerMode::ForcedDim);
-    serial.println("Display mode: DIM");
+void cmdDisplayScreenRh(Print& serial, const char* args) {
+  (void)args;
+  pinDisplayScreen(serial, DisplayController::Screen::HumidityTrend);
+}
+
+void cmdDisplayScreenTemp(Print& serial, const char* args) {
+  (void)args;
+  pinDisplayScreen(serial, DisplayController::Screen::TempTrend);
+}
+
+void cmdDisplayTest(Print& serial, const char* args) {
+  (void)args;
+  displayController.runFactoryTest(serial, 30000UL, writePwm, MAX_DUTY);
+}
+
+void cmdI2cUsage(Print& serial, const char* args) {
+  (void)args;
+  serial.println("Usage: i2c stats [reset] | i2c clock [100|400|1000] | i2c scan");
+}
+
+void cmdI2cStats(Print& serial, const char* args) {
+  if (*args != '\0') {
+    cmdI2cUsage(serial, args);
     return;
   }
+  printI2cStats(serial);
+}
+
+void cmdI2cStatsReset(Print& serial, const char* args) {
+  (void)args;
+  i2cBus.resetStats();
+  serial.println("I2C stats cleared.");
+}
 
-  if (strncmp(args, "timeout ", 8) == 0) {
-    const char* p = args + 8;
-    if (strncmp(p, "dim ", 4) == 0) {
-      int mins = atoi(p + 4);
-      if (mins < 0) mins = 0;
-      displayController.setTimeoutDimMinutes(static_cast<uint16_t>(mins));
-      serial.print("Display dim timeout set to ");
-      serial.print(mins);
-      serial.println(" min");
+void cmdI2cScan(Print& serial, const char* args) {
+  (void)args;
+  i2cBus.scan();
+  printI2cScan(serial);
+}
+
+void cmdI2cClock(Print& serial, const char* args) {
+  const uint32_t safeHz = i2cBus.maxSafeClockHz();
+  if (*args != '\0') {
+    char* rest = nullptr;
+    uint32_t hz = static_cast<uint32_t>(strtoul(args, &rest, 10)) * 1000UL;
+    while (*rest == ' ') rest++;
+    const bool force = strcmp(rest, "force") == 0;
+    if (!I2cBus::isSupportedClock(hz) || (*rest != '\0' && !force)) {
+      serial.println("Usage: i2c clock 100|400|1000 [force]");
       return;
     }
-    if (strncmp(p, "off ", 4) == 0) {
-      int mins = atoi(p + 4);
-      if (mins < 0) mins = 0;
-      displayController.setTimeoutOffMinutes(static_cast<uint16_t>(mins));
-      serial.print("Display off timeout set to ");
-      serial.print(mins);
-      serial.println(" min");
+    if (!i2cBus.setClock(hz, force)) {
+      serial.print("Refused: slowest detected device is rated for ");
+      serial.print(safeHz / 1000UL);
+      serial.println(" kHz; add 'force' to run faster until reboot.");
       return;
     }
   }
+  serial.print("I2C clock: ");
+  serial.print(i2cBus.getClock() / 1000UL);
+  serial.print(" kHz");
+  serial.println(i2cBus.getClock() > safeHz ? " (forced, not saved)" : "");
+}
 
-  if (strcmp(args, "test") == 0) {
-    displayController.runFactoryTest(serial, 30000UL, writePwm, MAX_DUTY);
+void cmdStream(Print& serial, const char* args) {
+  if (*args != '\0') {
+    serial.println("Usage: stream on <hz> | stream off");
     return;
   }
+  TelemetryStream::Status st = telemetry.getStatus();
+  serial.print("Stream: ");
+  serial.print(st.enabled ? "on" : "off");
+  serial.print(" rateHz=");
+  serial.print(st.rateHz);
+  serial.print(" frames=");
+  serial.print(st.frames);
+  serial.print(" shortWrites=");
+  serial.print(st.shortWrites);
+  serial.print(" nextSeq=");
+  serial.print(st.nextSeq);
+  serial.print(" frameBytes=");
+  serial.println(static_cast<unsigned long>(st.frameBytes));
+}
+
+void cmdStreamOn(Print& serial, const char* args) {
+  long hz = *args != '\0' ? atol(args) : 10;
+  if (hz < 1 || hz > TelemetryStream::kMaxRateHz) {
+    serial.print("Usage: stream on <1..");
+    serial.print(TelemetryStream::kMaxRateHz);
+    serial.println(">");
+    return;
+  }
+  telemetry.start(static_cast<uint16_t>(hz));
+  scheduler.setPeriod(streamTaskId, telemetry.periodMs());
+  serial.print("Stream on at ");
+  serial.print(hz);
+  serial.print(" Hz (v");
+  serial.print(kTelemetryVersion);
+  serial.println(" COBS frames; decode with tlc_telemetry_decode)");
+}
+
+void cmdStreamOff(Print& serial, const char* args) {
+  (void)args;
+  telemetry.stop();
+  scheduler.setPeriod(streamTaskId, STREAM_TASK_IDLE_PERIOD_MS);
+  serial.println("Stream off");
+}
 
-  serial.println("Usage: display status | display on|off|dim | display flip [on|off] | display timeout dim|off <min> | display test");
+void cmdHistory(Print& serial, const char* args) {
+  long hours = *args != '\0' ? atol(args) : 24;
+  if (hours <= 0) {
+    serial.println("Usage: history [hours] | history status");
+    return;
+  }
+  const uint32_t nowUnix = clockService.now().unixtime();
+  const uint32_t span = static_cast<uint32_t>(hours) * 3600UL;
+  historyLog.beginQuery(span < nowUnix ? nowUnix - span : 0, nowUnix);
+  historyDumpActive = true;
+  historyDumpSamples = 0;
+  historyDumpEvents = 0;
+  serial.print("# history last ");
+  serial.print(hours);
+  serial.println(" h");
+  serial.println("# S,time,tempF,rh,duty");
+  serial.println("# H,time,durationMs,reason,rhBefore,rhAfter,tempBeforeF,tempAfterF");
+}
+
+void cmdHistoryStatus(Print& serial, const char* args) {
+  (void)args;
+  HistoryLog::Status st = historyLog.getStatus();
+  if (!st.ready) {
+    serial.println("History: no 'history' partition");
+    return;
+  }
+  serial.print("History: records=");
+  serial.print(static_cast<unsigned long>(st.usedRecords));
+  serial.print("/");
+  serial.print(static_cast<unsigned long>(st.capacityRecords));
+  serial.print(" sectors=");
+  serial.print(static_cast<unsigned long>(st.sectors));
+  serial.print(" oldest=");
+  if (st.oldestUnix != 0) {
+    printIsoDateTime(serial, DateTime(st.oldestUnix));
+  } else {
+    serial.print("--");
+  }
+  serial.print(" pending=");
+  serial.print(static_cast<unsigned long>(st.pendingSamples));
+  serial.print("+");
+  serial.print(static_cast<unsigned long>(st.pendingEvents));
+  serial.println("ev");
+  serial.print("  since boot: records=");
+  serial.print(st.recordsWritten);
+  serial.print(" samples=");
+  serial.print(st.samplesWritten);
+  serial.print(" erases=");
+  serial.print(st.erases);
+  serial.print(" crcErrors=");
+  serial.print(st.crcErrors);
+  serial.print(" writeErrors=");
+  serial.print(st.writeErrors);
+  serial.print(" droppedEvents=");
+  serial.println(st.droppedEvents);
 }
 
+// Emits the next slice of a running 'history' dump; called from the
+// console task so a long dump never blocks the light task.
+void continueHistoryDump(Print& serial) {
+  HistoryLog::Sample sample;
+  HistoryLog::HeaterEvent event;
+  for (int i = 0; i < HISTORY_DUMP_ITEMS_PER_PASS; ++i) {
+    HistoryLog::Item item = historyLog.next(sample, event);
+    if (item == HistoryLog::Item::None) {
+      serial.print("# end samples=");
+      serial.print(historyDumpSamples);
+      serial.print(" events=");
+      serial.println(historyDumpEvents);
+      historyDumpActive = false;
+      break;
+    }
+    if (item == HistoryLog::Item::Sample) {
+      serial.print("S,");
+      printIsoDateTime(serial, DateTime(sample.unixTime));
+      serial.print(',');
+      if (sample.valid) {
+        printFixed(serial, cToF(sample.temperatureC), 2);
+        serial.print(',');
+        printFixed(serial, sample.humidity, 2);
+      } else {
+        serial.print(',');
+      }
+      serial.print(',');
+      serial.println(sample.duty);
+      historyDumpSamples++;
+    } else {
+      serial.print("H,");
+      printIsoDateTime(serial, DateTime(event.unixTime));
+      serial.print(',');
+      serial.print(static_cast<unsigned long>(event.durationMs));
+      serial.print(',');
+      serial.print(event.reason);
+      serial.print(',');
+      printFixed(serial, event.rhBefore, 2);
+      serial.print(',');
+      printFixed(serial, event.rhAfter, 2);
+      serial.print(',');
+      printFixed(serial, cToF(event.tempBeforeC), 2);
+      serial.print(',');
+      printFixed(serial, cToF(event.tempAfterC), 2);
+      serial.println();
+      historyDumpEvents++;
+    }
+  }
+  serial.flush();
+}
+
+void printTrend(Print& serial, SensorRollups::Tier tier, const char* label, const char* args, long defaultCount) {
+  long count = *args != '\0' ? atol(args) : defaultCount;
+  const long capacity = static_cast<long>(rollups.getCapacity(tier));
+  if (count <= 0) {
+    serial.println("Usage: trend [1m|15m|1h] [buckets]");
+    return;
+  }
+  if (count > capacity) count = capacity;
+
+  serial.print("# trend ");
+  serial.print(label);
+  serial.print(" x");
+  serial.println(count);
+  serial.println("# start,n,tempF min/mean/max,rh min/mean/max");
+  SensorRollups::Bucket bucket;
+  for (long age = count - 1; age >= 0; --age) {
+    if (!rollups.getBucket(tier, static_cast<size_t>(age), bucket)) {
+      continue;
+    }
+    printIsoDateTime(serial, DateTime(bucket.startUnix));
+    serial.print(',');
+    serial.print(bucket.count);
+    serial.print(',');
+    printFixed(serial, cToF(bucket.temperatureC.min), 1);
+    serial.print('/');
+    printFixed(serial, cToF(bucket.temperatureC.mean), 1);
+    serial.print('/');
+    printFixed(serial, cToF(bucket.temperatureC.max), 1);
+    serial.print(',');
+    printFixed(serial, bucket.humidity.min, 1);
+    serial.print('/');
+    printFixed(serial, bucket.humidity.mean, 1);
+    serial.print('/');
+    printFixed(serial, bucket.humidity.max, 1);
+    serial.println();
+  }
+}
+
+void cmdTrend(Print& serial, const char* args) {
+  printTrend(serial, SensorRollups::Tier::Hour, "1h", args, 24);
+}
+
+void cmdTrendMinute(Print& serial, const char* args) {
+  printTrend(serial, SensorRollups::Tier::Minute, "1m", args, 60);
+}
+
+void cmdTrendQuarter(Print& serial, const char* args) {
+  printTrend(serial, SensorRollups::Tier::Quarter, "15m", args, 96);
+}
+
+// Copies the 24 h extremes of the Quarter rollups into the UI state.
+void updateSensorRange() {
+  SensorRollups::Bucket range;
+  uiState.hasRange = rollups.getRange(SensorRollups::Tier::Quarter, range);
+  if (uiState.hasRange) {
+    uiState.temperatureMinF = cToF(range.temperatureC.min);
+    uiState.temperatureMaxF = cToF(range.temperatureC.max);
+    uiState.humidityMin = range.humidity.min;
+    uiState.humidityMax = range.humidity.max;
+  }
+}
+
+// Replays the logged samples so the rollups and trend graphs cover the
+// days before boot.
+void seedRollupsFromHistory() {
+  const uint32_t nowUnix = clockService.now().unixtime();
+  const uint32_t span = ROLLUP_SEED_DAYS * 86400UL;
+  historyLog.beginQuery(span < nowUnix ? nowUnix - span : 0, nowUnix);
+  HistoryLog::Sample sample;
+  HistoryLog::HeaterEvent event;
+  unsigned long seeded = 0;
+  HistoryLog::Item item;
+  while ((item = historyLog.next(sample, event)) != HistoryLog::Item::None) {
+    if (item == HistoryLog::Item::Sample && sample.valid) {
+      rollups.add(sample.unixTime, sample.temperatureC, sample.humidity);
+      seeded++;
+    }
+  }
+  updateSensorRange();
+  Serial.print("Rollups: seeded from ");
+  Serial.print(seeded);
+  Serial.println(" logged samples");
+}
+
+void onSht3xHeaterEvent(const SHT3xController::HeaterEvent& ev) {
+  HistoryLog::HeaterEvent event{};
+  event.unixTime = ev.timestamp.unixtime();
+  event.durationMs = ev.durationMs;
+  strncpy(event.reason, ev.reason ? ev.reason : "unknown", sizeof(event.reason) - 1);
+  event.rhBefore = ev.rhBefore;
+  event.tempBeforeC = ev.tempBeforeC;
+  event.rhAfter = ev.rhAfter;
+  event.tempAfterC = ev.tempAfterC;
+  historyLog.appendHeaterEvent(event);
+}
+
+// Every table is sorted by name (checked at compile time); entries with a
+// null help string are aliases.
+constexpr ConsoleCommand kAlertsCommands[] = {
+    {"cold", cmdAlertsCold, "<F> Too cold below this", nullptr, 0},
+    {"debounce", cmdAlertsDebounce, "<samples> Samples in a row to raise or clear an alert", nullptr, 0},
+    {"dry", cmdAlertsDry, "<%RH> Needs watering below this", nullptr, 0},
+    {"hot", cmdAlertsHot, "<F> Too hot above this", nullptr, 0},
+    {"hysteresis", cmdAlertsHysteresis, "<F> <%RH> Margin past a threshold to clear", nullptr, 0},
+};
+
+constexpr ConsoleCommand kDisplayFlipCommands[] = {
+    {"off", cmdDisplayFlipOff, "Normal orientation", nullptr, 0},
+    {"on", cmdDisplayFlipOn, "Rotate 180 degrees", nullptr, 0},
+};
+
+constexpr ConsoleCommand kDisplayScreenCommands[] = {
+    {"auto", cmdDisplayScreenAuto, "[sec] Rotate through the screens (0 = stay on home)", nullptr, 0},
+    {"env", cmdDisplayScreenEnv, "Temperature and RH with 24 h min/max", nullptr, 0},
+    {"heater", cmdDisplayScreenHeater, "SHT3x heater diagnostics", nullptr, 0},
+    {"home", cmdDisplayScreenHome, "Brightness, mode, next event, alerts", nullptr, 0},
+    {"rh", cmdDisplayScreenRh, "24 h humidity graph", nullptr, 0},
+    {"temp", cmdDisplayScreenTemp, "24 h temperature graph", nullptr, 0},
+};
+
+constexpr ConsoleCommand kDisplayTimeoutCommands[] = {
+    {"dim", cmdDisplayTimeoutDim, "<min> Idle minutes before dimming (0 = never)", nullptr, 0},
+    {"off", cmdDisplayTimeoutOff, "<min> Idle minutes before blanking (0 = never)", nullptr, 0},
+};
+
+constexpr ConsoleCommand kDisplayCommands[] = {
+    {"dim", cmdDisplayDim, "Force dimmed", nullptr, 0},
+    {"flip", cmdDisplayFlip, "Toggle orientation, or flip on|off", kDisplayFlipCommands, consoleCount(kDisplayFlipCommands)},
+    {"off", cmdDisplayOff, "Force off", nullptr, 0},
+    {"on", cmdDisplayOn, "Automatic dim/off timeouts", nullptr, 0},
+    {"screen", cmdDisplayScreen, "Show or pick the screen, or auto [sec] to rotate", kDisplayScreenCommands, consoleCount(kDisplayScreenCommands)},
+    {"status", cmdDisplayStatus, "Show display state and flush timing", nullptr, 0},
+    {"test", cmdDisplayTest, "30 s factory test pattern", nullptr, 0},
+    {"timeout", cmdDisplayUsage, "dim|off <min> Set idle timeouts", kDisplayTimeoutCommands, consoleCount(kDisplayTimeoutCommands)},
+};
+
+constexpr ConsoleCommand kHistoryCommands[] = {
+    {"status", cmdHistoryStatus, "Flash log usage and counters", nullptr, 0},
+};
+
+constexpr ConsoleCommand kI2cStatsCommands[] = {
+    {"reset", cmdI2cStatsReset, "Clear the counters", nullptr, 0},
+};
+
+constexpr ConsoleCommand kI2cCommands[] = {
+    {"clock", cmdI2cClock, "[100|400|1000 [force]] Show or set bus clock (kHz)", nullptr, 0},
+    {"scan", cmdI2cScan, "Rescan the bus", nullptr, 0},
+    {"stats", cmdI2cStats, "Per-device transactions, NACKs, latency", kI2cStatsCommands, consoleCount(kI2cStatsCommands)},
+};
+
+constexpr ConsoleCommand kScheduleSolarCommands[] = {
+    {"off", cmdScheduleSolarOff, "Back to the clock schedule", nullptr, 0},
+    {"on", cmdScheduleSolarOn, "Follow dawn/sunrise/sunset/dusk", nullptr, 0},
+    {"set", cmdScheduleSolarSet, "<lat> <lon> <utcOffsetMin> Set the location", nullptr, 0},
+};
+
+constexpr ConsoleCommand kScheduleCommands[] = {
+    {"add", cmdScheduleAdd, "<days> <HH:MM> <min> <from%> [to%] Add a ramp segment", nullptr, 0},
+    {"clear", cmdScheduleClear, "Remove every segment (light stays off)", nullptr, 0},
+    {"del", cmdScheduleDel, "<index> Remove a segment", nullptr, 0},
+    {"reset", cmdScheduleReset, "Restore the built-in schedule", nullptr, 0},
+    {"solar", cmdScheduleSolar, "Solar mode status (on/off/set)", kScheduleSolarCommands, consoleCount(kScheduleSolarCommands)},
+};
+
+constexpr ConsoleCommand kSht3xModeCommands[] = {
+    {"art", cmdSht3xModeArt, "Periodic acquisition with ART fetch", nullptr, 0},
+    {"single", cmdSht3xModeSingle, "Single-shot with deferred fetch", nullptr, 0},
+};
+
+constexpr ConsoleCommand kSht3xCommands[] = {
+    {"mode", cmdSht3xMode, "single|art Select acquisition mode", kSht3xModeCommands, consoleCount(kSht3xModeCommands)},
+    {"status", cmdSht3xStatus, "Readings, counters and heater events", nullptr, 0},
+};
+
+constexpr ConsoleCommand kStreamCommands[] = {
+    {"off", cmdStreamOff, "Stop streaming", nullptr, 0},
+    {"on", cmdStreamOn, "<hz> Stream binary state records (default 10 Hz)", nullptr, 0},
+};
+
+constexpr ConsoleCommand kTrendCommands[] = {
+    {"15m", cmdTrendQuarter, "[n] 15-minute buckets (default 96 = 24 h)", nullptr, 0},
+    {"1h", cmdTrend, "[n] Hourly buckets (default 24, up to 168)", nullptr, 0},
+    {"1m", cmdTrendMinute, "[n] Minute buckets (default 60)", nullptr, 0},
+};
+
+constexpr ConsoleCommand kConsoleCommands[] = {
+    {"alerts", cmdAlerts, "Show sensor alerts; set cold/hot/dry/hysteresis/debounce", kAlertsCommands, consoleCount(kAlertsCommands)},
+    {"channel", cmdChannel, "[n] List light channels; select the one 'schedule' edits", nullptr, 0},
+    {"clock", cmdClock, "Show RTC sync/drift status", nullptr, 0},
+    {"datetime", cmdNow, nullptr, nullptr, 0},
+    {"debug", cmdDebug, "Print schedule and PWM debug lines", nullptr, 0},
+    {"display", cmdDisplayUsage, "Display commands (status/on/off/dim/flip/screen/timeout/test)", kDisplayCommands, consoleCount(kDisplayCommands)},
+    {"forceOff", handleForceOff, "Return to schedule timing", nullptr, 0},
+    {"forceOn", handleForceOn, "Force LED on (override schedule)", nullptr, 0},
+    {"forceoff", handleForceOff, nullptr, nullptr, 0},
+    {"forceon", handleForceOn, nullptr, nullptr, 0},
+    {"heap", cmdHeap, "Free heap, minimum free since boot, largest free block", nullptr, 0},
+    {"history", cmdHistory, "[hours] Dump logged samples/heater events (default 24 h); status", kHistoryCommands, consoleCount(kHistoryCommands)},
+    {"i2c", cmdI2cUsage, "I2C bus commands (stats [reset]/clock/scan)", kI2cCommands, consoleCount(kI2cCommands)},
+    {"now", cmdNow, "Show current date/time (cached DS3231 time)", nullptr, 0},
+    {"pot", cmdPot, "Read current potentiometer value", nullptr, 0},
+    {"schedule", cmdSchedule, "Show lighting segments (add/del/clear/reset/solar)", kScheduleCommands, consoleCount(kScheduleCommands)},
+    {"settime", cmdSetTime, "Set RTC (YYYY-MM-DD HH:MM:SS)", nullptr, 0},
+    {"sht3x", cmdSht3xStatus, "Show SHT3x status/events; mode single|art", kSht3xCommands, consoleCount(kSht3xCommands)},
+    {"status", cmdStatus, "Show current pot/gate/duty", nullptr, 0},
+    {"stream", cmdStream, "Binary telemetry (on <hz>/off); no args shows status", kStreamCommands, consoleCount(kStreamCommands)},
+    {"tasks", cmdTasks, "Show scheduler task timing and overruns", nullptr, 0},
+    {"time", cmdNow, nullptr, nullptr, 0},
+    {"trend", cmdTrend, "Temp/RH min/mean/max rollups (1m/15m/1h [n]); default last 24 h hourly", kTrendCommands, consoleCount(kTrendCommands)},
+};
+
+static_assert(consoleTableSorted(kAlertsCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kDisplayFlipCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kDisplayScreenCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kDisplayTimeoutCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kDisplayCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kHistoryCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kI2cStatsCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kI2cCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kScheduleSolarCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kScheduleCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kSht3xModeCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kSht3xCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kStreamCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kTrendCommands), "console table must be sorted");
+static_assert(consoleTableSorted(kConsoleCommands), "console table must be sorted");
+
 void setupPwm() {
-#if TLC_LEDC_NEW_API
-  ledcAttach(LED_PIN, PWM_FREQ, PWM_RESOLUTION);
-  ledcWrite(LED_PIN, 0);
-#else
-  ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_RESOLUTION);
-  ledcAttachPin(LED_PIN, PWM_CHANNEL);
-  ledcWrite(PWM_CHANNEL, 0);
-#endif
+  constexpr LightChannels::Tuning tuning{DEADZONE_LEVEL_Q16, FADE_CHUNK_S, RTC_TASK_PERIOD_MS,
+                                         FADE_KNOB_TOLERANCE_Q16};
+  lights.begin(LIGHT_CHANNELS, LIGHT_CHANNEL_COUNT, tuning, PWM_FREQ, PWM_RESOLUTION);
 }
 
+// Every channel at once (LED test, fail-safe, display factory test).
 void writePwm(int duty) {
-#if TLC_LEDC_NEW_API
-  ledcWrite(LED_PIN, duty);
-#else
-  ledcWrite(PWM_CHANNEL, duty);
-#endif
+  lights.writeAll(static_cast<uint32_t>(duty));
 }
 
 // ====================== Setup / Loop ======================
@@ -450,6 +1614,12 @@ void setup() {
   Serial.begin(115200);
   delay(500);
   Serial.println("\nBOOT: starting...");
+  // A brownout reset means the USB supply sagged under load (LED full on,
+  // weak port or cable); the status bar says so until the next clean boot.
+  uiState.usbPowerLimited = esp_reset_reason() == ESP_RST_BROWNOUT;
+  if (uiState.usbPowerLimited) {
+    Serial.println("BOOT: last reset was a brownout; USB power is limited");
+  }
 
   // Ensure off at boot
   pinMode(LED_PIN, OUTPUT);
@@ -457,6 +1627,10 @@ void setup() {
 
   // PWM attach (compat with Arduino-ESP32 2.x/3.x)
   setupPwm();
+  uiState.channelCount = static_cast<uint8_t>(lights.getCount());
+  for (size_t i = 0; i < lights.getCount(); ++i) {
+    uiState.channels[i].tag = static_cast<char>(toupper(static_cast<unsigned char>(lights.getConfig(i).name[0])));
+  }
 
   // Quick LED sanity test (bypasses schedule + pot)
   Serial.println("LED test: 25% for 1s");
@@ -465,16 +1639,20 @@ void setup() {
   writePwm(0);
   Serial.println("LED test done");
 
-  // ADC
+  // ADC: continuous sampling of the pot, analogRead() bursts if unavailable
   analogReadResolution(12); // 0..4095
+  if (!potSampler.begin(POT_PIN, POT_SAMPLE_RATE_HZ, POT_FILTER_DEPTH)) {
+    Serial.println("Pot: continuous ADC unavailable, using analogRead bursts");
+  }
 
   // I2C + RTC
   Serial.print("Wire.begin SDA="); Serial.print(I2C_SDA);
   Serial.print(" SCL="); Serial.println(I2C_SCL);
-  Wire.begin(I2C_SDA, I2C_SCL);
-  delay(50);
-
-  scanI2C();
+  i2cBus.begin(I2C_SDA, I2C_SCL);
+  printI2cScan(Serial);
+  Serial.print("I2C clock: ");
+  Serial.print(i2cBus.getClock() / 1000UL);
+  Serial.println(" kHz");
 
   Serial.println("rtc.begin()...");
   bool ok = rtc.begin();
@@ -495,17 +1673,31 @@ void setup() {
     rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
   }
 
-  DateTime now = rtc.now();
+  clockService.begin();
+  DateTime now = clockService.now();
   Serial.print("RTC now: ");
-  Serial.print(now.year()); Serial.print("-");
-  Serial.print(now.month()); Serial.print("-");
-  Serial.print(now.day()); Serial.print(" ");
-  Serial.print(now.hour()); Serial.print(":");
-  if (now.minute() < 10) Serial.print("0");
-  Serial.println(now.minute());
+  printIsoDateTime(Serial, now);
+  Serial.println();
+
+  for (size_t i = 0; i < lights.getCount(); ++i) {
+    LightSchedule& sched = lights.schedule(i);
+    Serial.print("Schedule ");
+    Serial.print(lights.getConfig(i).name);
+    Serial.print(": ");
+    Serial.print(static_cast<unsigned long>(sched.getSegmentCount()));
+    Serial.println(sched.getStatus().stored ? " segments from NVS" : " default segments");
+  }
+  solar.begin();
+  if (solar.update(now)) {
+    applySolarSchedule();
+  }
+  if (solar.getConfig().enabled) {
+    printSolar(Serial);
+  }
+  alerts.begin();
 
   Serial.println("--- Main loop starting ---");
-  bool sht3xOk = sht3x.begin(Wire);
+  bool sht3xOk = sht3x.begin(i2cBus);
   if (sht3xOk) {
     sht3x.setLogStream(Serial);
     Serial.println("SHT3x: detected");
@@ -513,48 +1705,133 @@ void setup() {
     Serial.println("SHT3x: not detected");
   }
 
+  if (historyLog.begin()) {
+    HistoryLog::Status hist = historyLog.getStatus();
+    Serial.print("History: ");
+    Serial.print(static_cast<unsigned long>(hist.usedRecords));
+    Serial.print("/");
+    Serial.print(static_cast<unsigned long>(hist.capacityRecords));
+    Serial.println(" records");
+    sht3x.setHeaterEventHandler(onSht3xHeaterEvent);
+    seedRollupsFromHistory();
+  } else {
+    Serial.println("History: no 'history' partition (check partitions.csv)");
+  }
+
   displayController.setLogStream(Serial);
-  if (displayController.begin(Wire)) {
+  displayController.setTrendSource(rollups);
+  if (displayController.begin(i2cBus)) {
     Serial.println("SSD1306: detected");
   }
 
-  console.setStatusHandler(printStatus);
-  console.setPotHandler(printPot);
-  console.setDebugHandler(printDebug);
-  console.setForceOnHandler(handleForceOn);
-  console.setForceOffHandler(handleForceOff);
-  console.setSht3xHandler(printSht3xStatus);
-  console.setDisplayHandler(handleDisplayCommand);
-  console.begin();
+  console.begin(kConsoleCommands, consoleCount(kConsoleCommands));
+
+  // Registration order is priority order: the LED output first.
+  scheduler.addTask("light", runLightTask, LIGHT_TASK_PERIOD_MS, LIGHT_TASK_BUDGET_US);
+  rtcTaskId = scheduler.addTask("rtc", runRtcTask, RTC_TASK_PERIOD_MS, RTC_TASK_BUDGET_US);
+  if (sht3xOk) {
+    sht3xTaskId = scheduler.addTask("sht3x", runSht3xTask, SHT3X_TASK_PERIOD_MS, SHT3X_TASK_BUDGET_US);
+  }
+  displayTaskId = scheduler.addTask("display", runDisplayTask, DISPLAY_REFRESH_INTERVAL_MS, DISPLAY_TASK_BUDGET_US);
+  streamTaskId = scheduler.addTask("stream", runStreamTask, STREAM_TASK_IDLE_PERIOD_MS, STREAM_TASK_BUDGET_US);
+  if (historyLog.isReady()) {
+    scheduler.addTask("history", runHistoryTask, HISTORY_SAMPLE_INTERVAL_MS, HISTORY_TASK_BUDGET_US);
+  }
+  scheduler.addTask("console", runConsoleTask, CONSOLE_TASK_PERIOD_MS, CONSOLE_TASK_BUDGET_US);
 }
 
-void loop() {
+// ====================== Tasks ======================
+
+void runConsoleTask(unsigned long nowMs) {
+  (void)nowMs;
+  TLC_PROFILE_STAGE(Console);
   console.update();
-  static float filtered = 0.0f;
-  static int lastDuty = -1;
-  const unsigned long nowMs = millis();
+  if (historyDumpActive) {
+    continueHistoryDump(report);
+  }
+  TLC_PROFILE_END();
+}
 
-  // ---- Read pot -> normalized brightness 0..1 ----
-  int raw = analogRead(POT_PIN);
-  float norm = raw / 4095.0f;
-  float x = norm;
-  if (INVERT_KNOB) x = 1.0f - x;
-  x *= MAX_BRIGHTNESS;
+void runRtcTask(unsigned long nowMs) {
+  TLC_PROFILE_STAGE(RtcGating);
+  clockService.update(nowMs);
+  if (clockService.isFindingEdge()) {
+    // The RTC came back; poll for its seconds tick instead of blocking.
+    scheduler.setNextRunIn(rtcTaskId, ClockService::kEdgePollMs);
+  }
+  DateTime now = clockService.now(nowMs);
+  const uint32_t nowUnix = now.unixtime();
 
-  // Smooth
-  filtered = FILTER_ALPHA * filtered + (1.0f - FILTER_ALPHA) * x;
+  // Solar times are recomputed only when the date changes.
+  if (solar.update(now)) {
+    applySolarSchedule();
+  }
+  lights.updateSchedules(nowUnix, nowMs, forceOn);
+  const bool scheduleAllowed = lights.getState(0, nowMs).allowed;
 
-  // ---- RTC gating ----
-  DateTime now = rtc.now();
-  int nowMin = minutesOfDay(now.hour(), now.minute());
+  uiState.rtcNow = now;
+  // Until the RTC answers, now() counts from 1970; history and rollups
+  // skip samples while this is false.
+  uiState.rtcValid = clockService.getStatus().valid;
+  uiState.usbConnected = static_cast<bool>(Serial);
+  uiState.scheduleAllowed = scheduleAllowed;
+  // The next on/off time only moves when the schedule crosses a boundary.
+  const unsigned long recomputes = lights.schedule(0).getStatus().recomputes;
+  if (recomputes != scheduleRecomputesSeen) {
+    scheduleRecomputesSeen = recomputes;
+    formatNextEvent(lights.schedule(0), uiState.nextEvent, sizeof(uiState.nextEvent), nowUnix, scheduleAllowed);
+  }
+  TLC_PROFILE_END();
+}
 
-  int startMin = minutesOfDay(ON_HOUR, ON_MINUTE);
-  bool scheduleAllowed = isInWindow(nowMin, startMin, DURATION_MINUTES);
-  bool allowed = forceOn ? true : scheduleAllowed;
+void runSht3xTask(unsigned long nowMs) {
+  TLC_PROFILE_STAGE(Sht3xUpdate);
+  sht3x.update(uiState.rtcNow, nowMs);
 
-  if (sht3x.isPresent()) {
-    sht3x.update(now, nowMs);
+  SHT3xController::Reading trusted = sht3x.getLastTrustedReading();
+  uiState.hasHumidity = trusted.valid;
+  uiState.humidityPercent = trusted.valid ? trusted.humidity : 0.0f;
+  uiState.hasTempF = trusted.valid;
+  uiState.temperatureF = trusted.valid ? cToF(trusted.temperatureC) : 0.0f;
+
+  // A held trusted reading keeps its timestamp, so each sample counts once.
+  const uint32_t sampleUnix = trusted.timestamp.unixtime();
+  if (trusted.valid && uiState.rtcValid && sampleUnix != lastRollupUnix) {
+    lastRollupUnix = sampleUnix;
+    rollups.add(sampleUnix, trusted.temperatureC, trusted.humidity);
+    updateSensorRange();
   }
+
+  // Alerts step once per new sample, and only on a trusted one; samples
+  // skewed by a heater pulse hold them as they are.
+  const SHT3xController::Diagnostics diag = sht3x.getDiagnostics();
+  if (diag.samples != alertSamplesSeen) {
+    alertSamplesSeen = diag.samples;
+    const SHT3xController::Reading latest = sht3x.getLastReading();
+    if (!trusted.valid) {
+      alerts.reset();
+    } else if (latest.valid && !latest.heaterInfluenced && !latest.settling) {
+      alerts.evaluate(uiState.temperatureF, trusted.humidity);
+    }
+    uiState.tooCold = alerts.isActive(AlertEngine::Alert::TooCold);
+    uiState.tooHot = alerts.isActive(AlertEngine::Alert::TooHot);
+    uiState.needsWatering = alerts.isActive(AlertEngine::Alert::NeedsWatering);
+  }
+
+  uiState.sensorPresent = diag.present;
+  uiState.heaterOn = diag.heaterEnabled;
+  uiState.heaterPulsesLastHour = static_cast<uint8_t>(diag.pulsesLastHour);
+  uiState.heaterLastMs = diag.lastHeaterMs;
+  uiState.wetStuck = diag.wetStuck;
+  uiState.condensationFault = diag.condensationFault;
+  uiState.sensorErrors = diag.crcErrors + diag.busErrors;
+
+  scheduler.setNextRunIn(sht3xTaskId, sht3x.msUntilNextUpdate(nowMs));
+  TLC_PROFILE_END();
+}
+
+void runDisplayTask(unsigned long nowMs) {
+  TLC_PROFILE_STAGE(DisplayUpdate);
   unsigned long t0 = micros();
   displayController.update(uiState, nowMs);
   unsigned long dt = micros() - t0;
@@ -568,53 +1845,69 @@ void loop() {
     Serial.print(dt);
     Serial.println(" us");
   }
-
-  float gate = 0.0f;
-  if (forceOn) {
-    gate = 1.0f;
-  } else if (scheduleAllowed) {
-    gate = fadeMultiplier(nowMin, startMin, DURATION_MINUTES, FADE_MINUTES);
+  if (displayController.isFlushPending()) {
+    scheduler.setNextRunIn(displayTaskId, DISPLAY_FLUSH_STEP_INTERVAL_MS);
   }
+  TLC_PROFILE_END();
+}
 
-  // ---- Final PWM ----
-  int duty = 0;
-  if (allowed) {
-    duty = int(filtered * gate * MAX_DUTY + 0.5f);
-    if (duty < DEADZONE_DUTY) duty = 0;
-  } else {
-    duty = 0;
-  }
+void runStreamTask(unsigned long nowMs) {
+  telemetry.send(uiState, sht3x, nowMs);
+}
 
-  if (duty != lastDuty) {
-    writePwm(duty);
-    lastDuty = duty;
+void runHistoryTask(unsigned long nowMs) {
+  if (!uiState.rtcValid) {
+    return;
   }
+  SHT3xController::Reading trusted = sht3x.getLastTrustedReading();
+  HistoryLog::Sample sample{};
+  sample.unixTime = clockService.now(nowMs).unixtime();
+  sample.valid = trusted.valid;
+  sample.temperatureC = trusted.temperatureC;
+  sample.humidity = trusted.humidity;
+  sample.duty = static_cast<uint16_t>(uiState.duty);
+  historyLog.appendSample(sample);
+}
 
-  uiState.rtcNow = now;
-  uiState.rtcValid = true;
-  uiState.rawPot = raw;
-  uiState.potNorm = norm;
-  uiState.potScaled = x;
-  uiState.potFiltered = filtered;
-  uiState.brightnessPercent = int((x / MAX_BRIGHTNESS) * 100.0f + 0.5f);
-  uiState.duty = duty;
-  uiState.lightOn = (duty > 0);
-  uiState.scheduleAllowed = scheduleAllowed;
+void runLightTask(unsigned long nowMs) {
+  // ---- Drain the pot samples collected since the last frame ----
+  TLC_PROFILE_STAGE(PotRead);
+  potSampler.update();
+  const uint16_t levelQ16 = potSampler.getLevelQ16();
+  const uint32_t knobQ16 = INVERT_KNOB ? 65535U - levelQ16 : levelQ16;
+
+  // ---- All channels in one pass ----
+  TLC_PROFILE_STAGE(PwmWrite);
+  lights.update(knobQ16, forceOn, nowMs);
+
+  TLC_PROFILE_STAGE(UiState);
+  const uint32_t counts = potSampler.getCounts();
+  uint32_t lastQ16 = potSampler.getStatus().lastSample * 65535UL / PotSampler::kMaxCounts;
+  if (INVERT_KNOB) lastQ16 = 65535U - lastQ16;
+  uiState.rawPot = static_cast<int>(counts);
+  uiState.potNormQ16 = static_cast<uint16_t>(counts * 65535UL / PotSampler::kMaxCounts);
+  uiState.potScaledQ16 = static_cast<uint16_t>(lastQ16 * MAX_BRIGHTNESS_Q16 / 65535UL);
+  uiState.potFilteredQ16 = static_cast<uint16_t>(knobQ16 * MAX_BRIGHTNESS_Q16 / 65535UL);
+  uiState.brightnessPercent = static_cast<int>((knobQ16 * 100UL + 32767UL) / 65535UL);
+  bool anyOn = false;
+  for (size_t i = 0; i < lights.getCount(); ++i) {
+    const LightChannels::ChannelState ch = lights.getState(i, nowMs);
+    UiChannel& ui = uiState.channels[i];
+    ui.percent = static_cast<uint8_t>((ch.levelQ16 * 100UL + 32767UL) / 65535UL);
+    ui.duty = static_cast<uint16_t>(ch.duty);
+    anyOn = anyOn || ch.duty > 0;
+  }
+  const LightChannels::ChannelState main = lights.getState(0, nowMs);
+  uiState.duty = static_cast<int>(main.duty);
+  uiState.lightOn = anyOn;
   uiState.forceOn = forceOn;
-  uiState.gate = gate;
+  uiState.gateQ16 = forceOn ? LightSchedule::kLevelOneQ16 : main.gateQ16;
   uiState.controlMode = forceOn ? ControlMode::Override : ControlMode::Schedule;
-  formatNextEvent(uiState.nextEvent, sizeof(uiState.nextEvent), scheduleAllowed);
-
-  SHT3xController::Reading trusted = sht3x.getLastTrustedReading();
-  uiState.hasHumidity = trusted.valid;
-  uiState.humidityPercent = trusted.valid ? trusted.humidity : 0.0f;
-  uiState.hasTempF = trusted.valid;
-  uiState.temperatureF = trusted.valid ? cToF(trusted.temperatureC) : 0.0f;
 
-  uiState.needsWatering = false;
-  uiState.tooCold = false;
-  uiState.tooHot = false;
-  uiState.usbPowerLimited = false;
+  TLC_PROFILE_END();
+}
 
-  delay(LOOP_DELAY_MS);
+void loop() {
+  scheduler.runDue();
+  scheduler.sleepUntilNextDeadline();
 }
@@ -3,6 +3,15 @@
 #include <Arduino.h>
 #include "RTClib.h"
 
+// Per-channel summary (LightChannels::kMaxChannels entries).
+constexpr size_t kUiMaxChannels = 4;
+
+struct UiChannel {
+  char tag;         // first letter of the channel name
+  uint8_t percent;  // perceived level, 0..100
+  uint16_t duty;
+};
+
 enum class ControlMode : uint8_t {
   Pot = 0,
   Schedule = 1,
@@ -12,19 +21,24 @@ enum class ControlMode : uint8_t {
 struct UiState {
   DateTime rtcNow;
   bool rtcValid;
+  bool usbConnected;  // a host has the USB serial port open
 
-  int rawPot;
-  float potNorm;
-  float potScaled;
-  float potFiltered;
+  // Knob values are Q16 fractions so the light task stays integer-only;
+  // they become floats only in reports and telemetry.
+  int rawPot;              // filtered ADC counts
+  uint16_t potNormQ16;     // rawPot / 4095
+  uint16_t potScaledQ16;   // newest sample, inverted if set, times MAX_BRIGHTNESS
+  uint16_t potFilteredQ16; // knob level times MAX_BRIGHTNESS
 
   int brightnessPercent;
-  int duty;
-  bool lightOn;
+  int duty;      // main channel
+  bool lightOn;  // any channel
+  uint8_t channelCount;
+  UiChannel channels[kUiMaxChannels];
 
   bool scheduleAllowed;
   bool forceOn;
-  float gate;
+  uint32_t gateQ16;  // main schedule level, 65536 = full
   ControlMode controlMode;
 
   char nextEvent[16];
@@ -33,9 +47,26 @@ struct UiState {
   float humidityPercent;
   bool hasTempF;
   float temperatureF;
+  // 24 h extremes of the trusted reading.
+  bool hasRange;
+  float temperatureMinF;
+  float temperatureMaxF;
+  float humidityMin;
+  float humidityMax;
+
+  // SHT3x heater diagnostics.
+  bool sensorPresent;
+  bool heaterOn;
+  uint8_t heaterPulsesLastHour;
+  unsigned long heaterLastMs;  // 0 = never
+  bool wetStuck;
+  bool condensationFault;
+  unsigned long sensorErrors;  // CRC + bus
 
+  // Set by AlertEngine from the trusted reading.
   bool needsWatering;
   bool tooCold;
   bool tooHot;
+  // The last reset was a brownout: the USB supply cannot carry the load.
   bool usbPowerLimited;
 };
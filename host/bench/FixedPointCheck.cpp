@@ -0,0 +1,236 @@
+// Checks the integer light-control path against a floating-point
+// reference and times one light-task frame of each.
+//
+// The reference is the float pipeline the firmware used to run (knob
+// counts / 4095, schedule level as from + slope * t, gate and knob
+// mapping as products of fractions), evaluated in double precision with
+// one rounding per stage. At these magnitudes that rounding cannot cross
+// an integer, so the floor of each stage is the true value and the
+// fixed-point stages must match it bit for bit. The same formulas in
+// float32, as they ran on the device, are reported alongside.
+//
+//   tlc_fixed_check        exits 1 on any mismatch
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cmath>
+
+#include "HostHarness.h"
+#include "LedDimmer.h"
+#include "LightChannels.h"
+#include "LightSchedule.h"
+#include "PotSampler.h"
+#include "RTClib.h"
+
+namespace {
+
+constexpr uint8_t kPotPin = 1;
+// As in the sketch.
+constexpr float kMaxBrightness = 0.70f;
+constexpr uint16_t kMaxBrightnessQ16 = static_cast<uint16_t>(kMaxBrightness * 65535.0f + 0.5f);
+
+struct Tally {
+  const char* name;
+  uint64_t cases;
+  uint64_t mismatches;     // fixed point vs reference
+  uint64_t floatDiffers;   // float32 vs reference
+  uint32_t floatMaxDiff;
+};
+
+uint32_t absDiff(uint32_t a, uint32_t b) {
+  return a > b ? a - b : b - a;
+}
+
+void record(Tally& t, uint32_t fixed, uint32_t ref, uint32_t f32) {
+  t.cases++;
+  if (fixed != ref) {
+    if (t.mismatches < 5) {
+      printf("  %s: fixed=%u reference=%u\n", t.name, fixed, ref);
+    }
+    t.mismatches++;
+  }
+  const uint32_t d = absDiff(f32, ref);
+  if (d != 0) t.floatDiffers++;
+  if (d > t.floatMaxDiff) t.floatMaxDiff = d;
+}
+
+void report(const Tally& t) {
+  printf("%-16s %10llu %10llu %12llu %10u\n", t.name, static_cast<unsigned long long>(t.cases),
+         static_cast<unsigned long long>(t.mismatches), static_cast<unsigned long long>(t.floatDiffers),
+         t.floatMaxDiff);
+}
+
+// ---- Reference (double) and device (float32) formulas ----
+
+uint32_t refKnobQ16(uint32_t counts) {
+  return static_cast<uint32_t>(std::floor(counts * 65535.0 / 4095.0));
+}
+
+uint32_t f32KnobQ16(uint32_t counts) {
+  const float x = (counts / 4095.0f) * kMaxBrightness;
+  return static_cast<uint32_t>(x * (65535.0f / kMaxBrightness));
+}
+
+uint32_t refGateQ16(const LightSchedule::Segment& seg, uint32_t elapsedS) {
+  const double durationS = seg.durationMin * 60.0;
+  const double permilleS = seg.fromLevel * durationS + (static_cast<double>(seg.toLevel) - seg.fromLevel) * elapsedS;
+  return static_cast<uint32_t>(std::floor(permilleS * 65536.0 / (1000.0 * durationS)));
+}
+
+uint32_t f32GateQ16(const LightSchedule::Segment& seg, uint32_t elapsedS) {
+  const float from = seg.fromLevel / 1000.0f;
+  const float slope = (static_cast<float>(seg.toLevel) - seg.fromLevel) / (1000.0f * (seg.durationMin * 60U));
+  const float level = from + slope * static_cast<float>(elapsedS);
+  if (level <= 0.0f) return 0;
+  return level >= 1.0f ? 65536U : static_cast<uint32_t>(level * 65536.0f);
+}
+
+uint32_t refLevel(uint32_t low, uint32_t high, uint32_t knob, uint32_t gate) {
+  const double k = knob / 65536.0;
+  const double mapped = std::floor(low * (1.0 - k) + high * k);
+  const double level = std::floor(mapped * (gate / 65536.0));
+  return static_cast<uint32_t>(level > 65535.0 ? 65535.0 : level);
+}
+
+uint32_t f32Level(uint32_t low, uint32_t high, uint32_t knob, uint32_t gate) {
+  const float k = knob / 65536.0f;
+  const float level = (low + (static_cast<float>(high) - low) * k) * (gate / 65536.0f);
+  return static_cast<uint32_t>(level > 65535.0f ? 65535.0f : level);
+}
+
+// ---- Checks ----
+
+Tally checkKnob() {
+  Tally t{"knob", 0, 0, 0, 0};
+  PotSampler sampler;
+  sampler.begin(kPotPin, 3600, 8);
+  for (uint32_t c = 0; c <= PotSampler::kMaxCounts; ++c) {
+    host::setAnalogValue(kPotPin, static_cast<uint16_t>(c));
+    host::advanceUs(40000);
+    sampler.update();
+    record(t, sampler.getLevelQ16(), refKnobQ16(c), f32KnobQ16(c));
+  }
+  return t;
+}
+
+const LightSchedule::Segment kRamps[] = {
+    {LightSchedule::kAllDays, 6 * 60, 30, 0, 1000},
+    {LightSchedule::kAllDays, 6 * 60, 45, 1000, 0},
+    {LightSchedule::kAllDays, 6 * 60, 1440, 137, 862},
+    {LightSchedule::kAllDays, 6 * 60, 7, 999, 1},
+    {LightSchedule::kAllDays, 6 * 60, 60, 250, 250},
+    {LightSchedule::kAllDays, 6 * 60, 1, 3, 997},
+};
+
+Tally checkGate() {
+  Tally t{"schedule gate", 0, 0, 0, 0};
+  const uint32_t dayUnix = DateTime(2026, 1, 1, 0, 0, 0).unixtime();
+  LightSchedule sched;
+  sched.begin(kRamps, 1, "fxchk");
+  for (const LightSchedule::Segment& seg : kRamps) {
+    sched.setSegments(&seg, 1);
+    const uint32_t startUnix = dayUnix + seg.startMin * 60U;
+    for (uint32_t s = 0; s < seg.durationMin * 60U; ++s) {
+      const LightSchedule::State st = sched.evaluate(startUnix + s);
+      record(t, st.levelQ16, refGateQ16(seg, s), f32GateQ16(seg, s));
+    }
+  }
+  return t;
+}
+
+Tally checkLevel() {
+  Tally t{"channel level", 0, 0, 0, 0};
+  const uint32_t ends[] = {0, 6553, 32768, 65535};
+  for (uint32_t low : ends) {
+    for (uint32_t high : ends) {
+      for (uint32_t gate = 0; gate <= 65536; gate += 4099) {
+        for (uint32_t knob = 0; knob <= 65535; ++knob) {
+          record(t, LightChannels::levelFor(low, high, knob, gate), refLevel(low, high, knob, gate),
+                 f32Level(low, high, knob, gate));
+        }
+      }
+    }
+  }
+  return t;
+}
+
+// Knob counts through a sunrise ramp to the (undithered) duty.
+Tally checkDuty() {
+  Tally t{"duty", 0, 0, 0, 0};
+  const LightSchedule::Segment& seg = kRamps[0];
+  const uint32_t dayUnix = DateTime(2026, 1, 1, 0, 0, 0).unixtime();
+  const uint32_t startUnix = dayUnix + seg.startMin * 60U;
+  LightSchedule sched;
+  sched.begin(&seg, 1, "fxchk");
+  sched.setSegments(&seg, 1);
+  const LedDimmer dimmer(kMaxBrightnessQ16, LedDimmer::Curve::Cie);
+  for (uint32_t s = 0; s < seg.durationMin * 60U; s += 3) {
+    const uint32_t gate = sched.evaluate(startUnix + s).levelQ16;
+    for (uint32_t c = 0; c <= PotSampler::kMaxCounts; c += 5) {
+      const uint32_t knob = c * 65535U / PotSampler::kMaxCounts;  // PotSampler with a steady input
+      const uint32_t fixed = dimmer.dutyFor(LightChannels::levelFor(0, 65535, knob, gate));
+      const uint32_t ref = dimmer.dutyFor(static_cast<uint16_t>(refLevel(0, 65535, refKnobQ16(c), refGateQ16(seg, s))));
+      const uint32_t f32 = dimmer.dutyFor(static_cast<uint16_t>(f32Level(0, 65535, f32KnobQ16(c), f32GateQ16(seg, s))));
+      record(t, fixed, ref, f32);
+    }
+  }
+  return t;
+}
+
+// ---- Frame timing ----
+
+volatile uint32_t gSink;
+
+// One light-task frame of arithmetic, as the float firmware ran it.
+uint32_t floatFrame(uint32_t raw, uint32_t gateQ16, float& filtered) {
+  const float norm = raw / 4095.0f;
+  const float x = norm * kMaxBrightness;
+  filtered = 0.90f * filtered + 0.10f * x;
+  const uint32_t knob = static_cast<uint32_t>(filtered * (65535.0f / kMaxBrightness));
+  const float level = knob * (gateQ16 / 65536.0f);
+  const int percent = static_cast<int>((x / kMaxBrightness) * 100.0f + 0.5f);
+  return static_cast<uint32_t>(level) + static_cast<uint32_t>(percent) + static_cast<uint32_t>(norm * 1000.0f);
+}
+
+// The same frame in fixed point (the mean of medians stands in for the IIR).
+uint32_t fixedFrame(uint32_t sum, uint32_t gateQ16) {
+  const uint32_t knob = sum * 65535U / (PotSampler::kMaxCounts * 8U);
+  const uint32_t level = LightChannels::levelFor(0, 65535, knob, gateQ16);
+  const uint32_t percent = (knob * 100U + 32767U) / 65535U;
+  const uint32_t scaled = knob * kMaxBrightnessQ16 / 65535U;
+  return level + percent + scaled;
+}
+
+template <typename F>
+double nsPerFrame(F frame) {
+  constexpr uint32_t kFrames = 2000000;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kFrames; ++i) {
+    gSink = frame(i);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / kFrames;
+}
+
+}  // namespace
+
+int main() {
+  printf("Fixed point vs reference (mismatches must be 0; float32 columns are informational)\n\n");
+  printf("%-16s %10s %10s %12s %10s\n", "stage", "cases", "mismatch", "f32 differs", "f32 maxLsb");
+  const Tally tallies[] = {checkKnob(), checkGate(), checkLevel(), checkDuty()};
+  uint64_t mismatches = 0;
+  for (const Tally& t : tallies) {
+    report(t);
+    mismatches += t.mismatches;
+  }
+
+  float filtered = 0.0f;
+  const double floatNs = nsPerFrame([&](uint32_t i) { return floatFrame(i & 4095U, 40000U + (i & 1023U), filtered); });
+  const double fixedNs = nsPerFrame([](uint32_t i) { return fixedFrame((i & 4095U) * 8U, 40000U + (i & 1023U)); });
+  printf("\nFrame arithmetic on this host: float %.1f ns, fixed %.1f ns\n", floatNs, fixedNs);
+  printf("(the host has an FPU; on the ESP32-C3 every float op above is a soft-float library call)\n");
+
+  printf("\n%s\n", mismatches == 0 ? "PASS" : "FAIL");
+  return mismatches == 0 ? 0 : 1;
+}
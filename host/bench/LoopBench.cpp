@@ -0,0 +1,248 @@
+// Runs the firmware's setup()/loop() against the host fakes and reports
+// per-stage latency percentiles. Two numbers are reported per stage:
+//   - host CPU time of the stage's code, and
+//   - modelled time on the virtual clock (I2C wire time and blocking
+//     delays inside the stage), which is what the MCU would spend waiting.
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "HostDevices.h"
+#include "HostHarness.h"
+#include "LoopProfiler.h"
+#include "RTClib.h"
+#include "TaskScheduler.h"
+
+void setup();
+void loop();
+extern TaskScheduler scheduler;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kStageCount = static_cast<size_t>(LoopStage::Count);
+const char* const kStageNames[kStageCount] = {
+    "console", "pot read", "rtc gating", "sht3x update", "display update", "pwm write", "ui state",
+};
+
+struct StageAccum {
+  bool ran;
+  uint64_t cpuNs;
+  uint64_t virtUs;
+};
+
+struct StageSamples {
+  std::vector<uint64_t> cpuNs;
+  std::vector<uint64_t> virtUs;
+};
+
+StageAccum gAccum[kStageCount];
+int gCurrent = -1;
+Clock::time_point gCpuStart;
+uint64_t gVirtStart = 0;
+
+void closeStage() {
+  if (gCurrent < 0) {
+    return;
+  }
+  const uint64_t cpu =
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - gCpuStart).count());
+  StageAccum& acc = gAccum[gCurrent];
+  acc.ran = true;
+  acc.cpuNs += cpu;
+  acc.virtUs += host::nowUs() - gVirtStart;
+  gCurrent = -1;
+}
+
+uint64_t percentile(std::vector<uint64_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t idx = static_cast<size_t>(p * static_cast<double>(v.size()));
+  if (idx >= v.size()) idx = v.size() - 1;
+  std::nth_element(v.begin(), v.begin() + static_cast<long>(idx), v.end());
+  return v[idx];
+}
+
+uint64_t maxOf(const std::vector<uint64_t>& v) {
+  return v.empty() ? 0 : *std::max_element(v.begin(), v.end());
+}
+
+struct Options {
+  unsigned long loops = 20000;
+  bool display = true;
+  bool sht3x = true;
+  uint32_t i2cOverheadUs = 0;
+  uint32_t seed = 1;
+};
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strcmp(a, "--loops") == 0 && i + 1 < argc) {
+      opt.loops = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(a, "--no-display") == 0) {
+      opt.display = false;
+    } else if (strcmp(a, "--no-sht3x") == 0) {
+      opt.sht3x = false;
+    } else if (strcmp(a, "--i2c-overhead-us") == 0 && i + 1 < argc) {
+      opt.i2cOverheadUs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(a, "--seed") == 0 && i + 1 < argc) {
+      opt.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else {
+      fprintf(stderr,
+              "usage: %s [--loops N] [--no-display] [--no-sht3x] [--i2c-overhead-us N] [--seed N]\n",
+              argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+void printDevice(const char* name, uint8_t address) {
+  const host::I2cDeviceStats st = host::i2cStats(address);
+  printf("  %-8s 0x%02X  txn=%-8llu bytes=%-9llu nacks=%-6llu bus=%.1f ms\n", name, address,
+         static_cast<unsigned long long>(st.transactions), static_cast<unsigned long long>(st.bytes),
+         static_cast<unsigned long long>(st.nacks), static_cast<double>(st.busUs) / 1000.0);
+}
+
+}  // namespace
+
+void loopProfileBegin(LoopStage stage) {
+  closeStage();
+  gCurrent = static_cast<int>(stage);
+  gVirtStart = host::nowUs();
+  gCpuStart = Clock::now();
+}
+
+void loopProfileEnd() {
+  closeStage();
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    return 2;
+  }
+
+  host::setI2cTransactionOverheadUs(opt.i2cOverheadUs);
+
+  host::VirtualDs3231 rtcDevice;
+  rtcDevice.setUnixTime(DateTime(2026, 1, 1, 10, 0, 0).unixtime());
+  host::attachI2cDevice(&rtcDevice);
+
+  host::VirtualSht3x shtDevice;
+  if (opt.sht3x) host::attachI2cDevice(&shtDevice);
+
+  host::VirtualSsd1306 oledDevice;
+  if (opt.display) host::attachI2cDevice(&oledDevice);
+
+  // Slow triangle sweep over the knob range with a little ADC noise.
+  uint32_t lcg = opt.seed;
+  host::setAnalogSource([&lcg](uint8_t, uint64_t nowUs) -> uint16_t {
+    const uint64_t periodUs = 40ULL * 1000000ULL;
+    const uint64_t phase = nowUs % periodUs;
+    const uint64_t half = periodUs / 2;
+    int value = static_cast<int>((phase < half ? phase : periodUs - phase) * 4095ULL / half);
+    lcg = lcg * 1664525u + 1013904223u;
+    value += static_cast<int>((lcg >> 24) % 13) - 6;
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+    return static_cast<uint16_t>(value);
+  });
+
+  setup();
+  host::resetI2cStats();
+  host::resetSerialStats();
+  scheduler.resetStats();
+
+  StageSamples samples[kStageCount];
+  std::vector<uint64_t> loopCpuNs;
+  std::vector<uint64_t> loopVirtUs;
+  loopCpuNs.reserve(opt.loops);
+  loopVirtUs.reserve(opt.loops);
+  for (StageSamples& s : samples) {
+    s.cpuNs.reserve(opt.loops);
+    s.virtUs.reserve(opt.loops);
+  }
+  // From here on the bench itself allocates nothing, so heap traffic is the
+  // firmware's (and the fakes').
+  host::resetHeapStats();
+
+  const uint64_t virtStart = host::nowUs();
+  for (unsigned long i = 0; i < opt.loops; ++i) {
+    memset(gAccum, 0, sizeof(gAccum));
+    loop();
+    uint64_t cpu = 0;
+    uint64_t virt = 0;
+    for (size_t s = 0; s < kStageCount; ++s) {
+      if (!gAccum[s].ran) continue;
+      samples[s].cpuNs.push_back(gAccum[s].cpuNs);
+      samples[s].virtUs.push_back(gAccum[s].virtUs);
+      cpu += gAccum[s].cpuNs;
+      virt += gAccum[s].virtUs;
+    }
+    loopCpuNs.push_back(cpu);
+    loopVirtUs.push_back(virt);
+  }
+  const host::HeapStats heap = host::heapStats();
+  const uint32_t minFreeHeap = ESP.getMinFreeHeap();
+  const uint32_t largestBlock = ESP.getMaxAllocHeap();
+  const double virtSeconds = static_cast<double>(host::nowUs() - virtStart) / 1e6;
+
+  printf("Loop benchmark: %lu iterations, %.1f s virtual time (display=%s, sht3x=%s)\n\n", opt.loops,
+         virtSeconds, opt.display ? "on" : "off", opt.sht3x ? "on" : "off");
+  printf("%-15s %8s | %28s | %24s\n", "", "", "host CPU ns", "modelled us");
+  printf("%-15s %8s | %6s %6s %6s %7s | %7s %7s %8s\n", "stage", "runs", "p50", "p90", "p99", "max", "p50",
+         "p99", "max");
+  auto row = [](const char* name, std::vector<uint64_t>& cpu, std::vector<uint64_t>& virt) {
+    printf("%-15s %8zu | %6llu %6llu %6llu %7llu | %7llu %7llu %8llu\n", name, cpu.size(),
+           static_cast<unsigned long long>(percentile(cpu, 0.50)),
+           static_cast<unsigned long long>(percentile(cpu, 0.90)),
+           static_cast<unsigned long long>(percentile(cpu, 0.99)), static_cast<unsigned long long>(maxOf(cpu)),
+           static_cast<unsigned long long>(percentile(virt, 0.50)),
+           static_cast<unsigned long long>(percentile(virt, 0.99)),
+           static_cast<unsigned long long>(maxOf(virt)));
+  };
+  for (size_t s = 0; s < kStageCount; ++s) {
+    row(kStageNames[s], samples[s].cpuNs, samples[s].virtUs);
+  }
+  row("loop total", loopCpuNs, loopVirtUs);
+
+  printf("\nI2C traffic:\n");
+  printDevice("ds3231", rtcDevice.address());
+  printDevice("sht3x", shtDevice.address());
+  printDevice("ssd1306", oledDevice.address());
+  const host::I2cDeviceStats total = host::i2cTotals();
+  printf("  total         txn=%-8llu bytes=%-9llu bus=%.1f ms (%.2f%% of virtual time)\n",
+         static_cast<unsigned long long>(total.transactions), static_cast<unsigned long long>(total.bytes),
+         static_cast<double>(total.busUs) / 1000.0,
+         virtSeconds > 0.0 ? static_cast<double>(total.busUs) / (virtSeconds * 1e4) : 0.0);
+
+  printf("\nScheduler tasks:\n");
+  printf("  %-8s %9s %8s %8s %8s %8s %9s\n", "task", "periodMs", "budgetUs", "runs", "overruns", "maxUs",
+         "lateMaxMs");
+  for (size_t i = 0; i < scheduler.getTaskCount(); ++i) {
+    const TaskScheduler::TaskStats st = scheduler.getTaskStats(i);
+    printf("  %-8s %9lu %8lu %8lu %8lu %8lu %9lu\n", st.name, st.periodMs, st.budgetUs, st.runs, st.overruns,
+           st.maxRunUs, st.maxLateMs);
+  }
+  printf("  idle: %.1f%% of virtual time asleep\n",
+         virtSeconds > 0.0 ? static_cast<double>(scheduler.getSleptMs()) / (virtSeconds * 10.0) : 0.0);
+
+  printf("\nHeap during the loop: %llu allocations, %llu frees, net %lld bytes; minFree=%u largest=%u\n",
+         static_cast<unsigned long long>(heap.allocations), static_cast<unsigned long long>(heap.frees),
+         static_cast<long long>(heap.liveBytes), minFreeHeap, largestBlock);
+
+  const host::AdcStats adc = host::adcStats();
+  printf("\nPot ADC: %llu analogRead calls, %llu DMA samples, %llu dropped\n",
+         static_cast<unsigned long long>(adc.analogReads), static_cast<unsigned long long>(adc.dmaSamples),
+         static_cast<unsigned long long>(adc.dmaDropped));
+
+  const host::SerialStats serial = host::serialStats();
+  printf("\nConsole: %llu write calls, %llu bytes\n", static_cast<unsigned long long>(serial.writeCalls),
+         static_cast<unsigned long long>(serial.bytes));
+  return 0;
+}
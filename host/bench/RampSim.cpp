@@ -0,0 +1,213 @@
+// Runs the firmware through each sunrise/sunset ramp of every light
+// channel's schedule with the knob held still and samples that channel's
+// duty after every loop pass (the light task runs every 10 ms). For each
+// ramp it reports how the output was driven (LEDC writes vs hardware
+// fades), the largest duty jump between samples and the largest error
+// against the ideal ramp through the channel's curve.
+//
+//   tlc_ramp_sim [--pot 0..4095] [--csv] [--max-jump N]
+//
+// With --max-jump it exits 1 if any ramp steps its duty by more than N
+// between two samples, which would show as a visible jump. It always exits
+// 1 if a fade was started while another was still running, which blocks
+// the caller on real hardware.
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ClockService.h"
+#include "HostDevices.h"
+#include "HostHarness.h"
+#include "LightChannels.h"
+#include "LoopProfiler.h"
+#include "RTClib.h"
+
+void setup();
+void loop();
+extern ClockService clockService;
+extern LightChannels lights;
+
+namespace {
+
+constexpr uint8_t kPotPin = 1;
+// Lead-in before each ramp, so the clock resync and the knob filter settle.
+constexpr uint32_t kLeadInS = 60;
+
+struct Options {
+  uint16_t pot = 4095;
+  bool csv = false;
+  uint32_t maxJump = UINT32_MAX;
+};
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strcmp(a, "--pot") == 0 && i + 1 < argc) {
+      const unsigned long pot = strtoul(argv[++i], nullptr, 10);
+      opt.pot = static_cast<uint16_t>(pot > 4095 ? 4095 : pot);
+    } else if (strcmp(a, "--csv") == 0) {
+      opt.csv = true;
+    } else if (strcmp(a, "--max-jump") == 0 && i + 1 < argc) {
+      opt.maxJump = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else {
+      fprintf(stderr, "usage: %s [--pot 0..4095] [--csv] [--max-jump N]\n", argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+struct RampReport {
+  uint32_t samples;
+  uint32_t dutyChanges;
+  uint32_t writes;
+  uint32_t fades;
+  uint32_t fadeStops;
+  uint32_t fadeRejects;
+  uint32_t maxJump;
+  uint32_t maxError;
+  double maxErrorAtS;
+};
+
+struct Ramp {
+  size_t channel;
+  size_t segment;
+  LightSchedule::Segment seg;
+};
+
+// Duty the ramp should show at wallS (fractional unix seconds).
+uint32_t idealDuty(const Ramp& ramp, double startS, double wallS, uint32_t knobQ16) {
+  const LightChannels::Config& cfg = lights.getConfig(ramp.channel);
+  double frac = (wallS - startS) / (ramp.seg.durationMin * 60.0);
+  if (frac < 0.0) frac = 0.0;
+  if (frac > 1.0) frac = 1.0;
+  const double permille = ramp.seg.fromLevel + (static_cast<double>(ramp.seg.toLevel) - ramp.seg.fromLevel) * frac;
+  const double mapped = cfg.knobLowQ16 + (static_cast<double>(cfg.knobHighQ16) - cfg.knobLowQ16) * knobQ16 / 65536.0;
+  const double level = mapped * permille / 1000.0;
+  return lights.dimmer(ramp.channel).dutyFor(static_cast<uint16_t>(level > 65535.0 ? 65535.0 : level));
+}
+
+}  // namespace
+
+void loopProfileBegin(LoopStage) {}
+void loopProfileEnd() {}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    return 2;
+  }
+
+  const uint32_t dayUnix = DateTime(2026, 1, 1, 0, 0, 0).unixtime();
+  host::VirtualDs3231 rtcDevice;
+  rtcDevice.setUnixTime(dayUnix);
+  host::attachI2cDevice(&rtcDevice);
+  host::setAnalogValue(kPotPin, opt.pot);
+
+  setup();
+  const uint32_t knobQ16 = static_cast<uint32_t>(opt.pot) * 65535U / 4095U;
+
+  if (opt.csv) {
+    printf("channel,segment,seconds,duty,ideal\n");
+  } else {
+    printf("Ramp simulation: pot=%u, %s LEDC fades\n\n", opt.pot,
+           PwmOutput::kHardwareFade ? "hardware" : "no");
+    printf("%-8s %-3s %-5s %6s %8s %8s %7s %6s %6s %8s %8s\n", "channel", "seg", "start", "secs", "samples",
+           "changes", "writes", "fades", "stops", "maxJump", "maxError");
+  }
+
+  // Every ramp of every channel, in time order so the clock only runs forward.
+  std::vector<Ramp> ramps;
+  for (size_t c = 0; c < lights.getCount(); ++c) {
+    LightSchedule& sched = lights.schedule(c);
+    for (size_t i = 0; i < sched.getSegmentCount(); ++i) {
+      const LightSchedule::Segment seg = sched.getSegment(i);
+      if (seg.fromLevel != seg.toLevel) {
+        ramps.push_back(Ramp{c, i, seg});
+      }
+    }
+  }
+  std::stable_sort(ramps.begin(), ramps.end(),
+                   [](const Ramp& a, const Ramp& b) { return a.seg.startMin < b.seg.startMin; });
+
+  uint32_t doneUnix = 0;
+  bool jumpTooLarge = false;
+  uint32_t fadeRejects = 0;
+  for (const Ramp& ramp : ramps) {
+    const LightSchedule::Segment& seg = ramp.seg;
+    const uint8_t pin = lights.getConfig(ramp.channel).pin;
+    const uint32_t startUnix = dayUnix + seg.startMin * 60U;
+    const uint32_t endUnix = startUnix + seg.durationMin * 60U;
+
+    if (startUnix - kLeadInS < doneUnix) {
+      printf("%-8s %-3zu overlaps the previous ramp; skipped\n", lights.getConfig(ramp.channel).name, ramp.segment);
+      continue;
+    }
+    // Jump the RTC to just before the ramp and let the sketch resync.
+    rtcDevice.setUnixTime(startUnix - kLeadInS);
+    clockService.requestResync();
+    const uint64_t jumpUs = host::nowUs();
+    auto wallS = [&]() {
+      return (startUnix - kLeadInS) + static_cast<double>(host::nowUs() - jumpUs) / 1e6;
+    };
+    while (wallS() < startUnix) {
+      loop();
+    }
+
+    const host::LedcPin before = host::ledcState(pin);
+    RampReport r{};
+    uint32_t lastDuty = before.duty;
+    while (wallS() < endUnix) {
+      loop();
+      const double wall = wallS();
+      const uint32_t duty = host::ledcState(pin).duty;
+      const uint32_t ideal = idealDuty(ramp, startUnix, wall, knobQ16);
+      const uint32_t jump = duty > lastDuty ? duty - lastDuty : lastDuty - duty;
+      const uint32_t error = duty > ideal ? duty - ideal : ideal - duty;
+      r.samples++;
+      if (jump != 0) r.dutyChanges++;
+      if (jump > r.maxJump) r.maxJump = jump;
+      if (error > r.maxError) {
+        r.maxError = error;
+        r.maxErrorAtS = wall - startUnix;
+      }
+      lastDuty = duty;
+      if (opt.csv) {
+        printf("%s,%zu,%.3f,%u,%u\n", lights.getConfig(ramp.channel).name, ramp.segment, wall - startUnix, duty,
+               ideal);
+      }
+    }
+    doneUnix = endUnix;
+    if (r.maxJump > opt.maxJump) jumpTooLarge = true;
+    const host::LedcPin after = host::ledcState(pin);
+    r.writes = after.writes - before.writes;
+    r.fades = after.fades - before.fades;
+    r.fadeStops = after.fadeStops - before.fadeStops;
+    r.fadeRejects = after.fadeRejects - before.fadeRejects;
+    fadeRejects += r.fadeRejects;
+
+    if (!opt.csv) {
+      printf("%-8s %-3zu %02u:%02u %6u %8u %8u %7u %6u %6u %8u %5u @%.0fs\n", lights.getConfig(ramp.channel).name,
+             ramp.segment, seg.startMin / 60, seg.startMin % 60, seg.durationMin * 60U, r.samples, r.dutyChanges,
+             r.writes, r.fades, r.fadeStops, r.maxJump, r.maxError, r.maxErrorAtS);
+    }
+  }
+
+  if (!opt.csv) {
+    if (ramps.empty()) {
+      printf("(no ramp segments in the schedule)\n");
+    }
+    printf("\nDuty is %d-bit; errors are against each channel's curve evaluated continuously.\n", LedDimmer::kDutyBits);
+  }
+  if (fadeRejects != 0) {
+    fprintf(stderr, "%u fades were started over a running fade\n", fadeRejects);
+    return 1;
+  }
+  if (jumpTooLarge) {
+    fprintf(stderr, "a ramp stepped its duty by more than %u\n", opt.maxJump);
+    return 1;
+  }
+  return 0;
+}
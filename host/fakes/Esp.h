@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+// Heap queries of the Arduino-ESP32 EspClass. On the host they report a
+// modelled heap of host::kHeapBytes from which every malloc()/new the
+// process makes after host::resetHeapStats() is charged (see HostHeap.cpp).
+// The model does not fragment, so the largest block equals the free heap.
+class EspClass {
+ public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
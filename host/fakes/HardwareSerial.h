@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Stream.h"
+
+// USB-CDC console. Output goes to the host sink (see HostHarness.h);
+// input is queued by the harness.
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud);
+  void end();
+
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
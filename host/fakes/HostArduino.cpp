@@ -0,0 +1,609 @@
+#include <Arduino.h>
+
+#include <string.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "HostHarness.h"
+#include "driver/ledc.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_system.h"
+
+namespace {
+
+uint64_t gNowUs = 0;
+host::AnalogSource gAnalogSource;
+std::map<uint8_t, uint16_t> gAnalogValues;
+host::AdcStats gAdcStats{0, 0, 0};
+esp_reset_reason_t gResetReason = ESP_RST_POWERON;
+std::map<uint8_t, host::LedcPin> gLedc;
+
+// Fade timing per pin, kept out of LedcPin so the harness sees only the
+// resulting duty.
+struct LedcFade {
+  uint32_t startDuty;
+  uint64_t startUs;
+  uint64_t durationUs;
+};
+std::map<uint8_t, LedcFade> gLedcFades;
+std::map<uint8_t, uint8_t> gDigital;
+
+bool gSerialEcho = false;
+bool gSerialCapture = false;
+std::string gSerialOutput;
+std::deque<char> gSerialInput;
+host::SerialStats gSerialStats{0, 0};
+
+uint16_t analogSample(uint8_t pin, uint64_t atUs) {
+  if (gAnalogSource) {
+    return gAnalogSource(pin, atUs);
+  }
+  auto it = gAnalogValues.find(pin);
+  return it == gAnalogValues.end() ? 0 : it->second;
+}
+
+// Brings a fading pin's duty up to the current virtual time.
+void advanceFade(uint8_t pin, host::LedcPin& state) {
+  if (!state.fading) {
+    return;
+  }
+  const LedcFade& fade = gLedcFades[pin];
+  const uint64_t elapsed = gNowUs - fade.startUs;
+  if (elapsed >= fade.durationUs) {
+    state.duty = state.fadeTarget;
+    state.fading = false;
+    return;
+  }
+  const int64_t span = static_cast<int64_t>(state.fadeTarget) - fade.startDuty;
+  state.duty = static_cast<uint32_t>(fade.startDuty + span * static_cast<int64_t>(elapsed) /
+                                                          static_cast<int64_t>(fade.durationUs));
+}
+
+}  // namespace
+
+namespace host {
+
+uint64_t nowUs() {
+  return gNowUs;
+}
+
+void setNowUs(uint64_t us) {
+  gNowUs = us;
+}
+
+void advanceUs(uint64_t us) {
+  gNowUs += us;
+}
+
+void setAnalogSource(AnalogSource source) {
+  gAnalogSource = std::move(source);
+}
+
+void setAnalogValue(uint8_t pin, uint16_t value) {
+  gAnalogValues[pin] = value;
+}
+
+AdcStats adcStats() {
+  return gAdcStats;
+}
+
+void resetAdcStats() {
+  gAdcStats = AdcStats{0, 0, 0};
+}
+
+void setResetReason(int reason) {
+  gResetReason = static_cast<esp_reset_reason_t>(reason);
+}
+
+LedcPin ledcState(uint8_t pin) {
+  auto it = gLedc.find(pin);
+  if (it == gLedc.end()) {
+    return LedcPin{};
+  }
+  advanceFade(pin, it->second);
+  return it->second;
+}
+
+void setSerialEcho(bool echo) {
+  gSerialEcho = echo;
+}
+
+void setSerialCapture(bool capture) {
+  gSerialCapture = capture;
+}
+
+std::string takeSerialOutput() {
+  // Copy rather than swap: the capture buffer keeps its capacity, so the
+  // firmware's prints do not show up as heap allocations.
+  std::string out = gSerialOutput;
+  gSerialOutput.clear();
+  return out;
+}
+
+void pushSerialInput(const char* text) {
+  while (text != nullptr && *text != '\0') {
+    gSerialInput.push_back(*text++);
+  }
+}
+
+SerialStats serialStats() {
+  return gSerialStats;
+}
+
+void resetSerialStats() {
+  gSerialStats = SerialStats{0, 0};
+}
+
+}  // namespace host
+
+// ---- Time ----
+
+unsigned long millis() {
+  return static_cast<unsigned long>(gNowUs / 1000ULL);
+}
+
+unsigned long micros() {
+  return static_cast<unsigned long>(gNowUs);
+}
+
+void delay(unsigned long ms) {
+  gNowUs += static_cast<uint64_t>(ms) * 1000ULL;
+}
+
+void delayMicroseconds(unsigned int us) {
+  gNowUs += us;
+}
+
+void yield() {}
+
+// ---- GPIO / ADC ----
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  gDigital[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+  auto it = gDigital.find(pin);
+  return it == gDigital.end() ? LOW : it->second;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  gAdcStats.analogReads++;
+  return analogSample(pin, gNowUs);
+}
+
+void analogReadResolution(uint8_t bits) {
+  (void)bits;
+}
+
+// ---- LEDC ----
+
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution) {
+  return ledcAttachChannel(pin, freq, resolution, pin);
+}
+
+bool ledcAttachChannel(uint8_t pin, uint32_t freq, uint8_t resolution, uint8_t channel) {
+  host::LedcPin& state = gLedc[pin];
+  state.attached = true;
+  state.freq = freq;
+  state.resolution = resolution;
+  state.channel = channel;
+  state.duty = 0;
+  state.fading = false;
+  // The fade slot is made here so a first fade inside loop() does not show
+  // up as a heap allocation.
+  gLedcFades[pin] = LedcFade{0, 0, 0};
+  return true;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+  auto it = gLedc.find(pin);
+  if (it == gLedc.end() || !it->second.attached) {
+    return false;
+  }
+  it->second.fading = false;
+  it->second.duty = duty;
+  it->second.writes++;
+  return true;
+}
+
+bool ledcFade(uint8_t pin, uint32_t start_duty, uint32_t target_duty, int max_fade_time_ms) {
+  auto it = gLedc.find(pin);
+  if (it == gLedc.end() || !it->second.attached || max_fade_time_ms <= 0) {
+    return false;
+  }
+  host::LedcPin& state = it->second;
+  // The real driver blocks on the channel's fade lock until the running
+  // fade ends; refuse instead so callers that do not stop it first show up.
+  advanceFade(pin, state);
+  if (state.fading) {
+    state.fadeRejects++;
+    return false;
+  }
+  state.duty = start_duty;
+  state.fadeTarget = target_duty;
+  state.fading = true;
+  state.fades++;
+  gLedcFades[pin] = LedcFade{start_duty, gNowUs, static_cast<uint64_t>(max_fade_time_ms) * 1000ULL};
+  return true;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel) {
+  (void)speed_mode;
+  for (auto& entry : gLedc) {
+    host::LedcPin& state = entry.second;
+    if (state.attached && state.channel == channel) {
+      advanceFade(entry.first, state);
+      if (state.fading) {
+        state.fading = false;
+        state.fadeStops++;
+      }
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_INVALID_ARG;
+}
+
+uint32_t ledcRead(uint8_t pin) {
+  return host::ledcState(pin).duty;
+}
+
+// ---- ADC (continuous) ----
+
+struct adc_continuous_ctx_t {
+  uint32_t poolSamples;
+  uint32_t frameSamples;
+  uint8_t pin;
+  uint32_t freqHz;
+  bool configured;
+  bool running;
+  uint64_t nextConvUs;            // time of the next conversion
+  // TYPE2 results in a ring sized at new_handle(), like the driver's
+  // pool, so steady-state conversion allocates nothing.
+  std::vector<uint32_t> pool;
+  size_t poolHead;   // oldest result
+  size_t poolCount;
+};
+
+namespace {
+
+// Runs the converter up to the current virtual time.
+void adcConvert(adc_continuous_ctx_t& ctx) {
+  if (!ctx.running) {
+    return;
+  }
+  const uint64_t periodUs = 1000000ULL / ctx.freqHz;
+  while (ctx.nextConvUs <= gNowUs) {
+    adc_digi_output_data_t out{};
+    out.type2.data = analogSample(ctx.pin, ctx.nextConvUs) & 0x0FFF;
+    out.type2.channel = ctx.pin;
+    out.type2.unit = 0;
+    if (ctx.poolCount == ctx.poolSamples) {
+      ctx.poolHead = (ctx.poolHead + 1) % ctx.poolSamples;
+      ctx.poolCount--;
+      gAdcStats.dmaDropped++;
+    }
+    ctx.pool[(ctx.poolHead + ctx.poolCount) % ctx.poolSamples] = out.val;
+    ctx.poolCount++;
+    ctx.nextConvUs += periodUs;
+  }
+}
+
+}  // namespace
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t* hdl_config, adc_continuous_handle_t* ret_handle) {
+  if (hdl_config == nullptr || ret_handle == nullptr || hdl_config->conv_frame_size == 0 ||
+      hdl_config->conv_frame_size % SOC_ADC_DIGI_RESULT_BYTES != 0 ||
+      hdl_config->max_store_buf_size < hdl_config->conv_frame_size) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  adc_continuous_ctx_t* ctx = new adc_continuous_ctx_t{};
+  ctx->poolSamples = hdl_config->max_store_buf_size / SOC_ADC_DIGI_RESULT_BYTES;
+  ctx->frameSamples = hdl_config->conv_frame_size / SOC_ADC_DIGI_RESULT_BYTES;
+  ctx->pool.assign(ctx->poolSamples, 0);
+  *ret_handle = ctx;
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t* config) {
+  if (handle == nullptr || config == nullptr || config->pattern_num != 1 || config->adc_pattern == nullptr ||
+      config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH ||
+      config->format != ADC_DIGI_OUTPUT_FORMAT_TYPE2) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (handle->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  handle->pin = config->adc_pattern[0].channel;  // ADC1 channel n is GPIOn on the C3
+  handle->freqHz = config->sample_freq_hz;
+  handle->configured = true;
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) {
+  if (handle == nullptr || !handle->configured || handle->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  handle->running = true;
+  handle->nextConvUs = gNowUs;
+  handle->poolHead = 0;
+  handle->poolCount = 0;
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) {
+  if (handle == nullptr || !handle->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  adcConvert(*handle);
+  handle->running = false;
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t* buf, uint32_t length_max, uint32_t* out_length,
+                              uint32_t timeout_ms) {
+  if (handle == nullptr || buf == nullptr || out_length == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  adcConvert(*handle);
+  // The DMA hands over whole conversion frames only.
+  const size_t frames = handle->poolCount / handle->frameSamples;
+  size_t count = frames * handle->frameSamples;
+  const size_t room = length_max / SOC_ADC_DIGI_RESULT_BYTES;
+  if (count > room) count = room;
+  if (count == 0) {
+    *out_length = 0;
+    if (timeout_ms > 0) delay(timeout_ms);
+    return ESP_ERR_TIMEOUT;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    memcpy(buf + i * SOC_ADC_DIGI_RESULT_BYTES, &handle->pool[handle->poolHead], SOC_ADC_DIGI_RESULT_BYTES);
+    handle->poolHead = (handle->poolHead + 1) % handle->poolSamples;
+  }
+  handle->poolCount -= count;
+  gAdcStats.dmaSamples += count;
+  *out_length = static_cast<uint32_t>(count * SOC_ADC_DIGI_RESULT_BYTES);
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle) {
+  if (handle == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (handle->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  delete handle;
+  return ESP_OK;
+}
+
+esp_err_t adc_continuous_io_to_channel(int io_num, adc_unit_t* unit, adc_channel_t* channel) {
+  if (io_num < 0 || io_num > 4 || unit == nullptr || channel == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *unit = ADC_UNIT_1;
+  *channel = static_cast<adc_channel_t>(io_num);
+  return ESP_OK;
+}
+
+// ---- Print ----
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++) == 0) break;
+    n++;
+  }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper* str) {
+  return print(reinterpret_cast<const char*>(str));
+}
+
+size_t Print::print(const char str[]) {
+  return write(str);
+}
+
+size_t Print::print(char c) {
+  return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return printNumber(n, static_cast<uint8_t>(base));
+}
+
+size_t Print::print(int n, int base) {
+  return printSigned(n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return printNumber(n, static_cast<uint8_t>(base));
+}
+
+size_t Print::print(long n, int base) {
+  return printSigned(n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return printNumber(n, static_cast<uint8_t>(base));
+}
+
+size_t Print::print(long long n, int base) {
+  return printSigned(n, base);
+}
+
+size_t Print::print(unsigned long long n, int base) {
+  return printNumber(n, static_cast<uint8_t>(base));
+}
+
+size_t Print::print(double n, int digits) {
+  return printFloat(n, static_cast<uint8_t>(digits));
+}
+
+size_t Print::println(const __FlashStringHelper* str) {
+  size_t n = print(str);
+  return n + println();
+}
+
+size_t Print::println(const char str[]) {
+  size_t n = print(str);
+  return n + println();
+}
+
+size_t Print::println(char c) {
+  size_t n = print(c);
+  return n + println();
+}
+
+size_t Print::println(unsigned char v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(int v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(unsigned int v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(long v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(unsigned long v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(long long v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(unsigned long long v, int base) {
+  size_t n = print(v, base);
+  return n + println();
+}
+
+size_t Print::println(double v, int digits) {
+  size_t n = print(v, digits);
+  return n + println();
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long long n, uint8_t base) {
+  char buf[8 * sizeof(n) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    char c = static_cast<char>(n % base);
+    n /= base;
+    *--str = c < 10 ? static_cast<char>(c + '0') : static_cast<char>(c + 'A' - 10);
+  } while (n);
+  return write(str);
+}
+
+size_t Print::printSigned(long long n, int base) {
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber(static_cast<unsigned long long>(-n), 10);
+  }
+  return printNumber(static_cast<unsigned long long>(n), static_cast<uint8_t>(base));
+}
+
+size_t Print::printFloat(double number, uint8_t digits) {
+  size_t n = 0;
+  if (isnan(number)) return print("nan");
+  if (isinf(number)) return print("inf");
+  if (number > 4294967040.0) return print("ovf");
+  if (number < -4294967040.0) return print("ovf");
+
+  if (number < 0.0) {
+    n += print('-');
+    number = -number;
+  }
+
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) {
+    rounding /= 10.0;
+  }
+  number += rounding;
+
+  unsigned long intPart = static_cast<unsigned long>(number);
+  double remainder = number - static_cast<double>(intPart);
+  n += print(intPart);
+
+  if (digits > 0) {
+    n += print('.');
+  }
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int toPrint = static_cast<unsigned int>(remainder);
+    n += print(toPrint);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+// ---- Serial ----
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+  (void)baud;
+}
+
+void HardwareSerial::end() {}
+
+int HardwareSerial::available() {
+  return static_cast<int>(gSerialInput.size());
+}
+
+int HardwareSerial::read() {
+  if (gSerialInput.empty()) return -1;
+  char c = gSerialInput.front();
+  gSerialInput.pop_front();
+  return static_cast<uint8_t>(c);
+}
+
+int HardwareSerial::peek() {
+  if (gSerialInput.empty()) return -1;
+  return static_cast<uint8_t>(gSerialInput.front());
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  gSerialStats.writeCalls++;
+  gSerialStats.bytes += size;
+  if (gSerialCapture) {
+    gSerialOutput.append(reinterpret_cast<const char*>(buffer), size);
+  }
+  if (gSerialEcho) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+  return gResetReason;
+}
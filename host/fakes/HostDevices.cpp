@@ -0,0 +1,446 @@
+#include "HostDevices.h"
+
+#include <RTClib.h>
+
+namespace host {
+
+namespace {
+
+uint8_t bcd2bin(uint8_t val) {
+  return val - 6 * (val >> 4);
+}
+
+uint8_t bin2bcd(uint8_t val) {
+  return val + 6 * (val / 10);
+}
+
+uint8_t sensirionCrc(const uint8_t* data, size_t len) {
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31) : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------- DS3231
+
+VirtualDs3231::VirtualDs3231()
+    : baseUs_(0),
+      baseUnix_(DateTime(2026, 1, 1, 8, 0, 0).unixtime()),
+      driftPpm_(0.0),
+      pointer_(0),
+      pendingTime_{0},
+      pendingMask_(0),
+      control_(0x1C),
+      status_(0x00) {
+  baseUs_ = nowUs();
+}
+
+void VirtualDs3231::setUnixTime(uint32_t unixSeconds) {
+  baseUs_ = nowUs();
+  baseUnix_ = unixSeconds;
+}
+
+uint32_t VirtualDs3231::unixTime() const {
+  const double elapsedUs = static_cast<double>(nowUs() - baseUs_) * (1.0 + driftPpm_ * 1e-6);
+  return baseUnix_ + static_cast<uint32_t>(elapsedUs / 1e6);
+}
+
+void VirtualDs3231::setDriftPpm(double ppm) {
+  baseUnix_ = unixTime();
+  baseUs_ = nowUs();
+  driftPpm_ = ppm;
+}
+
+void VirtualDs3231::setLostPower(bool lost) {
+  if (lost) {
+    status_ |= 0x80;
+  } else {
+    status_ &= static_cast<uint8_t>(~0x80);
+  }
+}
+
+bool VirtualDs3231::onWrite(const uint8_t* data, size_t len) {
+  if (len == 0) {
+    return true;
+  }
+  pointer_ = data[0];
+  pendingMask_ = 0;
+  for (size_t i = 1; i < len; ++i) {
+    writeRegister(pointer_, data[i]);
+    pointer_ = static_cast<uint8_t>((pointer_ + 1) % 0x13);
+  }
+  if (pendingMask_ != 0) {
+    uint8_t regs[7];
+    for (uint8_t r = 0; r < 7; ++r) {
+      regs[r] = (pendingMask_ & (1u << r)) ? pendingTime_[r] : readRegister(r);
+    }
+    DateTime dt(bcd2bin(regs[6]) + 2000U, bcd2bin(regs[5] & 0x7F), bcd2bin(regs[4]), bcd2bin(regs[2]),
+                bcd2bin(regs[1]), bcd2bin(regs[0] & 0x7F));
+    setUnixTime(dt.unixtime());
+    pendingMask_ = 0;
+  }
+  return true;
+}
+
+size_t VirtualDs3231::onRead(uint8_t* out, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    out[i] = readRegister(pointer_);
+    pointer_ = static_cast<uint8_t>((pointer_ + 1) % 0x13);
+  }
+  return len;
+}
+
+uint8_t VirtualDs3231::readRegister(uint8_t reg) const {
+  if (reg < 7) {
+    DateTime now(unixTime());
+    switch (reg) {
+      case 0: return bin2bcd(now.second());
+      case 1: return bin2bcd(now.minute());
+      case 2: return bin2bcd(now.hour());
+      case 3: return bin2bcd(static_cast<uint8_t>(now.dayOfTheWeek() == 0 ? 7 : now.dayOfTheWeek()));
+      case 4: return bin2bcd(now.day());
+      case 5: return bin2bcd(now.month());
+      default: return bin2bcd(static_cast<uint8_t>(now.year() - 2000U));
+    }
+  }
+  if (reg == 0x0E) return control_;
+  if (reg == 0x0F) return status_;
+  if (reg == 0x11) return 25;
+  return 0;
+}
+
+void VirtualDs3231::writeRegister(uint8_t reg, uint8_t value) {
+  if (reg < 7) {
+    pendingTime_[reg] = value;
+    pendingMask_ |= static_cast<uint8_t>(1u << reg);
+  } else if (reg == 0x0E) {
+    control_ = value;
+  } else if (reg == 0x0F) {
+    // OSF can only be cleared by software.
+    status_ = static_cast<uint8_t>((status_ & value & 0x80) | (value & 0x7F));
+  }
+}
+
+// ---------------------------------------------------------------- SHT3x
+
+VirtualSht3x::VirtualSht3x(uint8_t address)
+    : address_(address),
+      model_(),
+      pending_(Pending::None),
+      heaterOn_(false),
+      periodic_(false),
+      periodUs_(0),
+      periodicStartUs_(0),
+      lastFetchedSampleUs_(0),
+      readyAtUs_(0),
+      data_{0},
+      dataValid_(false),
+      measurements_(0),
+      heaterPulses_(0) {
+  setEnvironment(24.0f, 55.0f);
+}
+
+void VirtualSht3x::setEnvironment(EnvironmentModel model) {
+  model_ = std::move(model);
+}
+
+void VirtualSht3x::setEnvironment(float temperatureC, float humidity) {
+  model_ = [temperatureC, humidity](uint64_t) { return Environment{temperatureC, humidity}; };
+}
+
+VirtualSht3x::Environment VirtualSht3x::environment() const {
+  return model_(nowUs());
+}
+
+VirtualSht3x::Environment VirtualSht3x::sample() const {
+  Environment env = environment();
+  if (heaterOn_) {
+    // The on-chip heater lifts the die a few degrees and dries it out.
+    env.temperatureC += 3.0f;
+    env.humidity *= 0.82f;
+  }
+  if (env.humidity < 0.0f) env.humidity = 0.0f;
+  if (env.humidity > 100.0f) env.humidity = 100.0f;
+  return env;
+}
+
+void VirtualSht3x::latchMeasurement() {
+  const Environment env = sample();
+  double st = (env.temperatureC + 45.0) / 175.0 * 65535.0;
+  double srh = env.humidity / 100.0 * 65535.0;
+  if (st < 0.0) st = 0.0;
+  if (st > 65535.0) st = 65535.0;
+  const uint16_t rawT = static_cast<uint16_t>(st + 0.5);
+  const uint16_t rawH = static_cast<uint16_t>(srh + 0.5);
+  data_[0] = static_cast<uint8_t>(rawT >> 8);
+  data_[1] = static_cast<uint8_t>(rawT & 0xFF);
+  data_[2] = sensirionCrc(&data_[0], 2);
+  data_[3] = static_cast<uint8_t>(rawH >> 8);
+  data_[4] = static_cast<uint8_t>(rawH & 0xFF);
+  data_[5] = sensirionCrc(&data_[3], 2);
+  dataValid_ = true;
+  measurements_++;
+}
+
+bool VirtualSht3x::onWrite(const uint8_t* data, size_t len) {
+  if (len < 2) {
+    return len == 0;
+  }
+  const uint16_t cmd = static_cast<uint16_t>((data[0] << 8) | data[1]);
+  const uint8_t msb = data[0];
+
+  if (periodic_ && cmd != 0xE000 && cmd != 0x3093 && cmd != 0x30A2 && cmd != 0x306D && cmd != 0x3066 &&
+      cmd != 0xF32D && cmd != 0x3041) {
+    // Datasheet: only fetch/break/reset/heater/status are accepted in periodic mode.
+    return false;
+  }
+
+  switch (cmd) {
+    case 0x2400: case 0x2C06: readyAtUs_ = nowUs() + 15500; break;
+    case 0x240B: case 0x2C0D: readyAtUs_ = nowUs() + 6500; break;
+    case 0x2416: case 0x2C10: readyAtUs_ = nowUs() + 4500; break;
+    case 0xE000:
+      pending_ = Pending::Measurement;
+      return true;
+    case 0x3093:
+      periodic_ = false;
+      pending_ = Pending::None;
+      return true;
+    case 0x30A2:
+      periodic_ = false;
+      heaterOn_ = false;
+      pending_ = Pending::None;
+      dataValid_ = false;
+      return true;
+    case 0x306D:
+      if (!heaterOn_) heaterPulses_++;
+      heaterOn_ = true;
+      return true;
+    case 0x3066:
+      heaterOn_ = false;
+      return true;
+    case 0xF32D:
+      pending_ = Pending::Status;
+      return true;
+    case 0x3041:
+      return true;
+    case 0x2B32:
+      periodic_ = true;
+      periodUs_ = 250000;
+      periodicStartUs_ = nowUs();
+      lastFetchedSampleUs_ = 0;
+      return true;
+    default:
+      if (msb == 0x20 || msb == 0x21 || msb == 0x22 || msb == 0x23 || msb == 0x27) {
+        static const uint32_t kPeriods[] = {2000000, 1000000, 500000, 250000};
+        periodic_ = true;
+        periodUs_ = (msb == 0x27) ? 100000 : kPeriods[msb - 0x20];
+        periodicStartUs_ = nowUs();
+        lastFetchedSampleUs_ = 0;
+        return true;
+      }
+      return false;
+  }
+
+  // Single-shot measurement started.
+  pending_ = Pending::Measurement;
+  dataValid_ = false;
+  if (msb == 0x2C) {
+    // Clock stretching: the sensor holds SCL until the conversion is done.
+    readyAtUs_ |= 1ULL << 63;
+  }
+  return true;
+}
+
+size_t VirtualSht3x::onRead(uint8_t* out, size_t len) {
+  if (pending_ == Pending::Status) {
+    pending_ = Pending::None;
+    uint8_t status[3] = {static_cast<uint8_t>(heaterOn_ ? 0x20 : 0x00), 0x00, 0};
+    status[2] = sensirionCrc(status, 2);
+    size_t n = len < 3 ? len : 3;
+    memcpy(out, status, n);
+    return n;
+  }
+  if (pending_ != Pending::Measurement) {
+    return 0;
+  }
+
+  if (periodic_) {
+    const uint64_t now = nowUs();
+    if (now < periodicStartUs_ + periodUs_) {
+      return 0;
+    }
+    const uint64_t n = (now - periodicStartUs_) / periodUs_;
+    const uint64_t sampleUs = periodicStartUs_ + n * periodUs_;
+    if (sampleUs == lastFetchedSampleUs_) {
+      return 0;
+    }
+    lastFetchedSampleUs_ = sampleUs;
+    latchMeasurement();
+  } else {
+    const bool stretch = (readyAtUs_ >> 63) != 0;
+    const uint64_t readyAt = readyAtUs_ & ~(1ULL << 63);
+    if (nowUs() < readyAt) {
+      if (!stretch) {
+        return 0;
+      }
+      advanceUs(readyAt - nowUs());
+    }
+    latchMeasurement();
+  }
+
+  pending_ = Pending::None;
+  size_t n = len < sizeof(data_) ? len : sizeof(data_);
+  memcpy(out, data_, n);
+  return n;
+}
+
+// ---------------------------------------------------------------- SSD1306
+
+VirtualSsd1306::VirtualSsd1306(uint8_t address)
+    : address_(address),
+      ram_{0},
+      cmd_{0},
+      cmdLen_(0),
+      cmdNeed_(0),
+      addressingMode_(2),
+      colStart_(0),
+      colEnd_(kWidth - 1),
+      pageStart_(0),
+      pageEnd_(kPages - 1),
+      col_(0),
+      page_(0),
+      displayOn_(false),
+      contrast_(0x7F),
+      multiplex_(64),
+      segRemap_(false),
+      comReverse_(false),
+      dataBytes_(0),
+      commandBytes_(0) {}
+
+bool VirtualSsd1306::onWrite(const uint8_t* bytes, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    const uint8_t control = bytes[i++];
+    const bool continuation = (control & 0x80) != 0;
+    const bool isData = (control & 0x40) != 0;
+    if (continuation) {
+      if (i < len) {
+        isData ? data(bytes[i]) : command(bytes[i]);
+        ++i;
+      }
+      continue;
+    }
+    for (; i < len; ++i) {
+      isData ? data(bytes[i]) : command(bytes[i]);
+    }
+  }
+  return true;
+}
+
+size_t VirtualSsd1306::onRead(uint8_t* out, size_t len) {
+  if (len == 0) return 0;
+  out[0] = displayOn_ ? 0x00 : 0x40;
+  return 1;
+}
+
+bool VirtualSsd1306::pixel(uint8_t x, uint8_t y) const {
+  if (x >= kWidth || y >= multiplex_) return false;
+  // Modules are wired so that the Adafruit default (remap on, COM reversed)
+  // reads upright.
+  const uint8_t col = segRemap_ ? x : static_cast<uint8_t>(kWidth - 1 - x);
+  const uint8_t row = comReverse_ ? y : static_cast<uint8_t>(multiplex_ - 1 - y);
+  return (ram_[(row / 8) * kWidth + col] >> (row & 7)) & 1;
+}
+
+void VirtualSsd1306::command(uint8_t byte) {
+  commandBytes_++;
+  if (cmdNeed_ > 0) {
+    cmd_[cmdLen_++] = byte;
+    if (--cmdNeed_ > 0) {
+      return;
+    }
+  } else {
+    cmd_[0] = byte;
+    cmdLen_ = 1;
+    switch (byte) {
+      case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        cmdNeed_ = 1;
+        return;
+      case 0x21: case 0x22: case 0xA3:
+        cmdNeed_ = 2;
+        return;
+      case 0x29: case 0x2A:
+        cmdNeed_ = 5;
+        return;
+      case 0x26: case 0x27:
+        cmdNeed_ = 6;
+        return;
+      default:
+        break;
+    }
+  }
+
+  const uint8_t op = cmd_[0];
+  switch (op) {
+    case 0x20: addressingMode_ = cmd_[1] & 0x03; break;
+    case 0x21:
+      colStart_ = cmd_[1] & 0x7F;
+      colEnd_ = cmd_[2] & 0x7F;
+      col_ = colStart_;
+      break;
+    case 0x22:
+      pageStart_ = cmd_[1] & 0x07;
+      pageEnd_ = cmd_[2] & 0x07;
+      page_ = pageStart_;
+      break;
+    case 0x81: contrast_ = cmd_[1]; break;
+    case 0xA8: multiplex_ = static_cast<uint8_t>((cmd_[1] & 0x3F) + 1); break;
+    case 0xA0: segRemap_ = false; break;
+    case 0xA1: segRemap_ = true; break;
+    case 0xC0: comReverse_ = false; break;
+    case 0xC8: comReverse_ = true; break;
+    case 0xAE: displayOn_ = false; break;
+    case 0xAF: displayOn_ = true; break;
+    default:
+      if (op >= 0xB0 && op <= 0xB7) {
+        page_ = op & 0x07;
+      } else if (op <= 0x0F) {
+        col_ = static_cast<uint8_t>((col_ & 0xF0) | op);
+      } else if (op >= 0x10 && op <= 0x1F) {
+        col_ = static_cast<uint8_t>((col_ & 0x0F) | ((op & 0x0F) << 4));
+      }
+      break;
+  }
+  cmdLen_ = 0;
+}
+
+void VirtualSsd1306::data(uint8_t byte) {
+  dataBytes_++;
+  ram_[page_ * kWidth + (col_ & 0x7F)] = byte;
+  if (addressingMode_ == 0) {
+    if (col_ >= colEnd_) {
+      col_ = colStart_;
+      page_ = (page_ >= pageEnd_) ? pageStart_ : static_cast<uint8_t>(page_ + 1);
+    } else {
+      col_++;
+    }
+  } else if (addressingMode_ == 1) {
+    if (page_ >= pageEnd_) {
+      page_ = pageStart_;
+      col_ = (col_ >= colEnd_) ? colStart_ : static_cast<uint8_t>(col_ + 1);
+    } else {
+      page_++;
+    }
+  } else {
+    col_ = static_cast<uint8_t>((col_ + 1) & 0x7F);
+  }
+}
+
+}  // namespace host
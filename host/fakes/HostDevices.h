@@ -0,0 +1,136 @@
+#pragma once
+
+// Register-level models of the I2C peripherals on the lid: DS3231 RTC,
+// SHT3x humidity sensor and SSD1306 OLED panel. Harness programs attach
+// them with host::attachI2cDevice().
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+
+#include "HostHarness.h"
+
+namespace host {
+
+class VirtualDs3231 : public I2cDevice {
+ public:
+  VirtualDs3231();
+
+  uint8_t address() const override { return 0x68; }
+  bool onWrite(const uint8_t* data, size_t len) override;
+  size_t onRead(uint8_t* out, size_t len) override;
+
+  // Sets the wall clock (seconds since 1970) as of the current virtual time.
+  void setUnixTime(uint32_t unixSeconds);
+  uint32_t unixTime() const;
+  // Oscillator error relative to the virtual clock, in parts per million.
+  void setDriftPpm(double ppm);
+  void setLostPower(bool lost);
+
+ private:
+  uint8_t readRegister(uint8_t reg) const;
+  void writeRegister(uint8_t reg, uint8_t value);
+
+  uint64_t baseUs_;
+  uint32_t baseUnix_;
+  double driftPpm_;
+  uint8_t pointer_;
+  uint8_t pendingTime_[7];
+  uint8_t pendingMask_;
+  uint8_t control_;
+  uint8_t status_;
+};
+
+class VirtualSht3x : public I2cDevice {
+ public:
+  struct Environment {
+    float temperatureC;
+    float humidity;
+  };
+  using EnvironmentModel = std::function<Environment(uint64_t nowUs)>;
+
+  explicit VirtualSht3x(uint8_t address = 0x44);
+
+  uint8_t address() const override { return address_; }
+  bool onWrite(const uint8_t* data, size_t len) override;
+  size_t onRead(uint8_t* out, size_t len) override;
+
+  void setEnvironment(EnvironmentModel model);
+  void setEnvironment(float temperatureC, float humidity);
+  // What the model gives at the current virtual time, before the heater.
+  Environment environment() const;
+  bool heaterOn() const { return heaterOn_; }
+  uint32_t measurementCount() const { return measurements_; }
+  uint32_t heaterPulseCount() const { return heaterPulses_; }
+
+ private:
+  enum class Pending : uint8_t { None, Status, Measurement };
+
+  void latchMeasurement();
+  Environment sample() const;
+
+  uint8_t address_;
+  EnvironmentModel model_;
+  Pending pending_;
+  bool heaterOn_;
+  bool periodic_;
+  uint32_t periodUs_;
+  uint64_t periodicStartUs_;
+  uint64_t lastFetchedSampleUs_;
+  uint64_t readyAtUs_;
+  uint8_t data_[6];
+  bool dataValid_;
+  uint32_t measurements_;
+  uint32_t heaterPulses_;
+};
+
+class VirtualSsd1306 : public I2cDevice {
+ public:
+  static constexpr uint8_t kWidth = 128;
+  static constexpr uint8_t kPages = 8;
+
+  explicit VirtualSsd1306(uint8_t address = 0x3C);
+
+  uint8_t address() const override { return address_; }
+  bool onWrite(const uint8_t* data, size_t len) override;
+  size_t onRead(uint8_t* out, size_t len) override;
+
+  // GDDRAM as the controller holds it (page-major, LSB = top row).
+  const uint8_t* ram() const { return ram_; }
+  // Pixel as seen on the glass after segment remap / COM scan direction.
+  bool pixel(uint8_t x, uint8_t y) const;
+  bool displayOn() const { return displayOn_; }
+  uint8_t contrast() const { return contrast_; }
+  uint8_t rows() const { return multiplex_; }
+  bool segmentRemap() const { return segRemap_; }
+  bool comScanReversed() const { return comReverse_; }
+  uint64_t dataBytes() const { return dataBytes_; }
+  uint64_t commandBytes() const { return commandBytes_; }
+
+ private:
+  void command(uint8_t byte);
+  void data(uint8_t byte);
+
+  uint8_t address_;
+  uint8_t ram_[kWidth * kPages];
+  uint8_t cmd_[7];
+  uint8_t cmdLen_;
+  uint8_t cmdNeed_;
+  uint8_t addressingMode_;
+  uint8_t colStart_;
+  uint8_t colEnd_;
+  uint8_t pageStart_;
+  uint8_t pageEnd_;
+  uint8_t col_;
+  uint8_t page_;
+  bool displayOn_;
+  uint8_t contrast_;
+  uint8_t multiplex_;
+  bool segRemap_;
+  bool comReverse_;
+  uint64_t dataBytes_;
+  uint64_t commandBytes_;
+};
+
+}  // namespace host
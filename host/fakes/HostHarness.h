@@ -0,0 +1,112 @@
+#pragma once
+
+// Host-side control surface for the Arduino fakes. The firmware never
+// includes this; harness programs (bench, simulator) use it to drive
+// virtual time, the potentiometer, the console and the I2C devices.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+namespace host {
+
+// ---- Virtual clock ----
+// millis()/micros() read this clock. delay() and modelled I2C bus time
+// advance it; host CPU time never does.
+uint64_t nowUs();
+void setNowUs(uint64_t us);
+void advanceUs(uint64_t us);
+
+// ---- ADC ----
+// analogRead() and the continuous (DMA) driver both sample this source; the
+// continuous driver at its own conversion times on the virtual clock.
+using AnalogSource = std::function<uint16_t(uint8_t pin, uint64_t nowUs)>;
+void setAnalogSource(AnalogSource source);
+void setAnalogValue(uint8_t pin, uint16_t value);
+
+struct AdcStats {
+  uint64_t analogReads;  // blocking single conversions
+  uint64_t dmaSamples;   // continuous conversions handed to the firmware
+  uint64_t dmaDropped;   // continuous conversions lost to a full pool
+};
+AdcStats adcStats();
+void resetAdcStats();
+
+// ---- Heap ----
+// malloc()/new calls are counted from the last resetHeapStats(); ESP's heap
+// queries report kHeapBytes minus the bytes allocated since then.
+constexpr uint32_t kHeapBytes = 280 * 1024;  // typical free heap after boot
+struct HeapStats {
+  uint64_t allocations;
+  uint64_t frees;
+  int64_t liveBytes;  // since the reset
+  int64_t peakBytes;
+};
+HeapStats heapStats();
+void resetHeapStats();
+
+// ---- Reset reason ----
+// What esp_reset_reason() reports; set it before the firmware's setup().
+void setResetReason(int reason);
+
+// ---- LEDC ----
+struct LedcPin {
+  bool attached;
+  uint32_t freq;
+  uint8_t resolution;
+  uint8_t channel;
+  uint32_t duty;  // at the current virtual time, mid-fade included
+  uint32_t writes;
+  bool fading;
+  uint32_t fadeTarget;
+  uint32_t fades;
+  uint32_t fadeStops;
+  uint32_t fadeRejects;  // ledcFade() while a fade ran (blocks on hardware)
+};
+LedcPin ledcState(uint8_t pin);
+
+// ---- Console ----
+struct SerialStats {
+  uint64_t writeCalls;
+  uint64_t bytes;
+};
+void setSerialEcho(bool echo);
+void setSerialCapture(bool capture);
+std::string takeSerialOutput();
+void pushSerialInput(const char* text);
+SerialStats serialStats();
+void resetSerialStats();
+
+// ---- I2C ----
+class I2cDevice {
+ public:
+  virtual ~I2cDevice() = default;
+  virtual uint8_t address() const = 0;
+  // One write transaction (START, address+W, data..., STOP). Returning false
+  // NACKs the data phase.
+  virtual bool onWrite(const uint8_t* data, size_t len) = 0;
+  // One read transaction. Returns the number of bytes supplied; 0 NACKs the
+  // address phase.
+  virtual size_t onRead(uint8_t* out, size_t len) = 0;
+};
+
+struct I2cDeviceStats {
+  uint64_t transactions;
+  uint64_t bytes;
+  uint64_t nacks;
+  uint64_t busUs;
+};
+
+void attachI2cDevice(I2cDevice* device);
+void detachI2cDevice(uint8_t address);
+I2cDevice* findI2cDevice(uint8_t address);
+I2cDeviceStats i2cStats(uint8_t address);
+I2cDeviceStats i2cTotals();
+void resetI2cStats();
+uint32_t i2cClockHz();
+// Fixed software/driver cost charged per transaction on top of wire time.
+void setI2cTransactionOverheadUs(uint32_t us);
+
+}  // namespace host
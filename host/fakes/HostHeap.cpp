@@ -0,0 +1,104 @@
+// Counts the process's heap traffic for the ESP heap queries. malloc() and
+// friends are interposed over glibc's (operator new goes through malloc),
+// so firmware and fakes are both counted; harnesses reset the counters
+// after their own setup.
+
+#include <Esp.h>
+#include <malloc.h>
+
+#include "HostHarness.h"
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+EspClass ESP;
+
+namespace {
+
+host::HeapStats gHeap{};
+
+void charge(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  gHeap.allocations++;
+  gHeap.liveBytes += static_cast<int64_t>(malloc_usable_size(ptr));
+  if (gHeap.liveBytes > gHeap.peakBytes) {
+    gHeap.peakBytes = gHeap.liveBytes;
+  }
+}
+
+void release(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  gHeap.frees++;
+  gHeap.liveBytes -= static_cast<int64_t>(malloc_usable_size(ptr));
+}
+
+uint32_t modelFree(int64_t used) {
+  if (used <= 0) return host::kHeapBytes;
+  return used >= host::kHeapBytes ? 0 : host::kHeapBytes - static_cast<uint32_t>(used);
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  charge(ptr);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  charge(ptr);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+  release(ptr);
+  void* out = __libc_realloc(ptr, size);
+  charge(out);
+  return out;
+}
+
+void free(void* ptr) {
+  release(ptr);
+  __libc_free(ptr);
+}
+
+}  // extern "C"
+
+uint32_t EspClass::getHeapSize() {
+  return host::kHeapBytes;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return modelFree(gHeap.liveBytes);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return modelFree(gHeap.peakBytes);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap();
+}
+
+namespace host {
+
+HeapStats heapStats() {
+  return gHeap;
+}
+
+void resetHeapStats() {
+  gHeap = HeapStats{};
+}
+
+}  // namespace host
@@ -0,0 +1,131 @@
+#include "esp_partition.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "HostHarness.h"
+
+namespace {
+
+constexpr uint32_t kSectorSize = 4096;
+constexpr uint32_t kDefaultSize = 0xE0000;
+
+struct Flash {
+  esp_partition_t partition;
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> sectorErases;
+  host::FlashStats stats;
+  uint32_t eraseUs;
+
+  Flash() : partition{}, stats{}, eraseUs(45000) {
+    partition.type = ESP_PARTITION_TYPE_DATA;
+    partition.subtype = static_cast<esp_partition_subtype_t>(0x40);
+    partition.address = 0x310000;
+    partition.erase_size = kSectorSize;
+    strcpy(partition.label, "history");
+    resize(kDefaultSize);
+  }
+
+  void resize(uint32_t size) {
+    partition.size = size;
+    data.assign(size, 0xFF);
+    sectorErases.assign(size / kSectorSize, 0);
+  }
+};
+
+Flash& flash() {
+  static Flash f;
+  return f;
+}
+
+bool inRange(const esp_partition_t* partition, size_t offset, size_t size) {
+  return partition == &flash().partition && offset <= partition->size && size <= partition->size - offset;
+}
+
+}  // namespace
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+  const esp_partition_t& p = flash().partition;
+  if (type != ESP_PARTITION_TYPE_ANY && type != p.type) return nullptr;
+  if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != p.subtype) return nullptr;
+  if (label != nullptr && strcmp(label, p.label) != 0) return nullptr;
+  return &p;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+  if (!inRange(partition, src_offset, size)) return ESP_ERR_INVALID_SIZE;
+  Flash& f = flash();
+  memcpy(dst, f.data.data() + src_offset, size);
+  f.stats.reads++;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+  if (!inRange(partition, dst_offset, size)) return ESP_ERR_INVALID_SIZE;
+  Flash& f = flash();
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < size; ++i) {
+    uint8_t& cell = f.data[dst_offset + i];
+    if ((in[i] & ~cell) != 0) {
+      f.stats.bitSetViolations++;
+    }
+    cell &= in[i];
+  }
+  f.stats.writes++;
+  f.stats.bytesWritten += size;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  if (!inRange(partition, offset, size)) return ESP_ERR_INVALID_SIZE;
+  if (offset % kSectorSize != 0 || size % kSectorSize != 0) return ESP_ERR_INVALID_ARG;
+  Flash& f = flash();
+  memset(f.data.data() + offset, 0xFF, size);
+  for (size_t s = offset / kSectorSize; s < (offset + size) / kSectorSize; ++s) {
+    f.sectorErases[s]++;
+    f.stats.erases++;
+    host::advanceUs(f.eraseUs);
+  }
+  return ESP_OK;
+}
+
+namespace host {
+
+void setFlashPartitionSize(uint32_t size) {
+  flash().resize(size - size % kSectorSize);
+  resetFlashStats();
+}
+
+void clearFlashPartition() {
+  Flash& f = flash();
+  std::fill(f.data.begin(), f.data.end(), 0xFF);
+}
+
+uint8_t* flashPartitionData() {
+  return flash().data.data();
+}
+
+void setFlashEraseUs(uint32_t us) {
+  flash().eraseUs = us;
+}
+
+FlashStats flashStats() {
+  Flash& f = flash();
+  FlashStats st = f.stats;
+  if (!f.sectorErases.empty()) {
+    st.maxSectorErases = *std::max_element(f.sectorErases.begin(), f.sectorErases.end());
+    st.minSectorErases = *std::min_element(f.sectorErases.begin(), f.sectorErases.end());
+  }
+  return st;
+}
+
+void resetFlashStats() {
+  Flash& f = flash();
+  f.stats = FlashStats{};
+  std::fill(f.sectorErases.begin(), f.sectorErases.end(), 0);
+}
+
+}  // namespace host
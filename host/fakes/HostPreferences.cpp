@@ -0,0 +1,120 @@
+#include <Preferences.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Namespace = std::map<std::string, std::vector<uint8_t>>;
+
+std::map<std::string, Namespace>& store() {
+  static std::map<std::string, Namespace> nvs;
+  return nvs;
+}
+
+}  // namespace
+
+namespace host {
+
+void clearPreferences() {
+  store().clear();
+}
+
+}  // namespace host
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+  (void)partitionLabel;
+  if (name == nullptr || strlen(name) >= sizeof(namespace_)) {
+    return false;
+  }
+  strncpy(namespace_, name, sizeof(namespace_) - 1);
+  readOnly_ = readOnly;
+  open_ = true;
+  store()[namespace_];
+  return true;
+}
+
+void Preferences::end() {
+  open_ = false;
+}
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  store()[namespace_].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open_ || readOnly_) return false;
+  return store()[namespace_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!open_) return false;
+  return store()[namespace_].count(key) > 0;
+}
+
+size_t Preferences::put(const char* key, const void* value, size_t len) {
+  if (!open_ || readOnly_ || key == nullptr) return 0;
+  const uint8_t* p = static_cast<const uint8_t*>(value);
+  store()[namespace_][key] = std::vector<uint8_t>(p, p + len);
+  return len;
+}
+
+bool Preferences::get(const char* key, void* out, size_t len) {
+  if (!open_ || key == nullptr) return false;
+  Namespace& ns = store()[namespace_];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.size() != len) return false;
+  memcpy(out, it->second.data(), len);
+  return true;
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) { return put(key, &value, sizeof(value)); }
+size_t Preferences::putUShort(const char* key, uint16_t value) { return put(key, &value, sizeof(value)); }
+size_t Preferences::putInt(const char* key, int32_t value) { return put(key, &value, sizeof(value)); }
+size_t Preferences::putUInt(const char* key, uint32_t value) { return put(key, &value, sizeof(value)); }
+size_t Preferences::putFloat(const char* key, float value) { return put(key, &value, sizeof(value)); }
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) { return put(key, value, len); }
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+  uint8_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue) {
+  uint16_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+  int32_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  uint32_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+  float v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!open_ || key == nullptr) return 0;
+  Namespace& ns = store()[namespace_];
+  auto it = ns.find(key);
+  return it == ns.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  if (!open_ || key == nullptr) return 0;
+  Namespace& ns = store()[namespace_];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
@@ -0,0 +1,231 @@
+#include <RTClib.h>
+
+namespace {
+
+constexpr uint8_t kDs3231Address = 0x68;
+constexpr uint8_t kRegTime = 0x00;
+constexpr uint8_t kRegControl = 0x0E;
+constexpr uint8_t kRegStatus = 0x0F;
+constexpr uint8_t kRegTempMsb = 0x11;
+
+const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30};
+
+uint16_t date2days(uint16_t y, uint8_t m, uint8_t d) {
+  if (y >= 2000U) y -= 2000U;
+  uint16_t days = d;
+  for (uint8_t i = 1; i < m; ++i) days += daysInMonth[i - 1];
+  if (m > 2 && y % 4 == 0) ++days;
+  return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+uint32_t time2ulong(uint16_t days, uint8_t h, uint8_t m, uint8_t s) {
+  return ((days * 24UL + h) * 60 + m) * 60 + s;
+}
+
+uint8_t conv2d(const char* p) {
+  uint8_t v = 0;
+  if ('0' <= *p && *p <= '9') v = *p - '0';
+  return 10 * v + *++p - '0';
+}
+
+uint8_t bcd2bin(uint8_t val) {
+  return val - 6 * (val >> 4);
+}
+
+uint8_t bin2bcd(uint8_t val) {
+  return val + 6 * (val / 10);
+}
+
+}  // namespace
+
+// ---- DateTime ----
+
+DateTime::DateTime(uint32_t t) {
+  t -= SECONDS_FROM_1970_TO_2000;
+  ss = t % 60;
+  t /= 60;
+  mm = t % 60;
+  t /= 60;
+  hh = t % 24;
+  uint16_t days = t / 24;
+  uint8_t leap;
+  for (yOff = 0;; ++yOff) {
+    leap = yOff % 4 == 0;
+    if (days < 365U + leap) break;
+    days -= 365 + leap;
+  }
+  for (m = 1; m < 12; ++m) {
+    uint8_t daysPerMonth = daysInMonth[m - 1];
+    if (leap && m == 2) ++daysPerMonth;
+    if (days < daysPerMonth) break;
+    days -= daysPerMonth;
+  }
+  d = days + 1;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+  if (year >= 2000U) year -= 2000U;
+  yOff = year;
+  m = month;
+  d = day;
+  hh = hour;
+  mm = min;
+  ss = sec;
+}
+
+DateTime::DateTime(const char* date, const char* time) {
+  yOff = conv2d(date + 9);
+  switch (date[0]) {
+    case 'J': m = (date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7); break;
+    case 'F': m = 2; break;
+    case 'A': m = date[2] == 'r' ? 4 : 8; break;
+    case 'M': m = date[2] == 'r' ? 3 : 5; break;
+    case 'S': m = 9; break;
+    case 'O': m = 10; break;
+    case 'N': m = 11; break;
+    case 'D': m = 12; break;
+    default: m = 1; break;
+  }
+  d = conv2d(date + 4);
+  hh = conv2d(time);
+  mm = conv2d(time + 3);
+  ss = conv2d(time + 6);
+}
+
+DateTime::DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time)
+    : DateTime(reinterpret_cast<const char*>(date), reinterpret_cast<const char*>(time)) {}
+
+bool DateTime::isValid() const {
+  if (yOff >= 100) return false;
+  DateTime other(unixtime());
+  return yOff == other.yOff && m == other.m && d == other.d && hh == other.hh && mm == other.mm &&
+         ss == other.ss;
+}
+
+uint8_t DateTime::dayOfTheWeek() const {
+  uint16_t day = date2days(yOff, m, d);
+  return (day + 6) % 7;
+}
+
+uint32_t DateTime::secondstime() const {
+  return time2ulong(date2days(yOff, m, d), hh, mm, ss);
+}
+
+uint32_t DateTime::unixtime() const {
+  return secondstime() + SECONDS_FROM_1970_TO_2000;
+}
+
+DateTime DateTime::operator+(const TimeSpan& span) const {
+  return DateTime(unixtime() + span.totalseconds());
+}
+
+DateTime DateTime::operator-(const TimeSpan& span) const {
+  return DateTime(unixtime() - span.totalseconds());
+}
+
+TimeSpan DateTime::operator-(const DateTime& right) const {
+  return TimeSpan(static_cast<int32_t>(unixtime() - right.unixtime()));
+}
+
+bool DateTime::operator<(const DateTime& right) const {
+  return unixtime() < right.unixtime();
+}
+
+bool DateTime::operator==(const DateTime& right) const {
+  return unixtime() == right.unixtime();
+}
+
+// ---- TimeSpan ----
+
+TimeSpan::TimeSpan(int32_t seconds) : _seconds(seconds) {}
+
+TimeSpan::TimeSpan(int16_t days, int8_t hours, int8_t minutes, int8_t seconds)
+    : _seconds(static_cast<int32_t>(days) * 86400L + static_cast<int32_t>(hours) * 3600 +
+               static_cast<int32_t>(minutes) * 60 + seconds) {}
+
+// ---- RTC_DS3231 ----
+
+bool RTC_DS3231::begin(TwoWire* wireInstance) {
+  wire_ = wireInstance;
+  wire_->beginTransmission(kDs3231Address);
+  return wire_->endTransmission() == 0;
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) {
+  const uint8_t buffer[8] = {kRegTime,
+                             bin2bcd(dt.second()),
+                             bin2bcd(dt.minute()),
+                             bin2bcd(dt.hour()),
+                             bin2bcd(static_cast<uint8_t>(dt.dayOfTheWeek() == 0 ? 7 : dt.dayOfTheWeek())),
+                             bin2bcd(dt.day()),
+                             bin2bcd(dt.month()),
+                             bin2bcd(static_cast<uint8_t>(dt.year() - 2000U))};
+  wire_->beginTransmission(kDs3231Address);
+  wire_->write(buffer, sizeof(buffer));
+  wire_->endTransmission();
+
+  const uint8_t status = readRegister(kRegStatus);
+  writeRegister(kRegStatus, status & static_cast<uint8_t>(~0x80));
+}
+
+bool RTC_DS3231::lostPower() {
+  return (readRegister(kRegStatus) >> 7) != 0;
+}
+
+DateTime RTC_DS3231::now() {
+  uint8_t buffer[7] = {0};
+  wire_->beginTransmission(kDs3231Address);
+  wire_->write(kRegTime);
+  wire_->endTransmission();
+  if (wire_->requestFrom(kDs3231Address, sizeof(buffer)) != sizeof(buffer)) {
+    return DateTime();
+  }
+  for (uint8_t& b : buffer) {
+    b = static_cast<uint8_t>(wire_->read());
+  }
+  return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5] & 0x7F), bcd2bin(buffer[4]),
+                  bcd2bin(buffer[2]), bcd2bin(buffer[1]), bcd2bin(buffer[0] & 0x7F));
+}
+
+Ds3231SqwPinMode RTC_DS3231::readSqwPinMode() {
+  uint8_t mode = readRegister(kRegControl) & 0x1C;
+  if (mode & 0x04) mode = DS3231_OFF;
+  return static_cast<Ds3231SqwPinMode>(mode);
+}
+
+void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {
+  uint8_t ctrl = readRegister(kRegControl);
+  ctrl &= static_cast<uint8_t>(~0x04);
+  ctrl &= static_cast<uint8_t>(~0x18);
+  ctrl |= mode;
+  writeRegister(kRegControl, ctrl);
+}
+
+float RTC_DS3231::getTemperature() {
+  wire_->beginTransmission(kDs3231Address);
+  wire_->write(kRegTempMsb);
+  wire_->endTransmission();
+  if (wire_->requestFrom(kDs3231Address, 2) != 2) {
+    return NAN;
+  }
+  const int8_t msb = static_cast<int8_t>(wire_->read());
+  const uint8_t lsb = static_cast<uint8_t>(wire_->read());
+  return static_cast<float>(msb) + static_cast<float>(lsb >> 6) * 0.25f;
+}
+
+uint8_t RTC_DS3231::readRegister(uint8_t reg) {
+  wire_->beginTransmission(kDs3231Address);
+  wire_->write(reg);
+  wire_->endTransmission();
+  if (wire_->requestFrom(kDs3231Address, 1) != 1) {
+    return 0;
+  }
+  return static_cast<uint8_t>(wire_->read());
+}
+
+void RTC_DS3231::writeRegister(uint8_t reg, uint8_t value) {
+  wire_->beginTransmission(kDs3231Address);
+  wire_->write(reg);
+  wire_->write(value);
+  wire_->endTransmission();
+}
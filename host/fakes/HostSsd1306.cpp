@@ -0,0 +1,200 @@
+#include <Adafruit_SSD1306.h>
+
+namespace {
+
+template <typename T>
+void swapValues(T& a, T& b) {
+  T t = a;
+  a = b;
+  b = t;
+}
+
+}  // namespace
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin, uint32_t clkDuring,
+                                   uint32_t clkAfter)
+    : Adafruit_GFX(w, h),
+      wire(twi ? twi : &Wire),
+      buffer(nullptr),
+      i2caddr(0),
+      vccstate(SSD1306_SWITCHCAPVCC),
+      wireClk(clkDuring),
+      restoreClk(clkAfter) {
+  (void)rst_pin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  if (buffer) {
+    free(buffer);
+    buffer = nullptr;
+  }
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset, bool periphBegin) {
+  (void)reset;
+  if ((!buffer) && !(buffer = static_cast<uint8_t*>(malloc(WIDTH * ((HEIGHT + 7) / 8))))) {
+    return false;
+  }
+  clearDisplay();
+  vccstate = static_cast<int8_t>(vcs);
+  i2caddr = static_cast<int8_t>(addr ? addr : ((HEIGHT == 32) ? 0x3C : 0x3D));
+  if (periphBegin) {
+    wire->begin();
+  }
+
+  // Like the upstream driver, begin() never checks for an ACK: it reports
+  // success whenever the framebuffer could be allocated.
+  wire->setClock(wireClk);
+  static const uint8_t init1[] = {SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80, SSD1306_SETMULTIPLEX};
+  ssd1306_commandList(init1, sizeof(init1));
+  ssd1306_command1(static_cast<uint8_t>(HEIGHT - 1));
+  static const uint8_t init2[] = {SSD1306_SETDISPLAYOFFSET, 0x0, SSD1306_SETSTARTLINE | 0x0, SSD1306_CHARGEPUMP};
+  ssd1306_commandList(init2, sizeof(init2));
+  ssd1306_command1((vccstate == SSD1306_EXTERNALVCC) ? 0x10 : 0x14);
+  static const uint8_t init3[] = {SSD1306_MEMORYMODE, 0x00, SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC};
+  ssd1306_commandList(init3, sizeof(init3));
+
+  uint8_t comPins = 0x02;
+  uint8_t contrast = 0x8F;
+  if ((WIDTH == 128) && (HEIGHT == 64)) {
+    comPins = 0x12;
+    contrast = (vccstate == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF;
+  }
+  ssd1306_command1(SSD1306_SETCOMPINS);
+  ssd1306_command1(comPins);
+  ssd1306_command1(SSD1306_SETCONTRAST);
+  ssd1306_command1(contrast);
+  ssd1306_command1(SSD1306_SETPRECHARGE);
+  ssd1306_command1((vccstate == SSD1306_EXTERNALVCC) ? 0x22 : 0xF1);
+  static const uint8_t init5[] = {SSD1306_SETVCOMDETECT,  0x40, SSD1306_DISPLAYALLON_RESUME,
+                                  SSD1306_NORMALDISPLAY,  SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON};
+  ssd1306_commandList(init5, sizeof(init5));
+  wire->setClock(restoreClk);
+  return true;
+}
+
+void Adafruit_SSD1306::display() {
+  wire->setClock(wireClk);
+  static const uint8_t dlist1[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+  ssd1306_commandList(dlist1, sizeof(dlist1));
+  ssd1306_command1(static_cast<uint8_t>(WIDTH - 1));
+
+  uint16_t count = static_cast<uint16_t>(WIDTH * ((HEIGHT + 7) / 8));
+  const uint8_t* ptr = buffer;
+  wire->beginTransmission(static_cast<uint8_t>(i2caddr));
+  wire->write(static_cast<uint8_t>(0x40));
+  uint16_t bytesOut = 1;
+  while (count--) {
+    if (bytesOut >= I2C_BUFFER_LENGTH) {
+      wire->endTransmission();
+      wire->beginTransmission(static_cast<uint8_t>(i2caddr));
+      wire->write(static_cast<uint8_t>(0x40));
+      bytesOut = 1;
+    }
+    wire->write(*ptr++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i) {
+  wire->setClock(wireClk);
+  ssd1306_command1(i ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::dim(bool dim) {
+  const uint8_t contrast = dim ? 0 : ((vccstate == SSD1306_EXTERNALVCC) ? 0x9F : 0xCF);
+  wire->setClock(wireClk);
+  ssd1306_command1(SSD1306_SETCONTRAST);
+  ssd1306_command1(contrast);
+  wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) {
+    return;
+  }
+  switch (getRotation()) {
+    case 1:
+      swapValues(x, y);
+      x = static_cast<int16_t>(WIDTH - x - 1);
+      break;
+    case 2:
+      x = static_cast<int16_t>(WIDTH - x - 1);
+      y = static_cast<int16_t>(HEIGHT - y - 1);
+      break;
+    case 3:
+      swapValues(x, y);
+      y = static_cast<int16_t>(HEIGHT - y - 1);
+      break;
+    default:
+      break;
+  }
+  uint8_t& cell = buffer[x + (y / 8) * WIDTH];
+  const uint8_t bit = static_cast<uint8_t>(1 << (y & 7));
+  switch (color) {
+    case SSD1306_WHITE: cell |= bit; break;
+    case SSD1306_BLACK: cell &= static_cast<uint8_t>(~bit); break;
+    case SSD1306_INVERSE: cell ^= bit; break;
+    default: break;
+  }
+}
+
+void Adafruit_SSD1306::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  Adafruit_GFX::drawFastHLine(x, y, w, color);
+}
+
+void Adafruit_SSD1306::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  Adafruit_GFX::drawFastVLine(x, y, h, color);
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  wire->setClock(wireClk);
+  ssd1306_command1(c);
+  wire->setClock(restoreClk);
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) {
+    return false;
+  }
+  if (getRotation() == 2) {
+    x = static_cast<int16_t>(WIDTH - x - 1);
+    y = static_cast<int16_t>(HEIGHT - y - 1);
+  }
+  return (buffer[x + (y / 8) * WIDTH] & (1 << (y & 7))) != 0;
+}
+
+uint8_t* Adafruit_SSD1306::getBuffer() {
+  return buffer;
+}
+
+void Adafruit_SSD1306::ssd1306_command1(uint8_t c) {
+  wire->beginTransmission(static_cast<uint8_t>(i2caddr));
+  wire->write(static_cast<uint8_t>(0x00));
+  wire->write(c);
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_commandList(const uint8_t* c, uint8_t n) {
+  wire->beginTransmission(static_cast<uint8_t>(i2caddr));
+  wire->write(static_cast<uint8_t>(0x00));
+  uint16_t bytesOut = 1;
+  while (n--) {
+    if (bytesOut >= I2C_BUFFER_LENGTH) {
+      wire->endTransmission();
+      wire->beginTransmission(static_cast<uint8_t>(i2caddr));
+      wire->write(static_cast<uint8_t>(0x00));
+      bytesOut = 1;
+    }
+    wire->write(*c++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
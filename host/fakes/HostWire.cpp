@@ -0,0 +1,181 @@
+#include <Wire.h>
+
+#include <map>
+
+#include "HostHarness.h"
+
+namespace {
+
+std::map<uint8_t, host::I2cDevice*> gDevices;
+std::map<uint8_t, host::I2cDeviceStats> gStats;
+uint32_t gClockHz = 100000;
+uint32_t gOverheadUs = 0;
+
+// START + address byte + payload (9 clocks per byte incl. ACK) + STOP.
+uint64_t wireTimeUs(size_t payloadBytes) {
+  const uint64_t bits = 2 + 9ULL * (1 + payloadBytes);
+  return (bits * 1000000ULL + gClockHz - 1) / gClockHz + gOverheadUs;
+}
+
+void account(uint8_t address, size_t payloadBytes, bool nack) {
+  const uint64_t us = wireTimeUs(payloadBytes);
+  host::I2cDeviceStats& st = gStats[address];
+  st.transactions++;
+  st.bytes += payloadBytes;
+  st.busUs += us;
+  if (nack) st.nacks++;
+  host::advanceUs(us);
+}
+
+}  // namespace
+
+namespace host {
+
+void attachI2cDevice(I2cDevice* device) {
+  gDevices[device->address()] = device;
+}
+
+void detachI2cDevice(uint8_t address) {
+  gDevices.erase(address);
+}
+
+I2cDevice* findI2cDevice(uint8_t address) {
+  auto it = gDevices.find(address);
+  return it == gDevices.end() ? nullptr : it->second;
+}
+
+I2cDeviceStats i2cStats(uint8_t address) {
+  auto it = gStats.find(address);
+  return it == gStats.end() ? I2cDeviceStats{0, 0, 0, 0} : it->second;
+}
+
+I2cDeviceStats i2cTotals() {
+  I2cDeviceStats total{0, 0, 0, 0};
+  for (const auto& kv : gStats) {
+    total.transactions += kv.second.transactions;
+    total.bytes += kv.second.bytes;
+    total.nacks += kv.second.nacks;
+    total.busUs += kv.second.busUs;
+  }
+  return total;
+}
+
+void resetI2cStats() {
+  // Zero in place: re-inserting devices would allocate mid-run.
+  for (auto& entry : gStats) {
+    entry.second = I2cDeviceStats{};
+  }
+}
+
+uint32_t i2cClockHz() {
+  return gClockHz;
+}
+
+void setI2cTransactionOverheadUs(uint32_t us) {
+  gOverheadUs = us;
+}
+
+}  // namespace host
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+    : txAddress_(0),
+      txBuffer_{0},
+      txLength_(0),
+      txActive_(false),
+      rxBuffer_{0},
+      rxLength_(0),
+      rxIndex_(0) {}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency != 0) {
+    gClockHz = frequency;
+  }
+  return true;
+}
+
+bool TwoWire::end() {
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  if (frequency == 0) return false;
+  gClockHz = frequency;
+  return true;
+}
+
+uint32_t TwoWire::getClock() {
+  return gClockHz;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+  txAddress_ = address;
+  txLength_ = 0;
+  txActive_ = true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  if (!txActive_) {
+    return 4;
+  }
+  txActive_ = false;
+  const uint8_t address = static_cast<uint8_t>(txAddress_);
+  host::I2cDevice* device = host::findI2cDevice(address);
+  if (device == nullptr) {
+    account(address, 0, true);
+    return 2;
+  }
+  const bool ack = device->onWrite(txBuffer_, txLength_);
+  account(address, txLength_, !ack);
+  return ack ? 0 : 3;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool sendStop) {
+  (void)sendStop;
+  rxLength_ = 0;
+  rxIndex_ = 0;
+  if (size > sizeof(rxBuffer_)) size = sizeof(rxBuffer_);
+  const uint8_t addr = static_cast<uint8_t>(address);
+  host::I2cDevice* device = host::findI2cDevice(addr);
+  if (device == nullptr) {
+    account(addr, 0, true);
+    return 0;
+  }
+  rxLength_ = device->onRead(rxBuffer_, size);
+  account(addr, rxLength_, rxLength_ == 0);
+  return rxLength_;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!txActive_ || txLength_ >= sizeof(txBuffer_)) {
+    return 0;
+  }
+  txBuffer_[txLength_++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+  size_t n = 0;
+  while (n < quantity && write(data[n]) == 1) {
+    ++n;
+  }
+  return n;
+}
+
+int TwoWire::available() {
+  return static_cast<int>(rxLength_ - rxIndex_);
+}
+
+int TwoWire::read() {
+  if (rxIndex_ >= rxLength_) return -1;
+  return rxBuffer_[rxIndex_++];
+}
+
+int TwoWire::peek() {
+  if (rxIndex_ >= rxLength_) return -1;
+  return rxBuffer_[rxIndex_];
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// In-memory NVS stand-in. Namespaces survive across Preferences instances
+// for the lifetime of the process, like flash survives a reboot.
+
+#include <Arduino.h>
+
+class Preferences {
+ public:
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putUChar(const char* key, uint8_t value);
+  size_t putUShort(const char* key, uint16_t value);
+  size_t putInt(const char* key, int32_t value);
+  size_t putUInt(const char* key, uint32_t value);
+  size_t putFloat(const char* key, float value);
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0);
+  int32_t getInt(const char* key, int32_t defaultValue = 0);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+  float getFloat(const char* key, float defaultValue = NAN);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+ private:
+  size_t put(const char* key, const void* value, size_t len);
+  bool get(const char* key, void* out, size_t len);
+
+  char namespace_[16] = {0};
+  bool open_ = false;
+  bool readOnly_ = false;
+};
+
+namespace host {
+// Wipes every namespace (a factory-fresh NVS partition).
+void clearPreferences();
+}  // namespace host
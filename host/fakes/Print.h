@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class __FlashStringHelper;
+
+// Mirrors the Arduino Print contract: subclasses implement write(uint8_t)
+// and may override the buffered write for efficiency.
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) {
+    if (str == nullptr) return 0;
+    return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+  }
+  size_t write(const char* buffer, size_t size) {
+    return write(reinterpret_cast<const uint8_t*>(buffer), size);
+  }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper* str);
+  size_t print(const char str[]);
+  size_t print(char c);
+  size_t print(unsigned char n, int base = DEC_BASE);
+  size_t print(int n, int base = DEC_BASE);
+  size_t print(unsigned int n, int base = DEC_BASE);
+  size_t print(long n, int base = DEC_BASE);
+  size_t print(unsigned long n, int base = DEC_BASE);
+  size_t print(long long n, int base = DEC_BASE);
+  size_t print(unsigned long long n, int base = DEC_BASE);
+  size_t print(double n, int digits = 2);
+
+  size_t println(const __FlashStringHelper* str);
+  size_t println(const char str[]);
+  size_t println(char c);
+  size_t println(unsigned char n, int base = DEC_BASE);
+  size_t println(int n, int base = DEC_BASE);
+  size_t println(unsigned int n, int base = DEC_BASE);
+  size_t println(long n, int base = DEC_BASE);
+  size_t println(unsigned long n, int base = DEC_BASE);
+  size_t println(long long n, int base = DEC_BASE);
+  size_t println(unsigned long long n, int base = DEC_BASE);
+  size_t println(double n, int digits = 2);
+  size_t println();
+
+ private:
+  static constexpr int DEC_BASE = 10;
+
+  size_t printNumber(unsigned long long n, uint8_t base);
+  size_t printSigned(long long n, int base);
+  size_t printFloat(double number, uint8_t digits);
+};
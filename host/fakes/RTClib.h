@@ -0,0 +1,94 @@
+#pragma once
+
+// Host reimplementation of the RTClib subset the sketch uses. DateTime and
+// TimeSpan follow the upstream algorithms; RTC_DS3231 talks to the virtual
+// DS3231 over the fake Wire bus exactly like the real driver does.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+class TimeSpan;
+
+class DateTime {
+ public:
+  DateTime(uint32_t t = SECONDS_FROM_1970_TO_2000);
+  DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+  DateTime(const char* date, const char* time);
+  DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time);
+
+  bool isValid() const;
+
+  uint16_t year() const { return 2000U + yOff; }
+  uint8_t month() const { return m; }
+  uint8_t day() const { return d; }
+  uint8_t hour() const { return hh; }
+  uint8_t minute() const { return mm; }
+  uint8_t second() const { return ss; }
+  uint8_t dayOfTheWeek() const;
+
+  uint32_t secondstime() const;
+  uint32_t unixtime() const;
+
+  DateTime operator+(const TimeSpan& span) const;
+  DateTime operator-(const TimeSpan& span) const;
+  TimeSpan operator-(const DateTime& right) const;
+  bool operator<(const DateTime& right) const;
+  bool operator>(const DateTime& right) const { return right < *this; }
+  bool operator<=(const DateTime& right) const { return !(*this > right); }
+  bool operator>=(const DateTime& right) const { return !(*this < right); }
+  bool operator==(const DateTime& right) const;
+  bool operator!=(const DateTime& right) const { return !(*this == right); }
+
+ protected:
+  uint8_t yOff;
+  uint8_t m;
+  uint8_t d;
+  uint8_t hh;
+  uint8_t mm;
+  uint8_t ss;
+};
+
+class TimeSpan {
+ public:
+  TimeSpan(int32_t seconds = 0);
+  TimeSpan(int16_t days, int8_t hours, int8_t minutes, int8_t seconds);
+
+  int16_t days() const { return _seconds / 86400L; }
+  int8_t hours() const { return _seconds / 3600 % 24; }
+  int8_t minutes() const { return _seconds / 60 % 60; }
+  int8_t seconds() const { return _seconds % 60; }
+  int32_t totalseconds() const { return _seconds; }
+
+  TimeSpan operator+(const TimeSpan& right) const { return TimeSpan(_seconds + right._seconds); }
+  TimeSpan operator-(const TimeSpan& right) const { return TimeSpan(_seconds - right._seconds); }
+
+ protected:
+  int32_t _seconds;
+};
+
+enum Ds3231SqwPinMode {
+  DS3231_OFF = 0x1C,
+  DS3231_SquareWave1Hz = 0x00,
+  DS3231_SquareWave1kHz = 0x08,
+  DS3231_SquareWave4kHz = 0x10,
+  DS3231_SquareWave8kHz = 0x18
+};
+
+class RTC_DS3231 {
+ public:
+  bool begin(TwoWire* wireInstance = &Wire);
+  void adjust(const DateTime& dt);
+  bool lostPower();
+  DateTime now();
+  Ds3231SqwPinMode readSqwPinMode();
+  void writeSqwPinMode(Ds3231SqwPinMode mode);
+  float getTemperature();
+
+ private:
+  uint8_t readRegister(uint8_t reg);
+  void writeRegister(uint8_t reg, uint8_t value);
+
+  TwoWire* wire_ = nullptr;
+};
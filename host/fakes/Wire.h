@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// Arduino-ESP32 TwoWire over the host I2C device registry. Every
+// transaction is charged wire time at the current clock to the virtual
+// clock, so blocking bus traffic shows up in micros() like on hardware.
+class TwoWire : public Stream {
+ public:
+  TwoWire();
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end();
+  bool setClock(uint32_t frequency);
+  uint32_t getClock();
+
+  void beginTransmission(uint16_t address);
+  uint8_t endTransmission(bool sendStop = true);
+  size_t requestFrom(uint16_t address, size_t size, bool sendStop = true);
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* data, size_t quantity) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+
+ private:
+  uint16_t txAddress_;
+  uint8_t txBuffer_[I2C_BUFFER_LENGTH];
+  size_t txLength_;
+  bool txActive_;
+  uint8_t rxBuffer_[I2C_BUFFER_LENGTH];
+  size_t rxLength_;
+  size_t rxIndex_;
+};
+
+extern TwoWire Wire;
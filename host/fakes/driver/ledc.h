@@ -0,0 +1,18 @@
+#pragma once
+
+// The one ESP-IDF LEDC call the sketch makes directly; the rest goes
+// through the Arduino ledc* API in Arduino.h.
+
+#include "esp_err.h"
+
+typedef enum {
+  LEDC_LOW_SPEED_MODE = 0,
+} ledc_mode_t;
+
+typedef enum {
+  LEDC_CHANNEL_0 = 0,
+  LEDC_CHANNEL_MAX = 6,
+} ledc_channel_t;
+
+// Holds the channel at its current duty and ends any fade.
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel);
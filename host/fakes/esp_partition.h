@@ -0,0 +1,64 @@
+#pragma once
+
+// RAM-backed stand-in for the ESP-IDF partition API with NOR flash
+// semantics: erase sets a whole sector to 0xFF and writes can only clear
+// bits. Only the "history" data partition from partitions.csv exists.
+// Contents survive for the lifetime of the process, like flash survives a
+// reboot.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01,
+  ESP_PARTITION_TYPE_ANY = 0xff,
+} esp_partition_type_t;
+
+typedef enum {
+  ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  esp_partition_subtype_t subtype;
+  uint32_t address;
+  uint32_t size;
+  uint32_t erase_size;
+  char label[17];
+  bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+namespace host {
+
+struct FlashStats {
+  uint64_t reads;
+  uint64_t writes;
+  uint64_t bytesWritten;
+  uint64_t erases;
+  uint32_t maxSectorErases;
+  uint32_t minSectorErases;
+  // Writes that tried to set a 0 bit back to 1 (a firmware bug on NOR).
+  uint64_t bitSetViolations;
+};
+
+// Resizes and wipes the history partition (default 0xE0000 bytes).
+void setFlashPartitionSize(uint32_t size);
+// Fills the partition with 0xFF, like a freshly flashed board.
+void clearFlashPartition();
+// Raw access for tests and fault injection (e.g. torn writes).
+uint8_t* flashPartitionData();
+// Modelled cost charged to the virtual clock per sector erase.
+void setFlashEraseUs(uint32_t us);
+FlashStats flashStats();
+void resetFlashStats();
+
+}  // namespace host
@@ -0,0 +1,321 @@
+// Golden-image tests for the OLED layout contract. Renders a matrix of
+// UiState inputs through DisplayController::renderFrame() and compares the
+// framebuffer, as logical pixels, with stored PBM images. Every case is
+// also rendered incrementally on top of the previous one and must match its
+// full repaint, which is what the dirty-region widgets promise. Built once
+// per panel geometry (DISPLAY_USE_128X32), each with its own golden set.
+//
+//   tlc_display_golden [--update] [--actual-dir DIR] golden_dir
+//
+// --update rewrites the golden images instead of comparing them. Prints the
+// host time per frame for a full repaint and for an incremental render from
+// the previous case. Exits 0 when every frame matches, 1 when one differs
+// and 2 on a usage error.
+
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+
+#include "DisplayController.h"
+#include "DisplayConfig.h"
+#include "PbmImage.h"
+#include "RTClib.h"
+#include "SensorRollups.h"
+#include "UiState.h"
+
+class DisplayGoldenAccess {
+ public:
+  static void render(DisplayController& display, const UiState& state, unsigned long nowMs, int8_t shiftX,
+                     bool full) {
+    display.pixelShiftX_ = shiftX;
+    if (full) {
+      display.invalidateFrame();
+    }
+    display.renderFrame(state, nowMs);
+  }
+
+  // The framebuffer as logical pixels (page-major, LSB = top row).
+  static PbmImage frame(const DisplayController& display) {
+    PbmImage image(DISPLAY_ACTIVE_WIDTH, DISPLAY_ACTIVE_HEIGHT);
+    for (int y = 0; y < image.height; ++y) {
+      for (int x = 0; x < image.width; ++x) {
+        image.set(x, y, (display.framebuffer_[(y / 8) * DISPLAY_ACTIVE_WIDTH + x] >> (y % 8)) & 1);
+      }
+    }
+    return image;
+  }
+};
+
+namespace {
+
+using Screen = DisplayController::Screen;
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned long kNowMs = 5UL * 3600UL * 1000UL;
+constexpr int kTimingRuns = 200;
+
+struct Options {
+  bool update = false;
+  std::string actualDir = ".";
+  std::string goldenDir;
+};
+
+struct Case {
+  const char* name;
+  Screen screen;
+  int8_t shiftX;
+  bool flipped;
+  bool emptyTrend;
+  void (*apply)(UiState& state);
+};
+
+// A day on the bench: 10:00, RTC and USB fine, knob mode at 42 %, the
+// SHT3x reading a comfortable terrarium.
+UiState baseState() {
+  UiState s{};
+  s.rtcNow = DateTime(2026, 1, 1, 10, 0, 0);
+  s.rtcValid = true;
+  s.usbConnected = true;
+  s.rawPot = 1720;
+  s.brightnessPercent = 42;
+  s.duty = 1720;
+  s.lightOn = true;
+  s.channelCount = 1;
+  s.channels[0] = UiChannel{'M', 42, 1720};
+  s.scheduleAllowed = true;
+  s.controlMode = ControlMode::Pot;
+  snprintf(s.nextEvent, sizeof(s.nextEvent), "NEXT OFF 20:00");
+  s.hasHumidity = true;
+  s.humidityPercent = 71.4f;
+  s.hasTempF = true;
+  s.temperatureF = 76.3f;
+  s.hasRange = true;
+  s.temperatureMinF = 71.2f;
+  s.temperatureMaxF = 84.9f;
+  s.humidityMin = 58.0f;
+  s.humidityMax = 93.0f;
+  s.sensorPresent = true;
+  s.heaterPulsesLastHour = 3;
+  s.heaterLastMs = kNowMs - 17UL * 60UL * 1000UL;
+  return s;
+}
+
+const Case kCases[] = {
+    {"home", Screen::Home, 0, false, false, [](UiState&) {}},
+    {"home_shift_left", Screen::Home, -1, false, false, [](UiState&) {}},
+    {"home_shift_right", Screen::Home, 1, false, false, [](UiState&) {}},
+    {"home_off", Screen::Home, 0, false, false,
+     [](UiState& s) {
+       s.brightnessPercent = 0;
+       s.duty = 0;
+       s.lightOn = false;
+       s.controlMode = ControlMode::Schedule;
+       s.scheduleAllowed = false;
+       snprintf(s.nextEvent, sizeof(s.nextEvent), "NEXT ON  08:00");
+     }},
+    {"home_full", Screen::Home, 0, false, false,
+     [](UiState& s) {
+       s.brightnessPercent = 100;
+       s.controlMode = ControlMode::Override;
+       s.forceOn = true;
+       s.usbConnected = false;
+       s.rtcNow = DateTime(2026, 1, 1, 23, 59, 0);
+     }},
+    {"home_channels", Screen::Home, 0, false, false,
+     [](UiState& s) {
+       s.controlMode = ControlMode::Schedule;
+       s.channelCount = 3;
+       s.channels[0] = UiChannel{'W', 100, 4095};
+       s.channels[1] = UiChannel{'R', 20, 400};
+       s.channels[2] = UiChannel{'U', 0, 0};
+     }},
+    {"home_water", Screen::Home, 0, false, false, [](UiState& s) { s.needsWatering = true; }},
+    {"home_cold", Screen::Home, 0, false, false, [](UiState& s) { s.tooCold = true; }},
+    {"home_hot", Screen::Home, 0, false, false,
+     [](UiState& s) {
+       s.needsWatering = true;
+       s.tooHot = true;
+     }},
+    {"home_rtc_missing", Screen::Home, 0, false, false,
+     [](UiState& s) {
+       s.rtcValid = false;
+       s.rtcNow = DateTime(2000, 1, 1, 0, 0, 0);
+     }},
+    {"home_usb_limited", Screen::Home, 0, false, false, [](UiState& s) { s.usbPowerLimited = true; }},
+    {"home_flipped", Screen::Home, 0, true, false, [](UiState&) {}},
+    {"home_flipped_shift", Screen::Home, 1, true, false, [](UiState& s) { s.tooCold = true; }},
+    {"environment", Screen::Environment, 0, false, false, [](UiState&) {}},
+    {"environment_negative", Screen::Environment, -1, false, false,
+     [](UiState& s) {
+       s.temperatureF = -4.5f;
+       s.humidityPercent = 100.0f;
+       s.temperatureMinF = -12.0f;
+       s.temperatureMaxF = 2.0f;
+     }},
+    {"environment_no_sensor", Screen::Environment, 0, false, false,
+     [](UiState& s) {
+       s.hasTempF = false;
+       s.hasHumidity = false;
+       s.hasRange = false;
+     }},
+    {"environment_flipped", Screen::Environment, 0, true, false, [](UiState&) {}},
+    {"heater", Screen::Heater, 0, false, false, [](UiState&) {}},
+    {"heater_fault", Screen::Heater, 1, false, false,
+     [](UiState& s) {
+       s.heaterOn = true;
+       s.heaterPulsesLastHour = 12;
+       s.heaterLastMs = kNowMs - 3UL * 3600UL * 1000UL;
+       s.wetStuck = true;
+       s.condensationFault = true;
+       s.sensorErrors = 1234;
+     }},
+    {"heater_no_sensor", Screen::Heater, 0, false, false, [](UiState& s) { s.sensorPresent = false; }},
+    {"temp_trend", Screen::TempTrend, 0, false, false, [](UiState&) {}},
+    {"humidity_trend", Screen::HumidityTrend, 0, false, false, [](UiState&) {}},
+    {"trend_flipped", Screen::TempTrend, -1, true, false, [](UiState&) {}},
+    {"trend_empty", Screen::HumidityTrend, 0, false, true, [](UiState&) {}},
+};
+
+// 24 h of a day/night swing with a gap, sampled every 5 minutes. A
+// triangle wave in exact steps keeps the goldens independent of libm.
+void fillTrend(SensorRollups& rollups) {
+  const uint32_t end = DateTime(2026, 1, 1, 10, 0, 0).unixtime();
+  for (uint32_t t = end - 24UL * 3600UL + 300; t <= end; t += 300) {
+    const uint32_t hoursAgo = (end - t) / 3600UL;
+    if (hoursAgo >= 14 && hoursAgo < 16) continue;
+    const int step = static_cast<int>((t / 300) % 288);
+    const int warmth = step < 144 ? step : 288 - step;  // 0..144
+    rollups.add(t, 20.0f + warmth * 0.0625f + ((t / 300) % 3) * 0.25f, 85.0f - warmth * 0.25f);
+  }
+}
+
+SensorRollups gTrend;
+SensorRollups gEmptyTrend;
+
+void prepare(DisplayController& display, const Case& c) {
+  display.setFlip(c.flipped);
+  display.setScreen(c.screen);
+  display.setTrendSource(c.emptyTrend ? gEmptyTrend : gTrend);
+}
+
+UiState stateFor(const Case& c) {
+  UiState state = baseState();
+  c.apply(state);
+  return state;
+}
+
+double meanUs(Clock::duration total) {
+  return std::chrono::duration<double, std::micro>(total).count() / kTimingRuns;
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strcmp(a, "--update") == 0) {
+      opt.update = true;
+    } else if (strcmp(a, "--actual-dir") == 0 && i + 1 < argc) {
+      opt.actualDir = argv[++i];
+    } else if (a[0] != '-' && opt.goldenDir.empty()) {
+      opt.goldenDir = a;
+    } else {
+      opt.goldenDir.clear();
+      break;
+    }
+  }
+  if (opt.goldenDir.empty()) {
+    fprintf(stderr, "usage: %s [--update] [--actual-dir DIR] golden_dir\n", argv[0]);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseOptions(argc, argv, opt)) {
+    return 2;
+  }
+  fillTrend(gTrend);
+
+  printf("%ux%u golden frames in %s\n", DISPLAY_ACTIVE_WIDTH, DISPLAY_ACTIVE_HEIGHT, opt.goldenDir.c_str());
+  printf("  %-22s %9s %9s\n", "case", "full us", "incr us");
+
+  // Renders every case on top of the one before, as update() would.
+  DisplayController rolling;
+  const Case* previous = nullptr;
+  int failures = 0;
+  for (const Case& c : kCases) {
+    const UiState state = stateFor(c);
+    DisplayController display;
+    prepare(display, c);
+    DisplayGoldenAccess::render(display, state, kNowMs, c.shiftX, true);
+    const PbmImage actual = DisplayGoldenAccess::frame(display);
+
+    prepare(rolling, c);
+    DisplayGoldenAccess::render(rolling, state, kNowMs, c.shiftX, false);
+    const size_t incrementalDiffs = comparePbm(actual, DisplayGoldenAccess::frame(rolling), nullptr);
+
+    Clock::duration full{};
+    for (int i = 0; i < kTimingRuns; ++i) {
+      const Clock::time_point t0 = Clock::now();
+      DisplayGoldenAccess::render(display, state, kNowMs, c.shiftX, true);
+      full += Clock::now() - t0;
+    }
+    Clock::duration incremental{};
+    if (previous != nullptr) {
+      const UiState before = stateFor(*previous);
+      DisplayController timed;
+      for (int i = 0; i < kTimingRuns; ++i) {
+        prepare(timed, *previous);
+        DisplayGoldenAccess::render(timed, before, kNowMs, previous->shiftX, true);
+        prepare(timed, c);
+        const Clock::time_point t0 = Clock::now();
+        DisplayGoldenAccess::render(timed, state, kNowMs, c.shiftX, false);
+        incremental += Clock::now() - t0;
+      }
+    }
+    if (previous != nullptr) {
+      printf("  %-22s %9.2f %9.2f\n", c.name, meanUs(full), meanUs(incremental));
+    } else {
+      printf("  %-22s %9.2f %9s\n", c.name, meanUs(full), "-");
+    }
+    previous = &c;
+
+    const std::string path = opt.goldenDir + "/" + c.name + ".pbm";
+    if (incrementalDiffs != 0) {
+      printf("FAIL %s: incremental render differs from a full repaint in %zu pixels\n", c.name, incrementalDiffs);
+      comparePbm(actual, DisplayGoldenAccess::frame(rolling), stdout);
+      failures++;
+    }
+    if (opt.update) {
+      if (!writePbm(path, actual)) {
+        printf("FAIL %s: cannot write %s\n", c.name, path.c_str());
+        failures++;
+      }
+      continue;
+    }
+    PbmImage expected;
+    std::string error;
+    if (!readPbm(path, expected, error)) {
+      printf("FAIL %s: %s (run with --update to create it)\n", c.name, error.c_str());
+      failures++;
+      continue;
+    }
+    if (comparePbm(expected, actual, nullptr) != 0) {
+      const std::string actualPath = opt.actualDir + "/" + c.name + ".actual.pbm";
+      printf("FAIL %s: frame differs from %s; wrote %s\n", c.name, path.c_str(), actualPath.c_str());
+      comparePbm(expected, actual, stdout);
+      writePbm(actualPath, actual);
+      failures++;
+    }
+  }
+
+  const int total = static_cast<int>(sizeof(kCases) / sizeof(kCases[0]));
+  printf("%s %d frames, %d failed\n", opt.update ? "updated" : "checked", total, failures);
+  return failures == 0 ? 0 : 1;
+}
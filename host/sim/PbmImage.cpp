@@ -0,0 +1,124 @@
+#include "PbmImage.h"
+
+#include <ctype.h>
+
+#include <algorithm>
+
+namespace {
+
+// Next header integer, skipping whitespace and '#' comments.
+bool readHeaderInt(FILE* f, int& value) {
+  int c = fgetc(f);
+  while (c != EOF && (isspace(c) || c == '#')) {
+    if (c == '#') {
+      while (c != EOF && c != '\n') c = fgetc(f);
+    }
+    c = fgetc(f);
+  }
+  if (c == EOF || !isdigit(c)) {
+    return false;
+  }
+  value = 0;
+  while (c != EOF && isdigit(c)) {
+    value = value * 10 + (c - '0');
+    c = fgetc(f);
+  }
+  // The single whitespace byte after the height ends the header.
+  return c != EOF && isspace(c);
+}
+
+}  // namespace
+
+bool readPbm(const std::string& path, PbmImage& out, std::string& error) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (f == nullptr) {
+    error = "cannot open " + path;
+    return false;
+  }
+  char magic[2] = {0, 0};
+  int width = 0;
+  int height = 0;
+  bool ok = fread(magic, 1, 2, f) == 2 && magic[0] == 'P' && magic[1] == '4' && readHeaderInt(f, width) &&
+            readHeaderInt(f, height) && width > 0 && height > 0;
+  if (!ok) {
+    error = path + " is not a binary (P4) PBM";
+    fclose(f);
+    return false;
+  }
+  PbmImage image(width, height);
+  const size_t rowBytes = static_cast<size_t>(width + 7) / 8;
+  std::vector<uint8_t> row(rowBytes);
+  for (int y = 0; y < height && ok; ++y) {
+    ok = fread(row.data(), 1, rowBytes, f) == rowBytes;
+    for (int x = 0; x < width && ok; ++x) {
+      image.set(x, y, (row[static_cast<size_t>(x) / 8] >> (7 - x % 8)) & 1);
+    }
+  }
+  fclose(f);
+  if (!ok) {
+    error = path + " is truncated";
+    return false;
+  }
+  out = image;
+  return true;
+}
+
+bool writePbm(const std::string& path, const PbmImage& image) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (f == nullptr) {
+    return false;
+  }
+  fprintf(f, "P4\n%d %d\n", image.width, image.height);
+  const size_t rowBytes = static_cast<size_t>(image.width + 7) / 8;
+  std::vector<uint8_t> row(rowBytes);
+  for (int y = 0; y < image.height; ++y) {
+    std::fill(row.begin(), row.end(), 0);
+    for (int x = 0; x < image.width; ++x) {
+      if (image.get(x, y)) {
+        row[static_cast<size_t>(x) / 8] |= static_cast<uint8_t>(0x80 >> (x % 8));
+      }
+    }
+    fwrite(row.data(), 1, rowBytes, f);
+  }
+  return fclose(f) == 0;
+}
+
+size_t comparePbm(const PbmImage& expected, const PbmImage& actual, FILE* report) {
+  if (expected.width != actual.width || expected.height != actual.height) {
+    if (report != nullptr) {
+      fprintf(report, "    size %dx%d, expected %dx%d\n", actual.width, actual.height, expected.width,
+              expected.height);
+    }
+    return actual.pixels.size() > expected.pixels.size() ? actual.pixels.size() : expected.pixels.size();
+  }
+  size_t count = 0;
+  int x0 = actual.width;
+  int y0 = actual.height;
+  int x1 = -1;
+  int y1 = -1;
+  for (int y = 0; y < actual.height; ++y) {
+    for (int x = 0; x < actual.width; ++x) {
+      if (expected.get(x, y) != actual.get(x, y)) {
+        count++;
+        if (x < x0) x0 = x;
+        if (x > x1) x1 = x;
+        if (y < y0) y0 = y;
+        if (y > y1) y1 = y;
+      }
+    }
+  }
+  if (count == 0 || report == nullptr) {
+    return count;
+  }
+  fprintf(report, "    %zu pixels differ in x=%d..%d y=%d..%d\n", count, x0, x1, y0, y1);
+  for (int y = y0; y <= y1; ++y) {
+    fprintf(report, "    %2d ", y);
+    for (int x = 0; x < actual.width; ++x) {
+      const bool e = expected.get(x, y);
+      const bool a = actual.get(x, y);
+      fputc(e == a ? (a ? '#' : '.') : (a ? '+' : '-'), report);
+    }
+    fputc('\n', report);
+  }
+  return count;
+}
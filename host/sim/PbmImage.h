@@ -0,0 +1,30 @@
+#pragma once
+
+// 1-bit images in binary PBM (P4) form, used as golden frames by the host
+// simulator and the display tests. A set pixel is a lit OLED pixel, which
+// PBM viewers show as black.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+struct PbmImage {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;  // row-major, one byte per pixel, 0 or 1
+
+  PbmImage() = default;
+  PbmImage(int w, int h) : width(w), height(h), pixels(static_cast<size_t>(w) * h, 0) {}
+
+  bool get(int x, int y) const { return pixels[static_cast<size_t>(y) * width + x] != 0; }
+  void set(int x, int y, bool on) { pixels[static_cast<size_t>(y) * width + x] = on ? 1 : 0; }
+};
+
+bool readPbm(const std::string& path, PbmImage& out, std::string& error);
+bool writePbm(const std::string& path, const PbmImage& image);
+// Returns the number of pixels that differ (every pixel if the sizes do).
+// When report is set and anything differs, prints the bounding box and a
+// map of the differing rows: '+' lit only in actual, '-' only in expected.
+size_t comparePbm(const PbmImage& expected, const PbmImage& actual, FILE* report);
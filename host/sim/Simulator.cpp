@@ -0,0 +1,603 @@
+// Runs the whole firmware (the real setup() and loop()) through a scenario
+// file on virtual time: a DS3231, a scripted SHT3x and an SSD1306 whose
+// glass is captured pixel for pixel. Scenarios set the stimulus, run for
+// minutes to days, and assert on outputs, golden frames and per-loop cost.
+// Everything is deterministic, so a scenario either always passes or
+// always fails.
+//
+//   tlc_sim [--update] [--echo] [--actual-dir DIR] scenario.scn
+//
+// --update rewrites the golden frames instead of comparing them; --echo
+// prints the firmware's console as it runs. Exits 0 when every expect
+// holds, 1 when one fails and 2 on a scenario error.
+//
+// Scenario lines (lines starting with # are comments; durations are 250ms,
+// 10s, 5m, 2h, 3d):
+//   rtc YYYY-MM-DD HH:MM:SS        set the DS3231 wall clock
+//   reset-reason poweron|brownout|...  what esp_reset_reason() reports
+//   attach|detach sht3x|oled       plug or unplug a device
+//   boot                           run setup() (implied by the first run)
+//   pot <0..4095>                  knob position
+//   env <tempC> <rh>               hold the SHT3x environment
+//   env ramp <tempC> <rh> <dur>    move linearly there from the current value
+//   env wave <tempC> <rh> <ampC> <ampRh> <period>   sine around a mean
+//   console <text>                 type a command (clears captured output)
+//   run <dur> | run until HH:MM[:SS]
+//   reset-stats                    restart the loop cost, heap and I2C counters
+//   expect <metric> <op> <value>   op is == != < <= > >=
+//   expect output|no-output <text> console output since the last command
+//   expect frame <file.pbm>        glass vs a golden frame next to the scenario
+//
+// Metrics: pwm:<pin>, display.on, display.dimmed, display.contrast,
+// display.screen, heater.pulses, heater.max_per_hour, sht3x.samples,
+// ui.<field> (see kUiFields), heap.allocations, loop.passes, loop.max_us,
+// loop.mean_us, tasks.overruns, i2c.nacks.
+
+#include <Arduino.h>
+#include <esp_system.h>
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "DisplayController.h"
+#include "HostDevices.h"
+#include "HostHarness.h"
+#include "LoopProfiler.h"
+#include "PbmImage.h"
+#include "RTClib.h"
+#include "TaskScheduler.h"
+#include "UiState.h"
+
+void setup();
+void loop();
+extern TaskScheduler scheduler;
+extern DisplayController displayController;
+extern UiState uiState;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint8_t kPotPin = 1;
+constexpr uint64_t kHourUs = 3600ULL * 1000000ULL;
+
+struct Options {
+  bool update = false;
+  bool echo = false;
+  std::string actualDir = ".";
+  std::string scenario;
+};
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strcmp(a, "--update") == 0) {
+      opt.update = true;
+    } else if (strcmp(a, "--echo") == 0) {
+      opt.echo = true;
+    } else if (strcmp(a, "--actual-dir") == 0 && i + 1 < argc) {
+      opt.actualDir = argv[++i];
+    } else if (a[0] != '-' && opt.scenario.empty()) {
+      opt.scenario = a;
+    } else {
+      opt.scenario.clear();
+      break;
+    }
+  }
+  if (opt.scenario.empty()) {
+    fprintf(stderr, "usage: %s [--update] [--echo] [--actual-dir DIR] scenario.scn\n", argv[0]);
+    return false;
+  }
+  return true;
+}
+
+// ---- Loop cost ----
+// Busy time of a loop pass is the virtual time spent inside profiled
+// stages: I2C wire time and blocking waits, not the scheduler's sleep.
+bool gStageOpen = false;
+uint64_t gStageStartUs = 0;
+uint64_t gPassBusyUs = 0;
+
+struct LoopStats {
+  uint64_t passes;
+  uint64_t busyUs;
+  uint64_t maxBusyUs;
+  uint64_t allocations;
+  uint64_t cpuNs;
+  uint64_t maxCpuNs;
+};
+
+// ---- Devices and stimulus ----
+host::VirtualDs3231 gRtc;
+host::VirtualSht3x gSht;
+host::VirtualSsd1306 gOled;
+bool gShtAttached = true;
+bool gOledAttached = true;
+bool gBooted = false;
+LoopStats gStats{};
+std::deque<uint64_t> gPulseTimes;
+uint32_t gPulsesSeen = 0;
+size_t gMaxPulsesPerHour = 0;
+
+struct Scenario {
+  Options opt;
+  std::string dir;
+  std::string name;
+  int line = 0;
+  int checks = 0;
+  int failures = 0;
+};
+
+void failScenario(const Scenario& sc, const char* what) {
+  fprintf(stderr, "%s:%d: %s\n", sc.opt.scenario.c_str(), sc.line, what);
+  exit(2);
+}
+
+std::vector<std::string> splitWords(const std::string& text) {
+  std::vector<std::string> words;
+  size_t i = 0;
+  while (i < text.size()) {
+    while (i < text.size() && isspace(static_cast<unsigned char>(text[i]))) ++i;
+    size_t j = i;
+    while (j < text.size() && !isspace(static_cast<unsigned char>(text[j]))) ++j;
+    if (j > i) words.push_back(text.substr(i, j - i));
+    i = j;
+  }
+  return words;
+}
+
+// Text after the first n words, as typed.
+std::string restAfter(const std::string& text, size_t n) {
+  size_t i = 0;
+  for (size_t w = 0; w < n; ++w) {
+    while (i < text.size() && isspace(static_cast<unsigned char>(text[i]))) ++i;
+    while (i < text.size() && !isspace(static_cast<unsigned char>(text[i]))) ++i;
+  }
+  while (i < text.size() && isspace(static_cast<unsigned char>(text[i]))) ++i;
+  return text.substr(i);
+}
+
+bool parseNumber(const std::string& s, double& out) {
+  char* end = nullptr;
+  out = strtod(s.c_str(), &end);
+  return end != s.c_str() && *end == '\0';
+}
+
+bool parseDurationUs(const std::string& s, uint64_t& out) {
+  char* end = nullptr;
+  const double value = strtod(s.c_str(), &end);
+  if (end == s.c_str() || value < 0) return false;
+  double unitUs = 0;
+  if (strcmp(end, "ms") == 0) unitUs = 1e3;
+  else if (strcmp(end, "s") == 0) unitUs = 1e6;
+  else if (strcmp(end, "m") == 0) unitUs = 60e6;
+  else if (strcmp(end, "h") == 0) unitUs = 3600e6;
+  else if (strcmp(end, "d") == 0) unitUs = 86400e6;
+  else return false;
+  out = static_cast<uint64_t>(value * unitUs + 0.5);
+  return true;
+}
+
+// ---- Running ----
+
+void boot() {
+  if (gBooted) return;
+  gBooted = true;
+  setup();
+  host::resetHeapStats();
+  host::resetI2cStats();
+  gStats = LoopStats{};
+}
+
+void pass() {
+  const uint64_t allocsBefore = host::heapStats().allocations;
+  gPassBusyUs = 0;
+  const Clock::time_point t0 = Clock::now();
+  loop();
+  const uint64_t cpuNs =
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+  gStats.passes++;
+  gStats.busyUs += gPassBusyUs;
+  if (gPassBusyUs > gStats.maxBusyUs) gStats.maxBusyUs = gPassBusyUs;
+  gStats.cpuNs += cpuNs;
+  if (cpuNs > gStats.maxCpuNs) gStats.maxCpuNs = cpuNs;
+  gStats.allocations += host::heapStats().allocations - allocsBefore;
+
+  // Heater pulses in any 60 minute window, to check the firmware's limit.
+  const uint64_t now = host::nowUs();
+  for (; gPulsesSeen < gSht.heaterPulseCount(); ++gPulsesSeen) {
+    gPulseTimes.push_back(now);
+  }
+  while (!gPulseTimes.empty() && now - gPulseTimes.front() >= kHourUs) {
+    gPulseTimes.pop_front();
+  }
+  if (gPulseTimes.size() > gMaxPulsesPerHour) gMaxPulsesPerHour = gPulseTimes.size();
+}
+
+
+
+PbmImage captureGlass() {
+  const int rows = gOled.rows() > 0 ? gOled.rows() : 64;
+  PbmImage image(host::VirtualSsd1306::kWidth, rows);
+  if (!gOledAttached || !gOled.displayOn()) {
+    return image;
+  }
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      image.set(x, y, gOled.pixel(static_cast<uint8_t>(x), static_cast<uint8_t>(y)));
+    }
+  }
+  return image;
+}
+
+// ---- Metrics ----
+
+struct UiField {
+  const char* name;
+  double (*read)();
+};
+
+const UiField kUiFields[] = {
+    {"brightness", [] { return static_cast<double>(uiState.brightnessPercent); }},
+    {"condensationFault", [] { return static_cast<double>(uiState.condensationFault); }},
+    {"duty", [] { return static_cast<double>(uiState.duty); }},
+    {"hasTempF", [] { return static_cast<double>(uiState.hasTempF); }},
+    {"heaterOn", [] { return static_cast<double>(uiState.heaterOn); }},
+    {"heaterPulsesLastHour", [] { return static_cast<double>(uiState.heaterPulsesLastHour); }},
+    {"humidity", [] { return static_cast<double>(uiState.humidityPercent); }},
+    {"lightOn", [] { return static_cast<double>(uiState.lightOn); }},
+    {"needsWatering", [] { return static_cast<double>(uiState.needsWatering); }},
+    {"rtcValid", [] { return static_cast<double>(uiState.rtcValid); }},
+    {"temperatureF", [] { return static_cast<double>(uiState.temperatureF); }},
+    {"tooCold", [] { return static_cast<double>(uiState.tooCold); }},
+    {"tooHot", [] { return static_cast<double>(uiState.tooHot); }},
+    {"usbPowerLimited", [] { return static_cast<double>(uiState.usbPowerLimited); }},
+    {"wetStuck", [] { return static_cast<double>(uiState.wetStuck); }},
+};
+
+bool readMetric(const std::string& name, double& out) {
+  if (name.compare(0, 4, "pwm:") == 0) {
+    double pin = 0;
+    if (!parseNumber(name.substr(4), pin)) return false;
+    out = host::ledcState(static_cast<uint8_t>(pin)).duty;
+    return true;
+  }
+  if (name.compare(0, 3, "ui.") == 0) {
+    for (const UiField& field : kUiFields) {
+      if (name.compare(3, std::string::npos, field.name) == 0) {
+        out = field.read();
+        return true;
+      }
+    }
+    return false;
+  }
+  const DisplayController::Status display = displayController.getStatus();
+  if (name == "display.on") out = gOledAttached && gOled.displayOn();
+  else if (name == "display.dimmed") out = display.dimmed;
+  else if (name == "display.contrast") out = gOled.contrast();
+  else if (name == "display.screen") out = static_cast<double>(display.screen);
+  else if (name == "heater.pulses") out = gSht.heaterPulseCount();
+  else if (name == "heater.max_per_hour") out = static_cast<double>(gMaxPulsesPerHour);
+  else if (name == "sht3x.samples") out = gSht.measurementCount();
+  else if (name == "heap.allocations") out = static_cast<double>(gStats.allocations);
+  else if (name == "loop.passes") out = static_cast<double>(gStats.passes);
+  else if (name == "loop.max_us") out = static_cast<double>(gStats.maxBusyUs);
+  else if (name == "loop.mean_us") {
+    out = gStats.passes > 0 ? static_cast<double>(gStats.busyUs) / static_cast<double>(gStats.passes) : 0.0;
+  } else if (name == "tasks.overruns") {
+    out = 0;
+    for (size_t i = 0; i < scheduler.getTaskCount(); ++i) {
+      out += static_cast<double>(scheduler.getTaskStats(i).overruns);
+    }
+  } else if (name == "i2c.nacks") {
+    out = static_cast<double>(host::i2cTotals().nacks);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool compare(double value, const std::string& op, double target, bool& known) {
+  known = true;
+  if (op == "==") return value == target;
+  if (op == "!=") return value != target;
+  if (op == "<") return value < target;
+  if (op == "<=") return value <= target;
+  if (op == ">") return value > target;
+  if (op == ">=") return value >= target;
+  known = false;
+  return false;
+}
+
+// ---- Commands ----
+
+std::string gOutput;
+
+void collectOutput(const Options& opt) {
+  const std::string text = host::takeSerialOutput();
+  if (opt.echo) fputs(text.c_str(), stdout);
+  gOutput += text;
+}
+
+// Drains the capture between passes, so its buffer never has to grow inside
+// loop() and count as a firmware allocation.
+void runFor(const Options& opt, uint64_t us) {
+  boot();
+  const uint64_t end = host::nowUs() + us;
+  uint64_t bytesSeen = host::serialStats().bytes;
+  while (host::nowUs() < end) {
+    pass();
+    if (host::serialStats().bytes != bytesSeen) {
+      bytesSeen = host::serialStats().bytes;
+      collectOutput(opt);
+    }
+  }
+}
+
+void check(Scenario& sc, bool ok, const std::string& what) {
+  sc.checks++;
+  if (!ok) {
+    sc.failures++;
+    printf("FAIL %s:%d: %s\n", sc.name.c_str(), sc.line, what.c_str());
+  }
+}
+
+void expectFrame(Scenario& sc, const std::string& file) {
+  boot();
+  const PbmImage actual = captureGlass();
+  const std::string path = sc.dir + file;
+  if (sc.opt.update) {
+    if (!writePbm(path, actual)) failScenario(sc, ("cannot write " + path).c_str());
+    printf("updated %s\n", path.c_str());
+    return;
+  }
+  PbmImage expected;
+  std::string error;
+  if (!readPbm(path, expected, error)) {
+    check(sc, false, "frame " + file + ": " + error + " (run with --update to create it)");
+    return;
+  }
+  const size_t slash = file.find_last_of('/');
+  const std::string base = file.substr(slash == std::string::npos ? 0 : slash + 1);
+  const bool same = comparePbm(expected, actual, nullptr) == 0;
+  check(sc, same, "frame " + file + " differs; wrote " + sc.opt.actualDir + "/" + base + ".actual.pbm");
+  if (!same) {
+    comparePbm(expected, actual, stdout);
+    writePbm(sc.opt.actualDir + "/" + base + ".actual.pbm", actual);
+  }
+}
+
+void expectCommand(Scenario& sc, const std::string& text, const std::vector<std::string>& words) {
+  if (words.size() >= 3 && (words[1] == "output" || words[1] == "no-output")) {
+    boot();
+    collectOutput(sc.opt);
+    const std::string needle = restAfter(text, 2);
+    const bool found = gOutput.find(needle) != std::string::npos;
+    const bool want = words[1] == "output";
+    check(sc, found == want, std::string(want ? "output lacks" : "output has") + " \"" + needle + "\"");
+    if (found != want && !sc.opt.echo) {
+      const size_t kTail = 1500;
+      const size_t from = gOutput.size() > kTail ? gOutput.size() - kTail : 0;
+      printf("    output was%s:\n%s\n", from > 0 ? " (tail)" : "", gOutput.c_str() + from);
+    }
+    return;
+  }
+  if (words.size() == 3 && words[1] == "frame") {
+    expectFrame(sc, words[2]);
+    return;
+  }
+  double target = 0;
+  if (words.size() != 4 || !parseNumber(words[3], target)) {
+    failScenario(sc, "expected: expect <metric> <op> <number>");
+  }
+  boot();
+  double value = 0;
+  if (!readMetric(words[1], value)) failScenario(sc, ("unknown metric " + words[1]).c_str());
+  bool known = false;
+  const bool ok = compare(value, words[2], target, known);
+  if (!known) failScenario(sc, ("unknown operator " + words[2]).c_str());
+  char what[160];
+  snprintf(what, sizeof(what), "%s = %g, expected %s %g", words[1].c_str(), value, words[2].c_str(), target);
+  check(sc, ok, what);
+}
+
+void envCommand(Scenario& sc, const std::vector<std::string>& words) {
+  double t = 0;
+  double rh = 0;
+  if (words.size() == 3 && parseNumber(words[1], t) && parseNumber(words[2], rh)) {
+    gSht.setEnvironment(static_cast<float>(t), static_cast<float>(rh));
+    return;
+  }
+  uint64_t durUs = 0;
+  if (words.size() == 5 && words[1] == "ramp" && parseNumber(words[2], t) && parseNumber(words[3], rh) &&
+      parseDurationUs(words[4], durUs) && durUs > 0) {
+    const host::VirtualSht3x::Environment from = gSht.environment();
+    const uint64_t startUs = host::nowUs();
+    gSht.setEnvironment([=](uint64_t nowUs) {
+      double f = static_cast<double>(nowUs - startUs) / static_cast<double>(durUs);
+      if (f > 1.0) f = 1.0;
+      return host::VirtualSht3x::Environment{static_cast<float>(from.temperatureC + (t - from.temperatureC) * f),
+                                             static_cast<float>(from.humidity + (rh - from.humidity) * f)};
+    });
+    return;
+  }
+  double ampT = 0;
+  double ampRh = 0;
+  if (words.size() == 7 && words[1] == "wave" && parseNumber(words[2], t) && parseNumber(words[3], rh) &&
+      parseNumber(words[4], ampT) && parseNumber(words[5], ampRh) && parseDurationUs(words[6], durUs) &&
+      durUs > 0) {
+    const uint64_t startUs = host::nowUs();
+    gSht.setEnvironment([=](uint64_t nowUs) {
+      const double phase = 2.0 * M_PI * static_cast<double>(nowUs - startUs) / static_cast<double>(durUs);
+      return host::VirtualSht3x::Environment{static_cast<float>(t + ampT * sin(phase)),
+                                             static_cast<float>(rh + ampRh * sin(phase))};
+    });
+    return;
+  }
+  failScenario(sc, "expected: env <tempC> <rh> | env ramp <tempC> <rh> <dur> | env wave <tempC> <rh> <ampC> <ampRh> <period>");
+}
+
+void runCommand(Scenario& sc, const std::vector<std::string>& words) {
+  uint64_t us = 0;
+  if (words.size() == 2 && parseDurationUs(words[1], us)) {
+    runFor(sc.opt, us);
+    return;
+  }
+  int hh = 0;
+  int mm = 0;
+  int ss = 0;
+  if (words.size() == 3 && words[1] == "until" &&
+      sscanf(words[2].c_str(), "%d:%d:%d", &hh, &mm, &ss) >= 2 && hh < 24 && mm < 60 && ss < 60) {
+    boot();
+    const uint32_t now = gRtc.unixTime();
+    const uint32_t target = static_cast<uint32_t>(hh * 3600 + mm * 60 + ss);
+    const uint32_t ofDay = now % 86400;
+    const uint32_t waitS = target > ofDay ? target - ofDay : target + 86400 - ofDay;
+    runFor(sc.opt, static_cast<uint64_t>(waitS) * 1000000ULL);
+    return;
+  }
+  failScenario(sc, "expected: run <duration> | run until HH:MM[:SS]");
+}
+
+void setAttached(Scenario& sc, const std::vector<std::string>& words) {
+  const bool attach = words[0] == "attach";
+  if (words.size() != 2 || (words[1] != "sht3x" && words[1] != "oled")) {
+    failScenario(sc, "expected: attach|detach sht3x|oled");
+  }
+  host::I2cDevice* device = words[1] == "sht3x" ? static_cast<host::I2cDevice*>(&gSht) : &gOled;
+  bool& attached = words[1] == "sht3x" ? gShtAttached : gOledAttached;
+  if (attach && !attached) host::attachI2cDevice(device);
+  if (!attach && attached) host::detachI2cDevice(device->address());
+  attached = attach;
+}
+
+void setResetReason(Scenario& sc, const std::vector<std::string>& words) {
+  static const struct {
+    const char* name;
+    esp_reset_reason_t reason;
+  } kReasons[] = {
+      {"poweron", ESP_RST_POWERON}, {"ext", ESP_RST_EXT},         {"sw", ESP_RST_SW},
+      {"panic", ESP_RST_PANIC},     {"wdt", ESP_RST_TASK_WDT},    {"deepsleep", ESP_RST_DEEPSLEEP},
+      {"brownout", ESP_RST_BROWNOUT},
+  };
+  for (const auto& r : kReasons) {
+    if (words.size() == 2 && words[1] == r.name) {
+      host::setResetReason(r.reason);
+      return;
+    }
+  }
+  failScenario(sc, "expected: reset-reason poweron|ext|sw|panic|wdt|deepsleep|brownout");
+}
+
+void execute(Scenario& sc, const std::string& text) {
+  const std::vector<std::string> words = splitWords(text);
+  const std::string& cmd = words[0];
+  if (cmd == "rtc") {
+    int y, mo, d, h, mi, s;
+    if (words.size() != 3 || sscanf(words[1].c_str(), "%d-%d-%d", &y, &mo, &d) != 3 ||
+        sscanf(words[2].c_str(), "%d:%d:%d", &h, &mi, &s) != 3) {
+      failScenario(sc, "expected: rtc YYYY-MM-DD HH:MM:SS");
+    }
+    gRtc.setUnixTime(DateTime(static_cast<uint16_t>(y), static_cast<uint8_t>(mo), static_cast<uint8_t>(d),
+                              static_cast<uint8_t>(h), static_cast<uint8_t>(mi), static_cast<uint8_t>(s))
+                         .unixtime());
+  } else if (cmd == "reset-reason") {
+    if (gBooted) failScenario(sc, "reset-reason must come before boot");
+    setResetReason(sc, words);
+  } else if (cmd == "attach" || cmd == "detach") {
+    setAttached(sc, words);
+  } else if (cmd == "boot") {
+    boot();
+  } else if (cmd == "pot") {
+    double value = 0;
+    if (words.size() != 2 || !parseNumber(words[1], value) || value < 0 || value > 4095) {
+      failScenario(sc, "expected: pot <0..4095>");
+    }
+    host::setAnalogValue(kPotPin, static_cast<uint16_t>(value));
+  } else if (cmd == "env") {
+    envCommand(sc, words);
+  } else if (cmd == "console") {
+    boot();
+    collectOutput(sc.opt);
+    gOutput.clear();
+    host::pushSerialInput((restAfter(text, 1) + "\n").c_str());
+  } else if (cmd == "run") {
+    runCommand(sc, words);
+  } else if (cmd == "reset-stats") {
+    boot();
+    host::resetI2cStats();
+    gStats = LoopStats{};
+  } else if (cmd == "expect") {
+    expectCommand(sc, text, words);
+  } else {
+    failScenario(sc, ("unknown command " + cmd).c_str());
+  }
+}
+
+}  // namespace
+
+void loopProfileBegin(LoopStage stage) {
+  (void)stage;
+  const uint64_t now = host::nowUs();
+  if (gStageOpen) gPassBusyUs += now - gStageStartUs;
+  gStageOpen = true;
+  gStageStartUs = now;
+}
+
+void loopProfileEnd() {
+  if (gStageOpen) gPassBusyUs += host::nowUs() - gStageStartUs;
+  gStageOpen = false;
+}
+
+int main(int argc, char** argv) {
+  Scenario sc;
+  if (!parseOptions(argc, argv, sc.opt)) {
+    return 2;
+  }
+  FILE* f = fopen(sc.opt.scenario.c_str(), "r");
+  if (f == nullptr) {
+    fprintf(stderr, "cannot open %s\n", sc.opt.scenario.c_str());
+    return 2;
+  }
+  const size_t slash = sc.opt.scenario.find_last_of('/');
+  sc.dir = slash == std::string::npos ? "" : sc.opt.scenario.substr(0, slash + 1);
+  sc.name = sc.opt.scenario.substr(slash == std::string::npos ? 0 : slash + 1);
+
+  // Defaults: the bench's clock, a comfortable terrarium, the knob at half.
+  gRtc.setUnixTime(DateTime(2026, 1, 1, 10, 0, 0).unixtime());
+  gSht.setEnvironment(24.0f, 70.0f);
+  host::attachI2cDevice(&gRtc);
+  host::attachI2cDevice(&gSht);
+  host::attachI2cDevice(&gOled);
+  host::setAnalogValue(kPotPin, 2048);
+  host::setSerialCapture(true);
+
+  const Clock::time_point wallStart = Clock::now();
+  const uint64_t virtStart = host::nowUs();
+  char buf[512];
+  while (fgets(buf, sizeof(buf), f) != nullptr) {
+    sc.line++;
+    const std::string text(buf, strcspn(buf, "\r\n"));
+    const std::vector<std::string> words = splitWords(text);
+    if (words.empty() || words[0][0] == '#') continue;
+    execute(sc, text);
+  }
+  fclose(f);
+  boot();
+  collectOutput(sc.opt);
+
+  const double wallS = std::chrono::duration<double>(Clock::now() - wallStart).count();
+  const double virtH = static_cast<double>(host::nowUs() - virtStart) / 3.6e9;
+  printf("%s: %d/%d checks passed, %.1f h simulated in %.1f s\n", sc.name.c_str(), sc.checks - sc.failures,
+         sc.checks, virtH, wallS);
+  const double passes = gStats.passes > 0 ? static_cast<double>(gStats.passes) : 1.0;
+  printf("  loop passes %llu: modelled busy mean %.1f us, max %llu us; host CPU mean %.0f ns, max %.1f us; "
+         "heap allocations %llu\n",
+         static_cast<unsigned long long>(gStats.passes), static_cast<double>(gStats.busyUs) / passes,
+         static_cast<unsigned long long>(gStats.maxBusyUs), static_cast<double>(gStats.cpuNs) / passes,
+         static_cast<double>(gStats.maxCpuNs) / 1000.0, static_cast<unsigned long long>(gStats.allocations));
+  return sc.failures == 0 ? 0 : 1;
+}
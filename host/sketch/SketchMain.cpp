@@ -0,0 +1,3 @@
+// Compiles the Arduino sketch's main file as an ordinary C++ translation
+// unit against the host fakes.
+#include "../../TerrariumLidController/TerrariumLidController.ino"
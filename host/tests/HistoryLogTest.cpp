@@ -0,0 +1,355 @@
+// HistoryLog against the RAM-backed flash partition, shrunk to a ring of a
+// few sectors so every case wraps quickly: oldest-sector erase, head
+// recovery after a reboot, CRC-corrupted and torn records, query ranges
+// with the sector skip, the open record still in RAM, and sample records
+// from before 14-bit duty.
+//
+//   tlc_history_log_test   exits 1 on any failed check
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "HistoryLog.h"
+
+namespace {
+
+constexpr size_t kSectors = 4;
+constexpr size_t kCapacity = kSectors * HistoryLog::kRecordsPerSector;
+constexpr uint32_t kT0 = 1767225600;  // 2026-01-01 00:00:00
+constexpr uint32_t kStepS = 60;
+
+int gChecks = 0;
+int gFailures = 0;
+
+#define CHECK(cond)                                                 \
+  do {                                                              \
+    gChecks++;                                                      \
+    if (!(cond)) {                                                  \
+      gFailures++;                                                  \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+    }                                                               \
+  } while (0)
+
+// Sample i of a steady series: one a minute, with values that make the
+// deltas vary in size.
+HistoryLog::Sample sampleAt(uint32_t i) {
+  HistoryLog::Sample s{};
+  s.unixTime = kT0 + i * kStepS;
+  s.valid = i % 97 != 0;
+  s.temperatureC = s.valid ? 20.0f + static_cast<float>(i % 700) * 0.01f : 0.0f;
+  s.humidity = s.valid ? 40.0f + static_cast<float>((i * 7) % 5000) * 0.01f : 0.0f;
+  s.duty = static_cast<uint16_t>((i * 37) % 16384);
+  return s;
+}
+
+bool sameSample(const HistoryLog::Sample& a, const HistoryLog::Sample& b) {
+  return a.unixTime == b.unixTime && a.valid == b.valid && a.duty == b.duty &&
+         lroundf(a.temperatureC * 100.0f) == lroundf(b.temperatureC * 100.0f) &&
+         lroundf(a.humidity * 100.0f) == lroundf(b.humidity * 100.0f);
+}
+
+void freshFlash() {
+  host::setFlashPartitionSize(kSectors * HistoryLog::kSectorSize);
+  host::resetFlashStats();
+}
+
+void appendRange(HistoryLog& log, uint32_t first, uint32_t last) {
+  for (uint32_t i = first; i <= last; ++i) {
+    log.appendSample(sampleAt(i));
+  }
+}
+
+// Appends until the log has erased `erases` sectors; returns the last index.
+uint32_t fillPastWrap(HistoryLog& log, uint32_t first, unsigned long erases) {
+  uint32_t i = first;
+  while (log.getStatus().erases < erases) {
+    log.appendSample(sampleAt(i++));
+  }
+  return i - 1;
+}
+
+struct QueryResult {
+  size_t samples = 0;
+  size_t events = 0;
+  size_t mismatches = 0;
+  bool ordered = true;
+  uint32_t first = 0;
+  uint32_t last = 0;
+  uint64_t reads = 0;
+};
+
+// Runs a query and checks each sample against the series it came from.
+QueryResult query(HistoryLog& log, uint32_t fromUnix, uint32_t toUnix) {
+  QueryResult r;
+  const uint64_t readsBefore = host::flashStats().reads;
+  log.beginQuery(fromUnix, toUnix);
+  HistoryLog::Sample s{};
+  HistoryLog::HeaterEvent e{};
+  uint32_t prev = 0;
+  for (HistoryLog::Item item = log.next(s, e); item != HistoryLog::Item::None; item = log.next(s, e)) {
+    if (item == HistoryLog::Item::HeaterEvent) {
+      r.events++;
+      continue;
+    }
+    if (r.samples == 0) r.first = s.unixTime;
+    if (r.samples > 0 && s.unixTime <= prev) r.ordered = false;
+    if (s.unixTime < fromUnix || s.unixTime > toUnix || !sameSample(s, sampleAt((s.unixTime - kT0) / kStepS))) {
+      r.mismatches++;
+    }
+    prev = s.unixTime;
+    r.last = s.unixTime;
+    r.samples++;
+  }
+  r.reads = host::flashStats().reads - readsBefore;
+  return r;
+}
+
+size_t slotOffset(size_t sector, size_t slot) {
+  return sector * HistoryLog::kSectorSize + slot * HistoryLog::kRecordSize;
+}
+
+uint32_t seqAt(size_t offset) {
+  const uint8_t* p = host::flashPartitionData() + offset + 2;
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// CRC-16/CCITT-FALSE over a record, as HistoryLog stores it.
+void resealRecord(uint8_t* record) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < HistoryLog::kRecordSize - 2; ++i) {
+    crc ^= static_cast<uint16_t>(record[i]) << 8;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  record[HistoryLog::kRecordSize - 2] = static_cast<uint8_t>(crc);
+  record[HistoryLog::kRecordSize - 1] = static_cast<uint8_t>(crc >> 8);
+}
+
+void testPendingInQueries() {
+  printf("pending record in queries\n");
+  freshFlash();
+  HistoryLog log;
+  CHECK(log.begin());
+  appendRange(log, 1, 5);
+  HistoryLog::Status st = log.getStatus();
+  CHECK(st.pendingSamples == 5);
+  CHECK(st.recordsWritten == 0);
+  QueryResult r = query(log, 0, UINT32_MAX);
+  CHECK(r.samples == 5 && r.mismatches == 0 && r.ordered);
+  CHECK(r.first == sampleAt(1).unixTime && r.last == sampleAt(5).unixTime);
+  r = query(log, sampleAt(2).unixTime, sampleAt(3).unixTime);
+  CHECK(r.samples == 2 && r.mismatches == 0);
+
+  // Once some records are on flash the open one still comes last.
+  appendRange(log, 6, 200);
+  st = log.getStatus();
+  CHECK(st.recordsWritten > 0 && st.pendingSamples > 0);
+  r = query(log, 0, UINT32_MAX);
+  CHECK(r.samples == 200 && r.mismatches == 0 && r.ordered && r.last == sampleAt(200).unixTime);
+  CHECK(log.flush());
+  CHECK(log.getStatus().pendingSamples == 0);
+  r = query(log, 0, UINT32_MAX);
+  CHECK(r.samples == 200 && r.mismatches == 0);
+}
+
+void testWrapAround() {
+  printf("wrap-around\n");
+  freshFlash();
+  HistoryLog log;
+  CHECK(log.begin());
+  // Three more erases than sectors: the ring has come round and started
+  // erasing its oldest sectors.
+  const uint32_t last = fillPastWrap(log, 1, kSectors + 3);
+  const HistoryLog::Status st = log.getStatus();
+  CHECK(st.sectors == kSectors);
+  CHECK(st.capacityRecords == kCapacity);
+  CHECK(st.usedRecords > kCapacity - HistoryLog::kRecordsPerSector && st.usedRecords <= kCapacity);
+  CHECK(st.oldestUnix > sampleAt(1).unixTime);
+
+  const host::FlashStats flash = host::flashStats();
+  CHECK(flash.erases == kSectors + 3);
+  CHECK(flash.maxSectorErases - flash.minSectorErases <= 1);
+  CHECK(flash.bitSetViolations == 0);
+
+  // Everything from the oldest surviving sector on, without a gap.
+  const QueryResult r = query(log, 0, UINT32_MAX);
+  CHECK(r.mismatches == 0 && r.ordered);
+  CHECK(r.first == st.oldestUnix);
+  CHECK(r.last == sampleAt(last).unixTime);
+  CHECK(r.samples == (r.last - r.first) / kStepS + 1);
+}
+
+void testRebootRecovery() {
+  printf("head recovery after reboot\n");
+  freshFlash();
+  uint32_t last = 0;
+  HistoryLog::Status before{};
+  {
+    HistoryLog log;
+    CHECK(log.begin());
+    // Wrap so the head is not the last sector and sequence numbers are not
+    // in physical order.
+    last = fillPastWrap(log, 1, kSectors + 2);
+    CHECK(log.flush());
+    before = log.getStatus();
+  }
+
+  HistoryLog log;
+  CHECK(log.begin());
+  const HistoryLog::Status st = log.getStatus();
+  CHECK(st.nextSeq == before.nextSeq);
+  CHECK(st.usedRecords == before.usedRecords);
+  CHECK(st.oldestUnix == before.oldestUnix);
+
+  // New records land after the old head and keep the series continuous.
+  appendRange(log, last + 1, last + 400);
+  CHECK(log.flush());
+  CHECK(log.getStatus().nextSeq > before.nextSeq);
+  const QueryResult r = query(log, 0, UINT32_MAX);
+  CHECK(r.mismatches == 0 && r.ordered);
+  CHECK(r.last == sampleAt(last + 400).unixTime);
+  CHECK(r.samples == (r.last - r.first) / kStepS + 1);
+  CHECK(host::flashStats().bitSetViolations == 0);
+}
+
+void testCorruptAndTornRecords() {
+  printf("CRC-corrupted and torn records\n");
+  freshFlash();
+  uint32_t last = 0;
+  {
+    HistoryLog log;
+    CHECK(log.begin());
+    appendRange(log, 1, 300);
+    CHECK(log.flush());
+    last = 300;
+  }
+  uint8_t* flash = host::flashPartitionData();
+
+  // Flip one payload bit of the second record: its samples vanish, the
+  // ones around it do not.
+  flash[slotOffset(0, 1) + 20] ^= 0x01;
+
+  // A torn write: the next slot holds only the first half of a record.
+  size_t headSlot = 0;
+  while (flash[slotOffset(0, headSlot)] != 0xFF) headSlot++;
+  const size_t torn = slotOffset(0, headSlot);
+  memcpy(flash + torn, flash + slotOffset(0, headSlot - 1), HistoryLog::kRecordSize / 2);
+  const uint32_t tornSeq = seqAt(torn) + 1;
+  flash[torn + 2] = static_cast<uint8_t>(tornSeq);
+
+  HistoryLog log;
+  CHECK(log.begin());
+  HistoryLog::Status st = log.getStatus();
+  // The torn slot is skipped and its sequence number not trusted.
+  CHECK(st.usedRecords == headSlot + 1);
+  CHECK(st.nextSeq == tornSeq);
+  appendRange(log, last + 1, last + 50);
+  CHECK(log.flush());
+  CHECK(flash[slotOffset(0, headSlot + 1)] != 0xFF);
+  CHECK(host::flashStats().bitSetViolations == 0);
+
+  QueryResult r = query(log, 0, UINT32_MAX);
+  st = log.getStatus();
+  CHECK(r.mismatches == 0 && r.ordered);
+  CHECK(st.crcErrors == 2);
+  CHECK(r.first == sampleAt(1).unixTime && r.last == sampleAt(last + 50).unixTime);
+  // Exactly the corrupted record's samples are missing.
+  const size_t missing = (r.last - r.first) / kStepS + 1 - r.samples;
+  CHECK(missing > 0 && missing < 20);
+}
+
+void testQueryRanges() {
+  printf("query ranges and sector skip\n");
+  freshFlash();
+  HistoryLog log;
+  CHECK(log.begin());
+  const uint32_t last = fillPastWrap(log, 1, kSectors + 2);
+  HistoryLog::HeaterEvent event{};
+  event.unixTime = sampleAt(last).unixTime;
+  event.durationMs = 1000;
+  strncpy(event.reason, "wet", sizeof(event.reason) - 1);
+  log.appendHeaterEvent(event);
+  log.appendSample(sampleAt(last + 1));
+  const uint32_t oldest = log.getStatus().oldestUnix;
+
+  const QueryResult all = query(log, 0, UINT32_MAX);
+  CHECK(all.events == 1);
+
+  // A window in the middle returns exactly its samples.
+  const uint32_t from = oldest + 500 * kStepS;
+  const uint32_t to = from + 240 * kStepS;
+  QueryResult r = query(log, from, to);
+  CHECK(r.mismatches == 0 && r.ordered && r.events == 0);
+  CHECK(r.samples == 241 && r.first == from && r.last == to);
+
+  // An empty, an inverted and a pre-history range.
+  CHECK(query(log, sampleAt(last + 100).unixTime, UINT32_MAX).samples == 0);
+  CHECK(query(log, to, from).samples == 0);
+  CHECK(query(log, 0, oldest - 1).samples == 0);
+
+  // The last hour only reads one header per older sector plus the newest
+  // sectors' records, far fewer than a full walk.
+  r = query(log, sampleAt(last + 1).unixTime - 3600, UINT32_MAX);
+  CHECK(r.samples == 61 && r.events == 1 && r.mismatches == 0);
+  CHECK(r.reads < all.reads / 2);
+  CHECK(r.reads <= 2 * kSectors + 2 * HistoryLog::kRecordsPerSector);
+}
+
+void testLegacyDutyRecords() {
+  printf("10-bit duty records\n");
+  freshFlash();
+  {
+    HistoryLog log;
+    CHECK(log.begin());
+    for (uint32_t i = 0; i < 8; ++i) {
+      HistoryLog::Sample s = sampleAt(i + 1);
+      s.duty = static_cast<uint16_t>(i * 146);  // 0..1022 as 10-bit duty
+      log.appendSample(s);
+    }
+    CHECK(log.flush());
+    // Relabel the record as written by the 10-bit firmware.
+    uint8_t* record = host::flashPartitionData() + slotOffset(0, 0);
+    CHECK(record[0] == 0x5C);
+    record[0] = 0x5A;
+    resealRecord(record);
+  }
+
+  HistoryLog log;
+  CHECK(log.begin());
+  HistoryLog::Sample s = sampleAt(9);
+  s.duty = HistoryLog::kMaxDuty;
+  log.appendSample(s);
+  log.beginQuery(0, UINT32_MAX);
+  HistoryLog::Sample out{};
+  HistoryLog::HeaterEvent e{};
+  uint16_t duties[9] = {};
+  size_t n = 0;
+  while (log.next(out, e) == HistoryLog::Item::Sample && n < 9) {
+    duties[n++] = out.duty;
+  }
+  CHECK(n == 9);
+  CHECK(duties[0] == 0);
+  CHECK(duties[1] == 2338);  // 146 of 1023 in 14 bits
+  CHECK(duties[7] == 16367);  // 1022 of 1023
+  CHECK(duties[8] == HistoryLog::kMaxDuty);
+  CHECK(log.getStatus().crcErrors == 0);
+}
+
+}  // namespace
+
+int main() {
+  testPendingInQueries();
+  testWrapAround();
+  testRebootRecovery();
+  testCorruptAndTornRecords();
+  testQueryRanges();
+  testLegacyDutyRecords();
+  printf("%d/%d checks passed\n", gChecks - gFailures, gChecks);
+  return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// Writes TerrariumLidController/SolarTable.h for one location: dawn,
+// sunrise, sunset and dusk sampled every few days and delta-packed (format
+// in SolarCalculator.h). The worst interpolation error against the daily
+// calculation is reported on stderr.
+//
+//   tlc_solar_table 51.48 -0.01 0 > TerrariumLidController/SolarTable.h
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SolarCalculator.h"
+
+namespace {
+constexpr int kMaxErrorMin = 3;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 4) {
+    fprintf(stderr, "usage: %s <latitude> <longitude> <utcOffsetMin>\n", argv[0]);
+    return 2;
+  }
+  const double latitude = atof(argv[1]);
+  const double longitude = atof(argv[2]);
+  const int utcOffsetMin = atoi(argv[3]);
+
+  SolarDay days[366];
+  for (int d = 1; d <= 365; ++d) {
+    days[d] = computeSolarDay(d, latitude, longitude, utcOffsetMin);
+    if (days[d].kind != SolarDayKind::Normal) {
+      fprintf(stderr, "day %d has no sunrise or sunset; use runtime mode at this latitude\n", d);
+      return 1;
+    }
+  }
+
+  uint8_t table[kSolarTableBytes];
+  for (size_t e = 0; e < 4; ++e) {
+    uint8_t* p = table + e * kSolarTableEventBytes;
+    int prev = solarEventField(days[1], e);
+    p[0] = static_cast<uint8_t>(prev & 0xFF);
+    p[1] = static_cast<uint8_t>(prev >> 8);
+    for (size_t i = 1; i < kSolarTableSamples; ++i) {
+      const int value = solarEventField(days[1 + i * kSolarTableStepDays], e);
+      int delta = value - prev;
+      if (delta > 720) delta -= 1440;
+      if (delta < -720) delta += 1440;
+      if (delta < -128 || delta > 127) {
+        fprintf(stderr, "event %zu moves %d min in %d days; too fast to pack\n", e, delta, kSolarTableStepDays);
+        return 1;
+      }
+      p[1 + i] = static_cast<uint8_t>(static_cast<int8_t>(delta));
+      prev += delta;
+    }
+  }
+
+  int worst = 0;
+  for (int d = 1; d <= 365; ++d) {
+    SolarDay decoded;
+    decodeSolarTable(table, sizeof(table), d, decoded);
+    for (size_t e = 0; e < 4; ++e) {
+      int err = abs(solarEventField(decoded, e) - solarEventField(days[d], e));
+      if (err > 720) err = 1440 - err;
+      if (err > worst) worst = err;
+    }
+  }
+
+  // Near the polar circles twilight can vanish for weeks and the linear
+  // interpolation breaks down; the runtime calculation handles those days.
+  if (worst > kMaxErrorMin) {
+    fprintf(stderr, "worst interpolation error %d min exceeds %d; use runtime mode at this latitude\n", worst,
+            kMaxErrorMin);
+    return 1;
+  }
+
+  printf("#pragma once\n\n#include <stddef.h>\n#include <stdint.h>\n\n");
+  printf("// Generated by tlc_solar_table %s %s %s (format in SolarCalculator.h).\n", argv[1], argv[2], argv[3]);
+  printf("// Worst interpolation error against the daily calculation: %d min.\n", worst);
+  printf("constexpr float kSolarTableLatitude = %.4ff;\n", latitude);
+  printf("constexpr float kSolarTableLongitude = %.4ff;\n", longitude);
+  printf("constexpr int kSolarTableUtcOffsetMin = %d;\n", utcOffsetMin);
+  printf("constexpr size_t kSolarTableSize = %zu;\n", sizeof(table));
+  printf("constexpr uint8_t kSolarTable[%zu] = {", sizeof(table));
+  for (size_t i = 0; i < sizeof(table); ++i) {
+    printf("%s0x%02X,", i % 12 == 0 ? "\n    " : " ", table[i]);
+  }
+  printf("\n};\n");
+  fprintf(stderr, "%zu bytes (%zu for every day), worst error %d min\n", sizeof(table), sizeof(uint16_t) * 4 * 365,
+          worst);
+  return 0;
+}
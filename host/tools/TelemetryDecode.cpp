@@ -0,0 +1,145 @@
+// Decodes the console's binary 'stream' output (see TelemetryRecord.h) into
+// CSV on stdout, one row per valid record. Console text between frames is
+// skipped (or echoed to stderr with --text). A summary of bad frames and
+// sequence gaps goes to stderr at the end. duty is always 14-bit
+// (0..16383): version 1 records, which carried 10-bit duty, are rescaled.
+//
+//   stty -F /dev/ttyACM0 raw 115200
+//   tlc_telemetry_decode /dev/ttyACM0 > trace.csv
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "TelemetryRecord.h"
+
+namespace {
+
+struct Counters {
+  unsigned long long records = 0;
+  unsigned long long badFrames = 0;
+  unsigned long long textBytes = 0;
+  unsigned long long missing = 0;
+  unsigned long long resets = 0;
+};
+
+void printHeader() {
+  printf(
+      "seq,uptime_ms,rtc_unix,rtc_valid,light_on,schedule_allowed,force_on,control_mode,brightness_pct,raw_pot,"
+      "duty,pot_norm,pot_scaled,pot_filtered,gate,has_rh,rh_pct,has_temp,temp_f,next_event,sht_present,"
+      "sht_addr,sht_mode,sht_heater,sht_wet_stuck,sht_condensation,sht_pulses_hour,sht_last_heater_ms,"
+      "sht_samples,sht_crc_errors,sht_bus_errors,sht_last_valid,sht_last_influenced,sht_last_settling,"
+      "sht_last_temp_c,sht_last_rh,version\n");
+}
+
+void printRecord(const TelemetryRecord& r) {
+  auto flag = [&r](uint16_t bit) { return (r.flags & bit) ? 1 : 0; };
+  auto sht = [&r](uint8_t bit) { return (r.shtFlags & bit) ? 1 : 0; };
+  printf("%u,%u,%u,%d,%d,%d,%d,%u,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%d,%.2f,%d,%.2f,\"%s\",", r.seq, r.uptimeMs,
+         r.rtcUnix, flag(kTelemetryFlagRtcValid), flag(kTelemetryFlagLightOn), flag(kTelemetryFlagScheduleAllowed),
+         flag(kTelemetryFlagForceOn), r.controlMode, r.brightnessPercent, r.rawPot, r.duty, r.potNorm, r.potScaled,
+         r.potFiltered, r.gate, flag(kTelemetryFlagHasHumidity), r.humidityPercent, flag(kTelemetryFlagHasTempF),
+         r.temperatureF, r.nextEvent);
+  printf("%d,0x%02X,%s,%d,%d,%d,%u,%u,%u,%u,%u,%d,%d,%d,%.2f,%.2f,%u\n", sht(kTelemetryShtPresent), r.shtAddress,
+         sht(kTelemetryShtPeriodic) ? "art" : "single", sht(kTelemetryShtHeater), sht(kTelemetryShtWetStuck),
+         sht(kTelemetryShtCondensation), r.shtPulsesLastHour, r.shtLastHeaterMs, r.shtSamples, r.shtCrcErrors,
+         r.shtBusErrors, sht(kTelemetryShtLastValid), sht(kTelemetryShtLastInfluenced),
+         sht(kTelemetryShtLastSettling), r.shtLastTemperatureC, r.shtLastHumidity, r.version);
+}
+
+bool looksLikeText(const std::vector<uint8_t>& block) {
+  for (uint8_t b : block) {
+    if (b != '\n' && b != '\r' && b != '\t' && (b < 0x20 || b > 0x7E)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  bool echoText = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--text") == 0) {
+      echoText = true;
+    } else if (path == nullptr && argv[i][0] != '-') {
+      path = argv[i];
+    } else if (path == nullptr && strcmp(argv[i], "-") == 0) {
+      path = "-";
+    } else {
+      fprintf(stderr, "usage: %s [--text] [file|-]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  FILE* in = stdin;
+  if (path != nullptr && strcmp(path, "-") != 0) {
+    in = fopen(path, "rb");
+    if (in == nullptr) {
+      perror(path);
+      return 1;
+    }
+  }
+
+  Counters counters;
+  std::vector<uint8_t> block;
+  bool haveSeq = false;
+  uint32_t lastSeq = 0;
+  printHeader();
+
+  auto endBlock = [&]() {
+    if (block.empty()) {
+      return;
+    }
+    uint8_t record[kTelemetryRecordSize + 1];
+    const size_t len = cobsDecode(block.data(), block.size(), record, sizeof(record));
+    TelemetryRecord r;
+    if (len == kTelemetryRecordSize && unpackTelemetryRecord(record, len, r)) {
+      if (haveSeq) {
+        const uint32_t expected = lastSeq + 1;
+        if (r.seq > expected) {
+          counters.missing += r.seq - expected;
+        } else if (r.seq < expected) {
+          counters.resets++;  // device rebooted or the stream was restarted
+        }
+      }
+      haveSeq = true;
+      lastSeq = r.seq;
+      counters.records++;
+      printRecord(r);
+      fflush(stdout);
+    } else if (looksLikeText(block)) {
+      counters.textBytes += block.size();
+      if (echoText) {
+        fwrite(block.data(), 1, block.size(), stderr);
+      }
+    } else {
+      counters.badFrames++;
+    }
+    block.clear();
+  };
+
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      if (buf[i] == 0) {
+        endBlock();
+      } else {
+        block.push_back(buf[i]);
+      }
+    }
+  }
+  endBlock();
+  if (in != stdin) {
+    fclose(in);
+  }
+
+  fprintf(stderr, "records=%llu badFrames=%llu missingSeq=%llu seqResets=%llu textBytes=%llu\n", counters.records,
+          counters.badFrames, counters.missing, counters.resets, counters.textBytes);
+  return 0;
+}